@@ -0,0 +1,262 @@
+#include "AbilityGraph.h"
+#include <algorithm>
+
+// ---------- Seats ----------
+void AbilityGraph::reset(int seats) {
+    nodes.assign(std::size_t(std::max(seats, 0)), Node{});
+    edges.clear();
+    freeEdges.clear();
+    nextSeq = 1;
+    liveEdges = 0;
+    work.clear();
+    touched.clear();
+    wasActive.assign(nodes.size(), 0);
+    isTouched.assign(nodes.size(), 0);
+    changed.clear();
+}
+
+void AbilityGraph::addSeat() {
+    nodes.emplace_back();
+    wasActive.push_back(0);
+    isTouched.push_back(0);
+}
+
+const std::vector<int> &AbilityGraph::remap(const std::vector<int> &newSeat, int seats) {
+    auto moved = [&](int seat) { return seat >= 0 && seat < int(newSeat.size()) ? newSeat[seat] : -1; };
+    changed.clear();
+
+    // Those leaving take their edges with them, old numbering throughout
+    for (int seat = 0; seat < int(nodes.size()); ++seat) {
+        if (moved(seat) >= 0) continue;
+        Node &n = nodes[seat];
+        while (!n.out.empty()) {
+            int target = edges[n.out.back()].target;
+            touch(target);
+            dropEdge(n.out.back());
+            Node &t = nodes[target];
+            std::uint32_t first = oldestLive(t);
+            if (first != t.firstLive) {
+                t.firstLive = first;
+                dirty(target);
+            }
+        }
+        while (!n.in.empty()) dropEdge(n.in.back());
+    }
+    propagate();
+    finish();
+    std::vector<int> before;
+    before.swap(changed);
+
+    std::vector<Node> placed(std::size_t(std::max(seats, 0)));
+    for (int seat = 0; seat < int(nodes.size()); ++seat) {
+        int to = moved(seat);
+        if (to >= 0 && to < int(placed.size())) placed[to] = std::move(nodes[seat]);
+    }
+    nodes.swap(placed);
+    for (Edge &e : edges) {
+        e.source = moved(e.source);
+        e.target = moved(e.target);
+    }
+    wasActive.assign(nodes.size(), 0);
+    isTouched.assign(nodes.size(), 0);
+
+    changed.clear();
+    for (int seat : before)
+        if (valid(moved(seat))) changed.push_back(moved(seat));
+    return changed;
+}
+
+bool AbilityGraph::abilityActive(int seat) const {
+    if (!valid(seat)) return true;
+    const Node &n = nodes[seat];
+    return !n.innate && !n.unsourced && n.firstLive == Never;
+}
+
+std::vector<int> AbilityGraph::impairedBy(int seat) const {
+    std::vector<std::pair<std::uint32_t, int>> live;
+    if (!valid(seat)) return {};
+    for (int idx : nodes[seat].in)
+        if (edges[idx].live) live.emplace_back(edges[idx].seq, edges[idx].source);
+    std::sort(live.begin(), live.end());
+    std::vector<int> sources;
+    for (auto &l : live) sources.push_back(l.second);
+    return sources;
+}
+
+// ---------- Edges ----------
+// An edge holds while its source is alive and was not already impaired
+// when it acted: unsourced or innate impairment, or a live edge older
+// than this one
+bool AbilityGraph::edgeHolds(const Edge &e) const {
+    const Node &s = nodes[e.source];
+    return s.alive && !s.innate && !s.unsourced && s.firstLive > e.seq;
+}
+
+std::uint32_t AbilityGraph::oldestLive(const Node &n) const {
+    std::uint32_t first = Never;
+    for (int idx : n.in)
+        if (edges[idx].live) first = std::min(first, edges[idx].seq);
+    return first;
+}
+
+const std::vector<int> &AbilityGraph::addEdge(int source, int target, Effect effect) {
+    if (source == target) return setUnsourced(target, effect, true);
+    changed.clear();
+    if (!valid(source) || !valid(target)) return changed;
+
+    // The older edge already covers a repeat, and keeps its place in the order
+    for (int idx : nodes[target].in)
+        if (edges[idx].source == source && edges[idx].effect == effect) return changed;
+
+    int idx;
+    if (!freeEdges.empty()) {
+        idx = freeEdges.back();
+        freeEdges.pop_back();
+    } else {
+        idx = int(edges.size());
+        edges.emplace_back();
+    }
+    Edge &e = edges[idx];
+    e = Edge{source, target, nextSeq++, effect, false};
+    nodes[source].out.push_back(idx);
+    nodes[target].in.push_back(idx);
+
+    if (edgeHolds(e)) {
+        touch(target);
+        e.live = true;
+        ++liveEdges;
+        Node &t = nodes[target];
+        if (t.firstLive == Never) {      // newer than any live edge, so only the first one moves it
+            t.firstLive = e.seq;
+            dirty(target);
+        }
+        propagate();
+    }
+    return finish();
+}
+
+static void unlink(std::vector<int> &list, int idx) {
+    auto it = std::find(list.begin(), list.end(), idx);
+    if (it == list.end()) return;
+    *it = list.back();
+    list.pop_back();
+}
+
+void AbilityGraph::dropEdge(int idx) {
+    Edge &e = edges[idx];
+    if (e.live) --liveEdges;
+    e.live = false;
+    unlink(nodes[e.source].out, idx);
+    unlink(nodes[e.target].in, idx);
+    freeEdges.push_back(idx);
+}
+
+const std::vector<int> &AbilityGraph::clearEffect(int seat, Effect effect) {
+    changed.clear();
+    if (!valid(seat)) return changed;
+    touch(seat);
+    Node &n = nodes[seat];
+    bool moved = (n.unsourced & effect) != 0;
+    n.unsourced &= std::uint8_t(~effect);
+
+    for (std::size_t i = 0; i < n.in.size();) {
+        int idx = n.in[i];
+        Edge &e = edges[idx];
+        if (e.effect != effect) { ++i; continue; }
+        if (e.live) --liveEdges;
+        e.live = false;
+        unlink(nodes[e.source].out, idx);
+        n.in[i] = n.in.back();
+        n.in.pop_back();
+        freeEdges.push_back(idx);
+    }
+    std::uint32_t first = oldestLive(n);
+    if (first != n.firstLive) {
+        n.firstLive = first;
+        moved = true;
+    }
+    if (moved) {
+        dirty(seat);
+        propagate();
+    }
+    return finish();
+}
+
+const std::vector<int> &AbilityGraph::setUnsourced(int seat, Effect effect, bool on) {
+    changed.clear();
+    if (!valid(seat)) return changed;
+    Node &n = nodes[seat];
+    std::uint8_t bits = on ? std::uint8_t(n.unsourced | effect) : std::uint8_t(n.unsourced & ~effect);
+    if (bits == n.unsourced) return changed;
+    touch(seat);
+    n.unsourced = bits;
+    dirty(seat);
+    propagate();
+    return finish();
+}
+
+const std::vector<int> &AbilityGraph::setInnate(int seat, bool impaired) {
+    changed.clear();
+    if (!valid(seat) || nodes[seat].innate == impaired) return changed;
+    touch(seat);
+    nodes[seat].innate = impaired;
+    dirty(seat);
+    propagate();
+    return finish();
+}
+
+const std::vector<int> &AbilityGraph::setAlive(int seat, bool alive) {
+    changed.clear();
+    if (!valid(seat) || nodes[seat].alive == alive) return changed;
+    nodes[seat].alive = alive;
+    dirty(seat);
+    propagate();
+    return finish();
+}
+
+// ---------- Propagation ----------
+void AbilityGraph::touch(int seat) {
+    if (isTouched[seat]) return;
+    isTouched[seat] = 1;
+    wasActive[seat] = abilityActive(seat);
+    touched.push_back(seat);
+}
+
+void AbilityGraph::dirty(int seat) {
+    work.push_back(seat);
+}
+
+// Re-evaluates the outgoing edges of each dirty seat. An edge only depends
+// on older edges, so this settles; seats whose oldest live edge did not
+// move stop the walk.
+void AbilityGraph::propagate() {
+    while (!work.empty()) {
+        int seat = work.back();
+        work.pop_back();
+        for (int idx : nodes[seat].out) {
+            Edge &e = edges[idx];
+            bool holds = edgeHolds(e);
+            if (holds == e.live) continue;
+            touch(e.target);
+            e.live = holds;
+            if (holds) ++liveEdges;
+            else --liveEdges;
+            Node &t = nodes[e.target];
+            std::uint32_t first = holds ? std::min(t.firstLive, e.seq) : oldestLive(t);
+            if (first != t.firstLive) {
+                t.firstLive = first;
+                work.push_back(e.target);
+            }
+        }
+    }
+}
+
+const std::vector<int> &AbilityGraph::finish() {
+    changed.clear();
+    for (int seat : touched) {
+        if (bool(wasActive[seat]) != abilityActive(seat)) changed.push_back(seat);
+        isTouched[seat] = 0;
+    }
+    touched.clear();
+    return changed;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// ---------- Ability graph ----------
+// Whether each seat's ability works, kept as a dependency graph from effect
+// sources to their targets. An impairing effect (Poisoned, Drunk) applied by
+// a seat is an edge source -> target; it only holds while the source is
+// alive and not impaired by any live edge older than this one (a Poisoner
+// poisoned before acting poisons nobody). Ordering edges by age keeps
+// the graph acyclic (a Sailor and a Poisoner impairing each other resolve
+// by who acted first). Effects set without a source, and the Drunk
+// character, always impair.
+//
+// Changes propagate from the seats whose state moved, through their
+// outgoing edges only, so each update costs O(edges whose liveness changed).
+class AbilityGraph {
+public:
+    enum Effect : std::uint8_t { Poisoned = 1, Drunk = 2 };
+
+    void reset(int seats);
+    void addSeat();
+    // Seat i moves to newSeat[i], keeping its edges and their age; a seat
+    // mapped to -1 leaves, its edges going as if cleared. `seats` seats
+    // afterwards, new ones unimpaired and alive. Returns the seats (new
+    // numbering) whose abilityActive() changed.
+    const std::vector<int> &remap(const std::vector<int> &newSeat, int seats);
+
+    // Each returns the seats whose abilityActive() changed
+    const std::vector<int> &addEdge(int source, int target, Effect effect);
+    const std::vector<int> &clearEffect(int seat, Effect effect);   // edges and unsourced
+    const std::vector<int> &setUnsourced(int seat, Effect effect, bool on);
+    const std::vector<int> &setInnate(int seat, bool impaired);    // e.g. the Drunk
+    const std::vector<int> &setAlive(int seat, bool alive);
+
+    bool abilityActive(int seat) const;
+    // Seats whose live edges impair `seat`, oldest first
+    std::vector<int> impairedBy(int seat) const;
+
+    int seats() const { return int(nodes.size()); }
+    std::size_t edgeCount() const { return liveEdges; }   // live edges
+
+private:
+    static constexpr std::uint32_t Never = 0xffffffffu;
+
+    struct Edge {
+        int source;
+        int target;
+        std::uint32_t seq;
+        Effect effect;
+        bool live;
+    };
+
+    struct Node {
+        bool alive = true;
+        bool innate = false;
+        std::uint8_t unsourced = 0;          // Effect bits set by hand
+        std::vector<int> out;                // edge indices
+        std::vector<int> in;                 // edge indices
+        std::uint32_t firstLive = Never;     // seq of the oldest live incoming edge
+    };
+
+    bool valid(int seat) const { return seat >= 0 && seat < int(nodes.size()); }
+    bool edgeHolds(const Edge &e) const;
+    std::uint32_t oldestLive(const Node &n) const;
+    void dropEdge(int idx);
+    void touch(int seat);                 // notes the seat's flag before a change
+    void dirty(int seat);                 // its outgoing edges need re-evaluating
+    void propagate();
+    const std::vector<int> &finish();
+
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    std::vector<int> freeEdges;           // slots of removed edges
+    std::uint32_t nextSeq = 1;
+    std::size_t liveEdges = 0;
+
+    // Scratch for one update
+    std::vector<int> work;
+    std::vector<int> touched;
+    std::vector<char> wasActive;          // per seat, valid while touched
+    std::vector<char> isTouched;
+    std::vector<int> changed;
+};
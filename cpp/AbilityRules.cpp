@@ -0,0 +1,245 @@
+#include "AbilityRules.h"
+#include "WinTracker.h"
+#include <QRegularExpression>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+// ---------- State ----------
+void AbilityRules::State::resize(int seats) {
+    effects.assign(seats, 0);
+    untilDusk.assign(seats, 0);
+    untilDawn.assign(seats, 0);
+    character.assign(seats, NoCharacter);
+    team.assign(seats, WinTracker::Other);
+}
+
+// ---------- Compiler ----------
+void AbilityRules::clear() {
+    code.clear();
+    abilities.clear();
+    firstByCharacter.clear();
+    otherByCharacter.clear();
+    characters.clear();
+    effects = QStringList{"Dead", "Poisoned", "Drunk"};
+}
+
+std::optional<QString> AbilityRules::load(const QString &path) {
+    std::ifstream f(path.toStdString());
+    if (!f) return QString("Cannot open %1.").arg(path);
+    std::stringstream text;
+    text << f.rdbuf();
+    return compile(QString::fromStdString(text.str()));
+}
+
+std::optional<QString> AbilityRules::compile(const QString &text) {
+    clear();
+    const QStringList lines = text.split('\n');
+    for (int i = 0; i < int(lines.size()); ++i) {
+        QString line = lines[i];
+        int hash = line.indexOf('#');
+        if (hash >= 0) line = line.left(hash);
+        line = line.trimmed();
+        if (line.isEmpty()) continue;
+        if (auto err = compileLine(line)) {
+            QString message = QString("Line %1: %2").arg(i + 1).arg(*err);
+            clear();
+            return message;
+        }
+    }
+    return std::nullopt;
+}
+
+int AbilityRules::internEffect(const QString &effect) {
+    int bit = effects.indexOf(effect);
+    if (bit >= 0) return bit;
+    if (effects.size() >= 64) return -1;
+    effects << effect;
+    return int(effects.size()) - 1;
+}
+
+std::uint16_t AbilityRules::internCharacter(const QString &characterId) {
+    auto it = characters.find(characterId);
+    if (it != characters.end()) return it->second;
+    std::uint16_t index = std::uint16_t(characters.size());
+    characters.emplace(characterId, index);
+    return index;
+}
+
+// Splits a statement into words; "quoted names" stay one word
+static QStringList tokenize(const QString &statement) {
+    static const QRegularExpression wordRe("\"([^\"]*)\"|(\\S+)");
+    QStringList words;
+    auto it = wordRe.globalMatch(statement);
+    while (it.hasNext()) {
+        QRegularExpressionMatch m = it.next();
+        words << (m.captured(2).isEmpty() ? m.captured(1) : m.captured(2));
+    }
+    return words;
+}
+
+std::optional<QString> AbilityRules::compileLine(const QString &line) {
+    int colon = line.indexOf(':');
+    if (colon < 0) return QString("expected \"<character> <nights>: ...\"");
+    QStringList head = tokenize(line.left(colon));
+    if (head.size() != 2) return QString("expected \"<character> <nights>:\"");
+
+    Ability a;
+    a.characterId = head[0];
+    a.source = line.mid(colon + 1).trimmed();
+    if (head[1] == "each") a.firstNight = a.otherNights = true;
+    else if (head[1] == "first") a.firstNight = true;
+    else if (head[1] == "other") a.otherNights = true;
+    else return QString("unknown nights \"%1\", use each, first or other").arg(head[1]);
+    a.start = int(code.size());
+
+    auto who = [](const QString &w) -> int {
+        if (w == "self") return 0;
+        if (w == "target") return 1;
+        if (w == "second") return 2;
+        return -1;
+    };
+
+    for (const QString &statement : line.mid(colon + 1).split(';')) {
+        QStringList w = tokenize(statement);
+        if (w.isEmpty()) continue;
+
+        // ---- action ----
+        Instr action{};
+        const int count = int(w.size());
+        int at = 0;
+        const QString verb = w[at++];
+        if (verb != "give" && verb != "remove" && verb != "kill")
+            return QString("unknown action \"%1\"").arg(verb);
+        if (at >= count || who(w[at]) < 0) return QString("%1 needs self, target or second").arg(verb);
+        action.who = std::uint8_t(who(w[at]));
+        a.targets = std::max(a.targets, int(action.who));
+        ++at;
+        if (verb == "kill") {
+            action.op = OpKill;
+            action.arg = DeadBit;
+        } else {
+            if (at >= count) return QString("%1 needs an effect").arg(verb);
+            int bit = internEffect(w[at++]);
+            if (bit < 0) return QString("more than 64 effects");
+            action.op = verb == "give" ? OpGive : OpRemove;
+            action.arg = std::uint16_t(bit);
+        }
+        if (at + 1 < count && w[at] == "until") {
+            if (action.op != OpGive) return QString("only give can last until dusk or dawn");
+            if (w[at + 1] == "dusk") action.op = OpGiveDusk;
+            else if (w[at + 1] == "dawn") action.op = OpGiveDawn;
+            else return QString("until needs dusk or dawn");
+            at += 2;
+        }
+
+        // ---- condition: each term ORs into the flag, SkipIf guards the action ----
+        if (at < count) {
+            if (w[at++] != "unless") return QString("unexpected \"%1\"").arg(w[at - 1]);
+            for (;;) {
+                if (at + 2 >= count) return QString("incomplete condition");
+                int subject = who(w[at]);
+                if (subject < 0) return QString("condition needs self, target or second");
+                a.targets = std::max(a.targets, subject);
+                Instr test{};
+                test.who = std::uint8_t(subject);
+                const QString &what = w[at + 2];
+                if (w[at + 1] == "has") {
+                    int bit = internEffect(what);
+                    if (bit < 0) return QString("more than 64 effects");
+                    test.op = OpHas;
+                    test.arg = std::uint16_t(bit);
+                } else if (w[at + 1] == "is") {
+                    WinTracker::Team team = WinTracker::teamIndex(what);
+                    test.op = team == WinTracker::Other ? OpIs : OpIsTeam;
+                    test.arg = team == WinTracker::Other ? internCharacter(what) : std::uint16_t(team);
+                } else {
+                    return QString("expected has or is, got \"%1\"").arg(w[at + 1]);
+                }
+                code.push_back(test);
+                at += 3;
+                if (at >= count) break;
+                if (w[at++] != "or") return QString("conditions are joined by or");
+            }
+            code.push_back(Instr{OpSkipIf, 0, 0});
+        }
+        code.push_back(action);
+    }
+
+    a.length = int(code.size()) - a.start;
+    if (a.firstNight) firstByCharacter[a.characterId] = int(abilities.size());
+    if (a.otherNights) otherByCharacter[a.characterId] = int(abilities.size());
+    abilities.push_back(a);
+    return std::nullopt;
+}
+
+// ---------- Lookups ----------
+int AbilityRules::abilityFor(const QString &characterId, bool firstNight) const {
+    const auto &table = firstNight ? firstByCharacter : otherByCharacter;
+    auto it = table.find(characterId);
+    return it == table.end() ? -1 : it->second;
+}
+
+int AbilityRules::effectBit(const QString &effect) const {
+    return effects.indexOf(effect);
+}
+
+std::uint16_t AbilityRules::characterIndex(const QString &characterId) const {
+    auto it = characters.find(characterId);
+    return it == characters.end() ? NoCharacter : it->second;
+}
+
+// ---------- VM ----------
+bool AbilityRules::run(int ability, State &s, int actor, int target, int second) const {
+    const int n = s.seats();
+    if (ability < 0 || ability >= int(abilities.size()) || actor < 0 || actor >= n) return false;
+    constexpr std::uint64_t impaired = (std::uint64_t(1) << PoisonedBit) | (std::uint64_t(1) << DrunkBit);
+    if (s.effects[actor] & impaired) return false;
+
+    const int seats[3] = {actor, target < n ? target : -1, second < n ? second : -1};
+    const Instr *pc = code.data() + abilities[ability].start;
+    const Instr *end = pc + abilities[ability].length;
+    bool flag = false;
+
+    for (; pc < end; ++pc) {
+        const int seat = seats[pc->who];
+        const std::uint64_t bit = std::uint64_t(1) << (pc->arg & 63);
+        switch (pc->op) {
+        case OpHas:    flag = flag || (seat >= 0 && (s.effects[seat] & bit)); break;
+        case OpIs:     flag = flag || (seat >= 0 && s.character[seat] == pc->arg); break;
+        case OpIsTeam: flag = flag || (seat >= 0 && s.team[seat] == pc->arg); break;
+        case OpSkipIf:
+            if (flag) ++pc;
+            flag = false;
+            break;
+        case OpGive:
+        case OpKill:
+            if (seat >= 0) s.effects[seat] |= bit;
+            break;
+        case OpGiveDusk:
+            if (seat >= 0) { s.effects[seat] |= bit; s.untilDusk[seat] |= bit; }
+            break;
+        case OpGiveDawn:
+            if (seat >= 0) { s.effects[seat] |= bit; s.untilDawn[seat] |= bit; }
+            break;
+        case OpRemove:
+            if (seat >= 0) s.effects[seat] &= ~bit;
+            break;
+        }
+    }
+    return true;
+}
+
+void AbilityRules::dusk(State &s) {
+    for (int i = 0; i < s.seats(); ++i) {
+        s.effects[i] &= ~s.untilDusk[i];
+        s.untilDusk[i] = 0;
+    }
+}
+
+void AbilityRules::dawn(State &s) {
+    for (int i = 0; i < s.seats(); ++i) {
+        s.effects[i] &= ~s.untilDawn[i];
+        s.untilDawn[i] = 0;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// ---------- Ability rules ----------
+// A small rules language for ability effects (see Master_BotC.rules), e.g.
+//   poisoner each: give target Poisoned until dusk
+//   imp other: kill target unless target has Safe or target is soldier
+// compiled once into 4-byte instructions and run by a tiny VM over a flat
+// per-seat State: effects are bits of a uint64, characters and teams small
+// integers. Running an ability touches a handful of words and never
+// allocates, so the same rules can drive whole-game simulations.
+class AbilityRules {
+public:
+    static constexpr std::uint16_t NoCharacter = 0xffff;
+
+    // Flat game state the VM runs over; build it with GameState::ruleState()
+    // or directly for simulations
+    struct State {
+        std::vector<std::uint64_t> effects;     // per seat, bit i = effectNames()[i]
+        std::vector<std::uint64_t> untilDusk;   // effects the rules gave that end at dusk
+        std::vector<std::uint64_t> untilDawn;   // ... and at dawn
+        std::vector<std::uint16_t> character;   // characterIndex(), NoCharacter if no rule names it
+        std::vector<std::uint8_t> team;         // WinTracker::Team
+
+        void resize(int seats);
+        int seats() const { return int(effects.size()); }
+    };
+
+    struct Ability {
+        QString characterId;
+        bool firstNight = false;
+        bool otherNights = false;
+        int targets = 0;         // players the ability chooses (target, second)
+        int start = 0;           // into the code
+        int length = 0;
+        QString source;          // the rule as written
+    };
+
+    // Fixed effect bits; every other effect is numbered as the rules name it
+    enum FixedEffect { DeadBit, PoisonedBit, DrunkBit };
+
+    AbilityRules() { clear(); }
+
+    std::optional<QString> compile(const QString &text);   // error with line number, if any
+    std::optional<QString> load(const QString &path);
+    void clear();
+
+    // Ability index for a character on a night, -1 if no rule covers it
+    int abilityFor(const QString &characterId, bool firstNight) const;
+    const Ability &ability(int index) const { return abilities[index]; }
+    int abilityCount() const { return int(abilities.size()); }
+
+    const QStringList &effectNames() const { return effects; }
+    int effectBit(const QString &effect) const;            // -1 if no rule uses it
+    std::uint16_t characterIndex(const QString &characterId) const;
+
+    // Runs one ability; seats are -1 when not chosen. Returns false when the
+    // actor is drunk or poisoned and nothing happened.
+    bool run(int ability, State &state, int actor, int target = -1, int second = -1) const;
+
+    // Ends effects given "until dusk" / "until dawn"
+    static void dusk(State &state);
+    static void dawn(State &state);
+
+private:
+    enum Op : std::uint8_t {
+        OpHas,          // flag |= seat has effect `arg`
+        OpIs,           // flag |= seat is character `arg`
+        OpIsTeam,       // flag |= seat is on team `arg`
+        OpSkipIf,       // skip the next instruction if flag; clears flag
+        OpGive,         // seat gains effect `arg`
+        OpGiveDusk,     // ... until dusk
+        OpGiveDawn,     // ... until dawn
+        OpRemove,       // seat loses effect `arg`
+        OpKill          // seat gains Dead
+    };
+
+    struct Instr {
+        Op op;
+        std::uint8_t who;         // 0 self, 1 target, 2 second
+        std::uint16_t arg;
+    };
+    static_assert(sizeof(Instr) == 4, "instructions are packed into 4 bytes");
+
+    std::optional<QString> compileLine(const QString &line);
+    int internEffect(const QString &effect);
+    std::uint16_t internCharacter(const QString &characterId);
+
+    std::vector<Instr> code;
+    std::vector<Ability> abilities;
+    std::unordered_map<QString, int> firstByCharacter;
+    std::unordered_map<QString, int> otherByCharacter;
+    QStringList effects;
+    std::unordered_map<QString, std::uint16_t> characters;
+};
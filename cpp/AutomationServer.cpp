@@ -0,0 +1,114 @@
+#include "AutomationServer.h"
+#include "StallWatchdog.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTimer>
+#include <algorithm>
+
+using json = nlohmann::json;
+
+static QByteArray errorLine(const char *title, const char *message) {
+    json reply = {{"ok", false}, {"error", {{"title", title}, {"message", message}}}};
+    return QByteArray::fromStdString(reply.dump()) + '\n';
+}
+
+AutomationServer::AutomationServer(Handler handler, QObject *parent)
+    : QObject(parent), handler(std::move(handler))
+{
+}
+
+bool AutomationServer::start(const QString &name) {
+    if (server) return true;
+    QString socketName = name.isEmpty() ? qEnvironmentVariable("BOTC_AUTOMATION", "botc-storyteller") : name;
+    if (socketName == "0") return false;
+
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    bool listening = server->listen(socketName);
+    if (!listening && server->serverError() == QAbstractSocket::AddressInUseError) {
+        // Only take the name over if it was left behind by a run that
+        // crashed: a live instance still answers on it
+        QLocalSocket probe;
+        probe.connectToServer(socketName);
+        if (probe.waitForConnected(200)) {
+            probe.abort();
+            lastError = QString("Another instance is already listening on %1").arg(socketName);
+            delete server;
+            server = nullptr;
+            return false;
+        }
+        QLocalServer::removeServer(socketName);
+        listening = server->listen(socketName);
+    }
+    if (!listening) {
+        lastError = server->errorString();
+        delete server;
+        server = nullptr;
+        return false;
+    }
+    connect(server, &QLocalServer::newConnection, this, &AutomationServer::accept);
+    return true;
+}
+
+QString AutomationServer::serverName() const {
+    return server ? server->fullServerName() : QString();
+}
+
+void AutomationServer::accept() {
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+        clients.push_back({socket, {}, false});
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { process(socket); });
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QObject::destroyed, this, [this, socket]() {
+            clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                         [socket](const Client &c) { return c.socket == socket; }),
+                          clients.end());
+        });
+    }
+}
+
+AutomationServer::Client *AutomationServer::clientFor(QLocalSocket *socket) {
+    for (Client &c : clients)
+        if (c.socket == socket) return &c;
+    return nullptr;
+}
+
+// ---------- Messages ----------
+void AutomationServer::process(QLocalSocket *socket) {
+    StallWatchdog::ActionScope action("automation");
+    Client *client = clientFor(socket);
+    if (!client) return;
+    client->scheduled = false;
+    client->buffer += socket->readAll();
+
+    QByteArray out;
+    int handled = 0;
+    qsizetype start = 0;
+    while (handled < SliceMessages) {
+        qsizetype end = client->buffer.indexOf('\n', start);
+        if (end < 0) break;
+        const char *first = client->buffer.constData() + start;
+        const char *last = client->buffer.constData() + end;
+        start = end + 1;
+        if (std::all_of(first, last, [](char ch) { return ch == ' ' || ch == '\t' || ch == '\r'; })) continue;
+
+        json message = json::parse(first, last, nullptr, false);
+        if (message.is_discarded()) out += errorLine("Bad Message", "Invalid JSON.");
+        else out += QByteArray::fromStdString(handler(message).dump()) + '\n';
+        ++handled;
+    }
+    client->buffer.remove(0, start);
+
+    if (client->buffer.size() > MaxLineBytes && !client->buffer.contains('\n')) {
+        socket->write(out + errorLine("Bad Message", "Line too long."));
+        socket->disconnectFromServer();
+        return;
+    }
+    if (!out.isEmpty()) socket->write(out);
+
+    // More complete lines are waiting: give the event loop a turn first
+    if (handled == SliceMessages && client->buffer.contains('\n') && !client->scheduled) {
+        client->scheduled = true;
+        QTimer::singleShot(0, socket, [this, socket]() { process(socket); });
+    }
+}
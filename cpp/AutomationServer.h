@@ -0,0 +1,51 @@
+#pragma once
+#include <QByteArray>
+#include <QObject>
+#include <functional>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+class QLocalServer;
+class QLocalSocket;
+
+// ---------- Automation server ----------
+// A QLocalServer that takes GameCommands messages as NDJSON, one JSON
+// object per line, and answers each with one line. Clients are served on
+// the UI thread in slices of at most SliceMessages messages, so a client
+// pushing thousands of commands never holds the event loop for long; the
+// handler is expected to coalesce repaints itself.
+//
+// The socket name comes from BOTC_AUTOMATION (default "botc-storyteller";
+// "0" disables the server). start() fails while another instance is
+// listening on the name; a stale socket from a crashed run is replaced.
+class AutomationServer : public QObject {
+    Q_OBJECT
+public:
+    using json = nlohmann::json;
+    using Handler = std::function<json(const json &message)>;
+
+    explicit AutomationServer(Handler handler, QObject *parent = nullptr);
+
+    bool start(const QString &name = QString());
+    QString serverName() const;
+    QString errorString() const { return lastError; }
+
+    static constexpr int SliceMessages = 512;
+    static constexpr int MaxLineBytes = 4 * 1024 * 1024;
+
+private:
+    struct Client {
+        QLocalSocket *socket = nullptr;   // removed from clients when destroyed
+        QByteArray buffer;
+        bool scheduled = false;
+    };
+
+    void accept();
+    void process(QLocalSocket *socket);
+    Client *clientFor(QLocalSocket *socket);
+
+    Handler handler;
+    QLocalServer *server = nullptr;
+    std::vector<Client> clients;
+    QString lastError;
+};
@@ -0,0 +1,262 @@
+#include "BluffOptimiser.h"
+#include "SetupRules.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
+namespace {
+// Score weights; only their order of magnitude matters
+constexpr float kTownsfolk = 10;      // the natural bluff
+constexpr float kOutsider = 2;        // costs the Demon a strong ability
+constexpr float kWakes = 4;           // gives the bluffer info to report
+constexpr float kPublicAbility = -15; // its effect can be checked in the open
+constexpr float kClaimed = -100;      // someone else already claims it
+constexpr float kShown = -30;         // logged info put it on good players
+constexpr float kCover = 8;           // logged info put it on the Demon
+constexpr float kOutsiderCount = -40; // per Outsider claim the setup cannot explain
+
+constexpr int kDeltaZero = 16;        // bit of delta 0 in an outsider-delta set
+
+inline std::uint64_t bit(int i) { return std::uint64_t(1) << i; }
+inline int lowestBit(std::uint64_t bits) { return int(qCountTrailingZeroBits(quint64(bits))); }
+
+std::uint64_t deltaMask(const SetupModifier &mod) {
+    if (mod.anyOutsiders) return ~std::uint64_t(0);
+    std::uint64_t mask = 0;
+    for (int d : mod.outsiderDeltas)
+        if (d + kDeltaZero >= 0 && d + kDeltaZero < 64) mask |= bit(d + kDeltaZero);
+    return mask;
+}
+
+// Every sum of one delta from each set
+std::uint64_t sumset(std::uint64_t a, std::uint64_t b) {
+    std::uint64_t out = 0;
+    for (; b; b &= b - 1) {
+        int shift = lowestBit(b) - kDeltaZero;
+        out |= shift >= 0 ? a << shift : a >> -shift;
+    }
+    return out;
+}
+} // namespace
+
+BluffOptimiser::BluffOptimiser(const GameState &state, std::mt19937 *rng) {
+    std::unordered_set<QString> inPlay;
+    std::uint32_t demonSeats = 0;
+    int seated = 0;
+    for (int s = 0; s < int(state.players.size()); ++s) {
+        const Player &p = state.players[s];
+        inPlay.insert(p.character.id);
+        if (p.character.team == "demon" && s < 32) demonSeats |= std::uint32_t(1) << s;
+        if (p.character.team != "traveller") ++seated;
+    }
+    for (auto &c : state.bluffCandidates())
+        if (!inPlay.count(c.id)) chars.push_back(c);
+    if (rng) std::shuffle(chars.begin(), chars.end(), *rng);
+
+    // ---- outsider counts, as the town sees them ----
+    auto team = [&state](const QString &id) {
+        auto it = state.characterDB().find(id);
+        return it == state.characterDB().end() ? QString() : it->second.team;
+    };
+    auto cfg = GameState::role_config.find(seated);
+    outsidersChecked = cfg != GameState::role_config.end();
+    if (outsidersChecked) {
+        auto it = cfg->second.find("outsider");
+        baseOutsiders = it == cfg->second.end() ? 0 : it->second;
+    }
+
+    knownDeltas = bit(kDeltaZero);
+    for (auto &p : state.players) {
+        // What the player presents: their claim, else an honest good character
+        QString shown = p.claim;
+        if (shown.isEmpty() && (p.character.team == "townsfolk" || p.character.team == "outsider")
+            && p.character.id != "drunk")
+            shown = p.character.id;
+        if (shown.isEmpty()) continue;
+        if (team(shown) == "outsider") ++visibleOutsiders;
+        auto c = state.characterDB().find(shown);
+        if (c == state.characterDB().end()) continue;
+        SetupModifier mod = parseSetupModifier(c->second);
+        if (mod.anyOutsiders) outsidersChecked = false;
+        if (!mod.outsiderDeltas.empty()) knownDeltas = sumset(knownDeltas, deltaMask(mod));
+    }
+
+    hiddenDeltas = bit(kDeltaZero);
+    for (auto &c : state.scriptCharacters()) {
+        if (c.id == "drunk") drunkOnScript = true;
+        if (c.team != "minion" && c.team != "demon") continue;
+        SetupModifier mod = parseSetupModifier(c);
+        if (mod.anyOutsiders) outsidersChecked = false;
+        // Optional: the modifier may or may not be in play
+        if (!mod.outsiderDeltas.empty()) hiddenDeltas |= sumset(hiddenDeltas, deltaMask(mod));
+    }
+
+    // ---- per-candidate features ----
+    const int m = int(chars.size());
+    base.assign(m, 0);
+    outsider.assign(m, 0);
+    modDeltas.assign(m, 0);
+    notes.assign(m, {});
+    for (int i = 0; i < m; ++i) {
+        const Character &c = chars[i];
+        outsider[i] = c.team == "outsider";
+        base[i] = outsider[i] ? kOutsider : kTownsfolk;
+        if (!c.firstNightReminder.isEmpty() || !c.otherNightReminder.isEmpty()) base[i] += kWakes;
+        if (c.ability.contains("publicly", Qt::CaseInsensitive)
+            || c.ability.contains("nominated", Qt::CaseInsensitive)) {
+            base[i] += kPublicAbility;
+            notes[i] << QString("%1 has a public effect").arg(c.name);
+        }
+        SetupModifier mod = parseSetupModifier(c);
+        if (mod.active()) modDeltas[i] = mod.outsiderDeltas.empty() && !mod.anyOutsiders
+                                             ? bit(kDeltaZero) : deltaMask(mod);
+
+        for (auto &p : state.players) {
+            if (p.claim != c.id) continue;
+            base[i] += kClaimed;
+            notes[i] << QString("%1 is claimed by %2").arg(c.name, p.name);
+        }
+        for (auto &r : state.info_log) {
+            if (r.character != c.id || r.seats.empty()) continue;
+            bool onDemon = false;
+            for (int s : r.seats)
+                if (s >= 0 && s < 32 && (demonSeats >> s & 1)) onDemon = true;
+            base[i] += onDemon ? kCover : kShown;
+            if (!onDemon && r.seat >= 0 && r.seat < int(state.players.size()))
+                notes[i] << QString("%1 was shown to %2").arg(c.name, state.players[r.seat].name);
+        }
+    }
+
+    for (int k = 0; k < 4; ++k) penaltyByCount[k] = outsiderPenalty(k, 0);
+}
+
+// ---------- Outsider counts ----------
+// Bit v set when the town could see v Outsiders claimed, given modifiers
+// that must be in play (`requiredDeltas`, 0 = none)
+std::uint64_t BluffOptimiser::plausibleCounts(std::uint64_t requiredDeltas) const {
+    std::uint64_t deltas = sumset(knownDeltas, hiddenDeltas);
+    if (requiredDeltas) deltas = sumset(deltas, requiredDeltas);
+    std::uint64_t counts = 0;
+    for (; deltas; deltas &= deltas - 1) {
+        int v = baseOutsiders + lowestBit(deltas) - kDeltaZero;
+        if (v < 0 || v >= 64) continue;
+        counts |= bit(v);
+        if (drunkOnScript && v > 0) counts |= bit(v - 1);
+    }
+    return counts;
+}
+
+float BluffOptimiser::outsiderPenalty(int added, std::uint64_t requiredDeltas) const {
+    if (!outsidersChecked) return 0;
+    std::uint64_t counts = plausibleCounts(requiredDeltas);
+    float penalty = 0;
+    // A claimed modifier must also explain the Outsiders already out there
+    for (int j = requiredDeltas ? 0 : 1; j <= added; ++j) {
+        int v = visibleOutsiders + j;
+        if (v >= 64 || !(counts >> v & 1)) penalty += kOutsiderCount;
+    }
+    return penalty;
+}
+
+// ---------- Ranking ----------
+std::vector<BluffOptimiser::Option> BluffOptimiser::rank(int count) const {
+    const int m = int(chars.size());
+    std::vector<Option> out;
+    if (m < 3) {
+        if (m == 0 || count <= 0) return out;
+        Option o;
+        o.picks.resize(m);
+        std::iota(o.picks.begin(), o.picks.end(), 0);
+        out.push_back(o);
+        return out;
+    }
+
+    // Flat score array in (a, b, c) lexicographic order; the inner loop over c
+    // is a plain add + table lookup per element
+    const size_t total = size_t(m) * (m - 1) * (m - 2) / 6;
+    std::vector<float> scores(total);
+    size_t at = 0;
+    for (int a = 0; a < m; ++a) {
+        for (int b = a + 1; b < m; ++b) {
+            const float ab = base[a] + base[b];
+            const int oab = outsider[a] + outsider[b];
+            float *row = scores.data() + at;
+            const float *bc = base.data() + b + 1;
+            const std::uint8_t *oc = outsider.data() + b + 1;
+            const int len = m - b - 1;
+            for (int k = 0; k < len; ++k)
+                row[k] = ab + bc[k] + penaltyByCount[oab + oc[k]];
+
+            // Combinations that claim a setup modifier need their own count check
+            if (modDeltas[a] || modDeltas[b]) {
+                for (int k = 0; k < len; ++k) {
+                    std::uint64_t req = modDeltas[a] ? modDeltas[a] : bit(kDeltaZero);
+                    if (modDeltas[b]) req = sumset(req, modDeltas[b]);
+                    if (modDeltas[b + 1 + k]) req = sumset(req, modDeltas[b + 1 + k]);
+                    row[k] += outsiderPenalty(oab + oc[k], req) - penaltyByCount[oab + oc[k]];
+                }
+            } else {
+                for (int k = 0; k < len; ++k) {
+                    if (!modDeltas[b + 1 + k]) continue;
+                    row[k] += outsiderPenalty(oab + oc[k], modDeltas[b + 1 + k]) - penaltyByCount[oab + oc[k]];
+                }
+            }
+            at += len;
+        }
+    }
+
+    std::vector<std::uint32_t> order(total);
+    std::iota(order.begin(), order.end(), 0u);
+    const size_t keep = std::min<size_t>(size_t(std::max(count, 0)), total);
+    std::partial_sort(order.begin(), order.begin() + keep, order.end(),
+                      [&scores](std::uint32_t x, std::uint32_t y) {
+                          return scores[x] != scores[y] ? scores[x] > scores[y] : x < y;
+                      });
+
+    // Decode the kept indices back into (a, b, c)
+    for (size_t r = 0; r < keep; ++r) {
+        size_t idx = order[r];
+        int a = 0, b = 0;
+        for (;;) {
+            size_t rows = size_t(m - a - 1) * (m - a - 2) / 2;
+            if (idx < rows) break;
+            idx -= rows;
+            ++a;
+        }
+        for (b = a + 1;; ++b) {
+            size_t len = size_t(m - b - 1);
+            if (idx < len) break;
+            idx -= len;
+        }
+        int c = b + 1 + int(idx);
+
+        Option o;
+        o.picks = {a, b, c};
+        o.score = scores[order[r]];
+        for (int i : o.picks) o.concerns << notes[i];
+        int added = outsider[a] + outsider[b] + outsider[c];
+        std::uint64_t req = 0;
+        for (int i : o.picks)
+            if (modDeltas[i]) req = req ? sumset(req, modDeltas[i]) : modDeltas[i];
+        if (outsiderPenalty(added, req) < 0)
+            o.concerns << QString("Outsider count would not add up (%1 claimed now)").arg(visibleOutsiders);
+        out.push_back(o);
+    }
+    return out;
+}
+
+std::vector<Character> BluffOptimiser::charactersOf(const Option &option) const {
+    std::vector<Character> result;
+    for (int i : option.picks)
+        if (i >= 0 && i < int(chars.size())) result.push_back(chars[i]);
+    return result;
+}
+
+QString BluffOptimiser::describe(const Option &option) const {
+    QStringList names;
+    for (auto &c : charactersOf(option)) names << c.name;
+    QString text = QString("%1 (score %2)").arg(names.join(", ")).arg(double(option.score), 0, 'f', 0);
+    if (!option.concerns.isEmpty()) text += " - " + option.concerns.join("; ");
+    return text;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "GameState.h"
+
+// ---------- Bluff optimiser ----------
+// Scores every 3-combination of not-in-play Townsfolk and Outsiders as Demon
+// bluffs for the current grimoire. Each candidate is reduced once to a few
+// numbers (its own score, whether it is an Outsider, its setup modifier as a
+// bitset of outsider deltas); a combination's score is then the sum of its
+// three candidates plus an Outsider-count term looked up by how many
+// Outsiders it adds. A bluff loses points when:
+//  - another player already claims it (e.g. the Drunk)
+//  - logged info showed it to someone and no Demon was among the seats shown
+//  - its ability has a public, checkable effect (Slayer, Virgin, ...)
+//  - claiming it would put more Outsiders in the circle than the
+//    distribution plus any possible setup modifier explains
+class BluffOptimiser {
+public:
+    struct Option {
+        std::vector<int> picks;     // indices into eligible(), ascending
+        float score = 0;
+        QStringList concerns;       // why it lost points, for the Storyteller
+    };
+
+    // With `rng`, candidates are shuffled first so equal scores rank in random order
+    explicit BluffOptimiser(const GameState &state, std::mt19937 *rng = nullptr);
+
+    // The best `count` combinations, best first. Fewer than three eligible
+    // characters give a single option holding all of them.
+    std::vector<Option> rank(int count) const;
+
+    std::vector<Character> charactersOf(const Option &option) const;
+    QString describe(const Option &option) const;
+
+    const std::vector<Character> &eligible() const { return chars; }
+
+private:
+    float outsiderPenalty(int added, std::uint64_t requiredDeltas) const;
+    std::uint64_t plausibleCounts(std::uint64_t requiredDeltas) const;
+
+    std::vector<Character> chars;
+    std::vector<float> base;               // per candidate, summed per combination
+    std::vector<std::uint8_t> outsider;    // 1 if an Outsider
+    std::vector<std::uint64_t> modDeltas;  // outsider deltas it claims (bit 16 = 0), 0 = none
+    std::vector<QStringList> notes;
+
+    bool outsidersChecked = false;         // false without a distribution or with "[X Outsiders]" in play
+    int baseOutsiders = 0;
+    int visibleOutsiders = 0;              // Outsiders the town currently sees claimed
+    std::uint64_t knownDeltas = 0;         // modifiers visibly in play
+    std::uint64_t hiddenDeltas = 0;        // modifiers evil may secretly have in play
+    bool drunkOnScript = false;            // one Outsider may be hidden as the Drunk
+    float penaltyByCount[4] = {};          // outsiderPenalty(k, 0) for k added Outsiders
+};
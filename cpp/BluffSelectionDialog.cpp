@@ -1,9 +1,36 @@
 #include "BluffSelectionDialog.h"
+#include <QComboBox>
+#include <QVBoxLayout>
 
-BluffSelectionDialog::BluffSelectionDialog(const std::vector<Character>& characters, QWidget* parent)
+BluffSelectionDialog::BluffSelectionDialog(const std::vector<Character>& characters,
+                                           const std::vector<BluffSuggestion>& suggestions,
+                                           QWidget* parent)
     : CharacterSelectionDialog(characters, 3, parent)
 {
-    // The base constructor already builds the UI and calls setupCircle()
+    setWindowTitle("Select Bluffs");
+
+    // Ranked combinations go above the token list; picking one checks its three characters
+    if (!suggestions.empty()) {
+        auto *combo = new QComboBox(this);
+        combo->addItem("Suggested bluffs...");
+        for (auto &s : suggestions) combo->addItem(s.label);
+        if (auto *box = qobject_cast<QVBoxLayout*>(layout())) box->insertWidget(0, combo);
+        connect(combo, &QComboBox::activated, this, [this, combo, suggestions](int index) {
+            if (index <= 0) return;
+            setSelectedIds(suggestions[index - 1].ids);
+            combo->setCurrentIndex(0);
+        });
+    }
+
+    // The base constructor already builds the UI and calls setupCircle();
+    // re-run the count update so our own legality check applies
+    updateCounts();
+}
+
+bool BluffSelectionDialog::isSelectionPlayable(QString *reason) const {
+    if (validator.total() == 3) return true;
+    if (reason) *reason = QString("Select exactly 3 bluffs (%1 selected)").arg(validator.total());
+    return false;
 }
 
 void BluffSelectionDialog::accept() {
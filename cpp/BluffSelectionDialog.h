@@ -2,11 +2,20 @@
 #include "CharacterSelectionDialog.h"
 #include <QMessageBox>
 
+// A ranked bluff combination the Storyteller can pick in one go
+struct BluffSuggestion {
+    QString label;
+    std::vector<QString> ids;
+};
+
 class BluffSelectionDialog : public CharacterSelectionDialog {
     Q_OBJECT
 public:
-    explicit BluffSelectionDialog(const std::vector<Character>& characters, QWidget* parent = nullptr);
+    explicit BluffSelectionDialog(const std::vector<Character>& characters,
+                                  const std::vector<BluffSuggestion>& suggestions = {},
+                                  QWidget* parent = nullptr);
 
 protected:
+    bool isSelectionPlayable(QString *reason) const override;
     void accept() override;
 };
@@ -0,0 +1,147 @@
+#include "CharacterListModel.h"
+#include "IconCache.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+
+// ---------- CharacterListModel ----------
+CharacterListModel::CharacterListModel(const std::vector<Character> &chars, QObject *parent)
+    : QAbstractListModel(parent), characters(chars), selected(chars.size(), 0)
+{
+    // Sort characters by team, keeping script order within a team
+    std::stable_sort(characters.begin(), characters.end(),
+                     [](const Character &a, const Character &b) {
+                         return teamOrder(a.team) < teamOrder(b.team);
+                     });
+
+    for (size_t i = 0; i < characters.size(); ++i)
+        rowByName.insert(characters[i].name, static_cast<int>(i));
+
+    // Repaint a row once its icon has been decoded off-thread
+    connect(&IconCache::instance(), &IconCache::iconReady, this, [this](const QString &name) {
+        auto it = rowByName.constFind(name);
+        if (it == rowByName.constEnd()) return;
+        QModelIndex idx = index(*it);
+        emit dataChanged(idx, idx, {Qt::DecorationRole});
+    });
+}
+
+int CharacterListModel::teamOrder(const QString &team) {
+    static const QMap<QString, int> order = {
+        {"townsfolk", 0},
+        {"outsider", 1},
+        {"minion", 2},
+        {"demon", 3},
+        {"evil townsfolk", 4}
+    };
+    return order.value(team, 100);
+}
+
+int CharacterListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(characters.size());
+}
+
+QVariant CharacterListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount()) return {};
+    const Character &c = characters[index.row()];
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return c.name;
+    case Qt::ToolTipRole:
+        return c.ability;
+    case Qt::CheckStateRole:
+        return selected[index.row()] ? Qt::Checked : Qt::Unchecked;
+    case Qt::DecorationRole:
+        // Requested on first paint of this row only; placeholder until decoded
+        return IconCache::instance().pixmap(c.name, c.team, iconSize);
+    case TeamRole:
+        return c.team;
+    case IdRole:
+        return c.id;
+    default:
+        return {};
+    }
+}
+
+bool CharacterListModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+    if (!index.isValid() || role != Qt::CheckStateRole) return false;
+    bool checked = value.toInt() == Qt::Checked;
+    if (bool(selected[index.row()]) == checked) return true;
+    toggle(index.row());
+    return true;
+}
+
+Qt::ItemFlags CharacterListModel::flags(const QModelIndex &index) const {
+    if (!index.isValid()) return Qt::NoItemFlags;
+    // Not user-checkable: the dialog toggles on a click anywhere on the
+    // token, and the delegate would toggle a check indicator click again
+    return Qt::ItemIsEnabled;
+}
+
+void CharacterListModel::toggle(int row) {
+    if (row < 0 || row >= rowCount()) return;
+    selected[row] = !selected[row];
+    QModelIndex idx = index(row);
+    emit dataChanged(idx, idx, {Qt::CheckStateRole});
+    emit selectionToggled(row, selected[row]);
+}
+
+std::vector<Character> CharacterListModel::selectedCharacters() const {
+    std::vector<Character> result;
+    for (size_t i = 0; i < characters.size(); ++i)
+        if (selected[i]) result.push_back(characters[i]);
+    return result;
+}
+
+// ---------- CharacterTokenDelegate ----------
+CharacterTokenDelegate::CharacterTokenDelegate(int tokenSize, QObject *parent)
+    : QStyledItemDelegate(parent), tokenSize(tokenSize)
+{
+}
+
+QSize CharacterTokenDelegate::sizeHint(const QStyleOptionViewItem &, const QModelIndex &) const {
+    return QSize(tokenSize, tokenSize);
+}
+
+void CharacterTokenDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                                   const QModelIndex &index) const {
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    QRectF r = QRectF(option.rect).adjusted(2, 2, -2, -2);
+    bool checked = index.data(Qt::CheckStateRole).toInt() == Qt::Checked;
+    QString team = index.data(CharacterListModel::TeamRole).toString();
+
+    // Team-coloured disc
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(QColor(StorytellerWindow::colors.value(team, "gray")));
+    painter->drawEllipse(r);
+
+    // Character art clipped to the disc
+    QPixmap pm = index.data(Qt::DecorationRole).value<QPixmap>();
+    if (!pm.isNull()) {
+        QPainterPath clip;
+        clip.addEllipse(r);
+        painter->setClipPath(clip);
+        painter->drawPixmap(r.toRect(), pm);
+        painter->setClipping(false);
+    }
+
+    // Name and team
+    painter->setPen(Qt::white);
+    QFont f = option.font;
+    f.setPixelSize(12);
+    painter->setFont(f);
+    painter->drawText(r, Qt::AlignCenter | Qt::TextWordWrap,
+                      index.data(Qt::DisplayRole).toString() + "\n(" + team + ")");
+
+    // Selection ring
+    if (checked) {
+        painter->setPen(QPen(QColor("gold"), 3));
+        painter->setBrush(Qt::NoBrush);
+        painter->drawEllipse(r.adjusted(1.5, 1.5, -1.5, -1.5));
+    }
+
+    painter->restore();
+}
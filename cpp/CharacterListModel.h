@@ -0,0 +1,61 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QHash>
+#include <QStyledItemDelegate>
+#include <vector>
+#include "storyteller.h" // for Character, StorytellerWindow::colors
+
+// ---------- Character list model ----------
+// Flat list of characters sorted by team (townsfolk, outsider, minion, demon, ...)
+// with a checked flag per row. Icons are only loaded when a row is painted.
+class CharacterListModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum Roles {
+        TeamRole = Qt::UserRole + 1,
+        IdRole
+    };
+
+    explicit CharacterListModel(const std::vector<Character> &characters,
+                                QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    const Character &characterAt(int row) const { return characters[row]; }
+    bool isSelected(int row) const { return selected[row]; }
+    void toggle(int row);
+
+    std::vector<Character> selectedCharacters() const;
+
+    static int teamOrder(const QString &team);
+
+    static constexpr int iconSize = 75;
+
+signals:
+    void selectionToggled(int row, bool selected);
+
+private:
+    std::vector<Character> characters;
+    std::vector<char> selected;
+    QHash<QString, int> rowByName;
+};
+
+// ---------- Character token delegate ----------
+// Paints a round team-coloured token with the character art, name and a gold
+// ring when checked. Only visible cells are ever painted by the view.
+class CharacterTokenDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    explicit CharacterTokenDelegate(int tokenSize, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option,
+                   const QModelIndex &index) const override;
+
+private:
+    int tokenSize;
+};
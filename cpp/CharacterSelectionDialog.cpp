@@ -1,8 +1,6 @@
 #include "CharacterSelectionDialog.h"
 #include <QVBoxLayout>
 #include <QDialogButtonBox>
-#include <QScrollArea>
-#include <QGridLayout>
 #include <QMessageBox>
 #include <QDebug>
 #include <algorithm>
@@ -10,19 +8,16 @@
 CharacterSelectionDialog::CharacterSelectionDialog(const std::vector<Character> &characters,
                                                    int numPlayers,
                                                    QWidget *parent)
-    : QDialog(parent), allCharacters(characters), numPlayers(numPlayers)
+    : QDialog(parent), validator(numPlayers), allCharacters(characters), numPlayers(numPlayers)
 {
     setWindowTitle("Select Characters");
     resize(800, 800);
 
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
 
-    // Scrollable area
-    QScrollArea *scrollArea = new QScrollArea(this);
-    scrollArea->setWidgetResizable(true);
-    circleWidget = new QWidget();
-    scrollArea->setWidget(circleWidget);
-    mainLayout->addWidget(scrollArea);
+    // Icon-mode list view: only visible cells are laid out and painted
+    listView = new QListView(this);
+    mainLayout->addWidget(listView);
 
     countsLabel = new QLabel(this);
     countsLabel->setAlignment(Qt::AlignCenter);
@@ -31,97 +26,98 @@ CharacterSelectionDialog::CharacterSelectionDialog(const std::vector<Character>
     QDialogButtonBox *buttons =
         new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
     mainLayout->addWidget(buttons);
+    okButton = buttons->button(QDialogButtonBox::Ok);
     connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
     connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
 
+    // The recommended distribution does not change while the dialog is open
+    if (GameState::role_config.count(numPlayers)) {
+        recommendedText = "\nRecommended:\n";
+        const auto &rec = GameState::role_config.at(numPlayers);
+        for (auto &team : GameState::all_teams) {
+            int value = 0;
+            auto it = rec.find(team);
+            if (it != rec.end())
+                value = it->second;
+            recommendedText += QString("%1: %2  ").arg(team).arg(value);
+        }
+    }
+
     setupCircle();
     updateCounts();
 }
 
 std::vector<Character> CharacterSelectionDialog::selectedCharacters() const {
-    std::vector<Character> result;
-    for (auto &c : allCharacters) {
-        if (selectedMap.count(c.id) && selectedMap.at(c.id))
-            result.push_back(c);
-    }
-    return result;
+    return model->selectedCharacters();
 }
 
 void CharacterSelectionDialog::setupCircle() {
-    int n = allCharacters.size();
     int buttonSize = 75;
-    int columns = 9;
-
-    // Sort characters by team
-    QMap<QString, int> teamOrder = {
-        {"townsfolk", 0},
-        {"outsider", 1},
-        {"minion", 2},
-        {"demon", 3},
-        {"evil townsfolk", 4}
-    };
-
-    std::vector<Character> sortedChars = allCharacters;
-    std::sort(sortedChars.begin(), sortedChars.end(),
-              [&](const Character &a, const Character &b) {
-                  int orderA = teamOrder.value(a.team, 100);
-                  int orderB = teamOrder.value(b.team, 100);
-                  return orderA < orderB;
-              });
-
-    // Grid layout for scrollable area
-    QGridLayout *grid = new QGridLayout(circleWidget);
-    grid->setSpacing(10);
-    grid->setAlignment(Qt::AlignTop | Qt::AlignHCenter);
-
-    for (int i = 0; i < n; ++i) {
-        const Character &c = sortedChars[i];
-        QPushButton *btn =
-            new QPushButton(c.name + "\n(" + c.team + ")", circleWidget);
-        btn->setFixedSize(buttonSize, buttonSize);
-        btn->setCheckable(true);
-        btn->setStyleSheet(QString(
-                               "QPushButton { border-radius:%1px; background:%2; color:white; font-size:12px; }"
-                               "QPushButton:checked { border:3px solid gold; }")
-                               .arg(buttonSize / 2)
-                               .arg(StorytellerWindow::colors.value(c.team, "gray")));
-
-        selectedMap[c.id] = false;
-
-        connect(btn, &QPushButton::toggled, [this, c](bool checked) {
-            selectedMap[c.id] = checked;
-            updateCounts();
-        });
-
-        int row = i / columns;
-        int col = i % columns;
-        grid->addWidget(btn, row, col);
+
+    model = new CharacterListModel(allCharacters, this);
+
+    listView->setViewMode(QListView::IconMode);
+    listView->setMovement(QListView::Static);
+    listView->setResizeMode(QListView::Adjust);
+    listView->setUniformItemSizes(true);
+    listView->setLayoutMode(QListView::Batched);
+    listView->setBatchSize(64);
+    listView->setSpacing(5);
+    listView->setSelectionMode(QAbstractItemView::NoSelection);
+    listView->setItemDelegate(new CharacterTokenDelegate(buttonSize, listView));
+    listView->setModel(model);
+
+    // Team and setup modifier are resolved once per row, not per toggle
+    rowTeams.reserve(model->rowCount());
+    rowModifiers.reserve(model->rowCount());
+    for (int row = 0; row < model->rowCount(); ++row) {
+        const Character &c = model->characterAt(row);
+        rowTeams.push_back(SetupValidator::teamIndex(c.team));
+        rowModifiers.push_back(parseSetupModifier(c));
     }
+
+    connect(listView, &QListView::clicked, model, [this](const QModelIndex &idx) {
+        model->toggle(idx.row());
+    });
+    connect(model, &CharacterListModel::selectionToggled, this, &CharacterSelectionDialog::onToggled);
 }
 
-void CharacterSelectionDialog::updateCounts() {
-    std::unordered_map<QString, int> counts;
-    for (auto &c : allCharacters)
-        if (selectedMap[c.id])
-            counts[c.team]++;
+void CharacterSelectionDialog::onToggled(int row, bool selected) {
+    if (selected)
+        validator.add(row, rowTeams[row], rowModifiers[row]);
+    else
+        validator.remove(row, rowTeams[row]);
+    updateCounts();
+}
 
-    QString selectedText = "Selected:\n";
-    for (auto &team : StorytellerWindow::all_teams)
-        selectedText += QString("%1: %2  ").arg(team).arg(counts[team]);
+void CharacterSelectionDialog::setSelectedIds(const std::vector<QString> &ids) {
+    for (int row = 0; row < model->rowCount(); ++row) {
+        bool wanted = std::find(ids.begin(), ids.end(), model->characterAt(row).id) != ids.end();
+        if (model->isSelected(row) != wanted) model->toggle(row);
+    }
+}
 
-    QString recommendedText;
-    int total = numPlayers;
-    if (StorytellerWindow::role_config.count(total)) {
-        recommendedText = "\nRecommended:\n";
-        auto rec = StorytellerWindow::role_config.at(total);
-        for (auto &team : StorytellerWindow::all_teams) {
-            int value = 0;
-            auto it = rec.find(team);
-            if (it != rec.end())
-                value = it->second;
-            recommendedText += QString("%1: %2  ").arg(team).arg(value);
-        }
+bool CharacterSelectionDialog::isSelectionPlayable(QString *reason) const {
+    SetupValidator::Verdict v = validator.validate();
+    if (reason) *reason = v.reason;
+    return v.playable;
+}
+
+void CharacterSelectionDialog::updateCounts() {
+    QString selectedText = "Selected:\n";
+    for (int t = 0; t < SetupValidator::Other; ++t) {
+        auto team = static_cast<SetupValidator::Team>(t);
+        if (team == SetupValidator::Traveller && validator.count(team) == 0) continue;
+        selectedText += QString("%1: %2  ").arg(SetupValidator::teamName(team)).arg(validator.count(team));
     }
 
-    countsLabel->setText(selectedText + recommendedText);
+    QString reason;
+    bool playable = isSelectionPlayable(&reason);
+    QString statusText = playable ? "\nSelection is playable" : "\n" + reason;
+
+    countsLabel->setText(selectedText + recommendedText + statusText);
+    if (okButton->isEnabled() != playable || countsLabel->styleSheet().isEmpty()) {
+        countsLabel->setStyleSheet(playable ? "color:limegreen;" : "color:red;");
+        okButton->setEnabled(playable);
+    }
 }
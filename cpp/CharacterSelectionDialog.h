@@ -2,9 +2,11 @@
 #include <QDialog>
 #include <QPushButton>
 #include <QLabel>
+#include <QListView>
 #include <vector>
-#include <unordered_map>
 #include "storyteller.h" // for Character, StorytellerWindow::colors, etc.
+#include "CharacterListModel.h"
+#include "SetupRules.h"
 
 class CharacterSelectionDialog : public QDialog {
     Q_OBJECT
@@ -15,15 +17,28 @@ public:
 
     std::vector<Character> selectedCharacters() const;
 
+protected:
+    // Returns whether the current selection can be accepted; fills reason otherwise
+    virtual bool isSelectionPlayable(QString *reason) const;
+    void updateCounts();
+    // Checks exactly the rows whose character id is in `ids`
+    void setSelectedIds(const std::vector<QString> &ids);
+
+    SetupValidator validator;
+
 private:
-    QWidget *circleWidget;
+    QListView *listView;
+    CharacterListModel *model;
     QLabel *countsLabel;
+    QPushButton *okButton;
+    QString recommendedText;
     std::vector<Character> allCharacters;
-    std::unordered_map<QString,bool> selectedMap; // map by character ID
+    std::vector<SetupValidator::Team> rowTeams;
+    std::vector<SetupModifier> rowModifiers;
     int numPlayers;
 
     void setupCircle();
-    void updateCounts();
+    void onToggled(int row, bool selected);
 };
 
 
@@ -0,0 +1,80 @@
+#include "FalseInfoRecommender.h"
+#include <QElapsedTimer>
+#include <algorithm>
+
+// Cap on cached worlds; past this the ranking works from a partial sample
+// and says so (Ranking::truncated)
+static constexpr std::uint64_t kMaxCachedWorlds = 500000;
+
+static std::vector<QString> claimsOf(const GameState &state) {
+    std::vector<QString> out;
+    for (auto &p : state.players) out.push_back(p.claim);
+    return out;
+}
+
+static std::vector<QString> scriptOf(const GameState &state) {
+    std::vector<QString> out;
+    for (auto &c : state.scriptCharacters()) out.push_back(c.id);
+    return out;
+}
+
+bool FalseInfoRecommender::cacheUsable(const GameState &state) const {
+    if (!valid || claims != claimsOf(state) || script != scriptOf(state)) return false;
+    if (info.size() > state.info_log.size()) return false;
+    if (!std::equal(info.begin(), info.end(), state.info_log.begin())) return false;
+    if (info.size() == state.info_log.size()) return true;
+
+    // Filtering keeps one representative per world, which is only exact when
+    // no unclaimed seat had a character picked for it
+    return std::none_of(state.players.begin(), state.players.end(),
+                        [](const Player &p) { return p.claim.isEmpty(); });
+}
+
+FalseInfoRecommender::Ranking FalseInfoRecommender::rank(const GameState &state,
+                                                         const std::vector<InfoRecord> &candidates) {
+    Ranking ranking;
+    QElapsedTimer timer;
+    timer.start();
+
+    WorldSolver solver(state);
+    if (!solver.error().isEmpty()) {
+        ranking.error = solver.error();
+        return ranking;
+    }
+
+    if (cacheUsable(state)) {
+        if (info.size() != state.info_log.size()) {
+            worlds.erase(std::remove_if(worlds.begin(), worlds.end(),
+                                        [&](const WorldSolver::World &w) { return !solver.fitsInfo(w); }),
+                         worlds.end());
+            info = state.info_log;
+        }
+        ranking.fromCache = true;
+    } else {
+        WorldSolver::Options options;
+        options.keepWorlds = true;
+        options.maxWorlds = kMaxCachedWorlds;
+        WorldSolver::Result result = solver.solve(options);
+        if (!result.error.isEmpty()) {
+            ranking.error = result.error;
+            return ranking;
+        }
+        worlds = std::move(result.kept);
+        truncated = result.truncated;
+        claims = claimsOf(state);
+        script = scriptOf(state);
+        info = state.info_log;
+        valid = true;
+    }
+
+    ranking.truncated = truncated;   // filtering a partial set leaves it partial
+    std::vector<std::uint32_t> kept = solver.teamsKeptAlive(worlds, candidates, &ranking.teams);
+    ranking.suggestions.reserve(candidates.size());
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+        ranking.suggestions.push_back({candidates[i], kept[i]});
+    std::stable_sort(ranking.suggestions.begin(), ranking.suggestions.end(),
+                     [](const Suggestion &a, const Suggestion &b) { return a.teams > b.teams; });
+
+    ranking.elapsedMs = timer.elapsed();
+    return ranking;
+}
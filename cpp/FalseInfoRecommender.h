@@ -0,0 +1,42 @@
+#pragma once
+#include <QString>
+#include <cstdint>
+#include <vector>
+#include "GameState.h"
+#include "WorldSolver.h"
+
+// ---------- False info recommender ----------
+// Ranks false info for a drunk or poisoned player by how many evil teams
+// (evil seats plus Demon seat) the town could still believe in if it were
+// true: the more it keeps open, the less it gives away or misleads.
+// Consistent worlds are cached between calls; when the only change since is
+// newly logged info, the cached worlds are filtered instead of solved again.
+class FalseInfoRecommender {
+public:
+    struct Suggestion {
+        InfoRecord record;
+        std::uint32_t teams = 0;         // evil teams still possible if this were true
+    };
+
+    struct Ranking {
+        std::vector<Suggestion> suggestions; // best first
+        std::uint32_t teams = 0;             // evil teams possible now
+        bool fromCache = false;
+        bool truncated = false;              // from a partial set of worlds (the cache cap)
+        qint64 elapsedMs = 0;
+        QString error;
+    };
+
+    Ranking rank(const GameState &state, const std::vector<InfoRecord> &candidates);
+    void clear() { valid = false; truncated = false; worlds.clear(); }
+
+private:
+    bool cacheUsable(const GameState &state) const;
+
+    bool valid = false;
+    std::vector<WorldSolver::World> worlds;
+    bool truncated = false;              // the solve behind `worlds` hit the cap
+    std::vector<QString> claims;         // what the cache was solved for
+    std::vector<QString> script;
+    std::vector<InfoRecord> info;
+};
@@ -0,0 +1,485 @@
+#include "GameArchive.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace {
+const char Magic[8] = {'B', 'O', 'T', 'C', 'A', 'R', 'C', '1'};
+
+template<typename T>
+void writeColumn(QIODevice &out, const T *data, std::size_t count) {
+    QByteArray bytes(qsizetype(count * sizeof(T)), Qt::Uninitialized);
+    qToLittleEndian<T>(data, qsizetype(count), bytes.data());
+    out.write(bytes);
+}
+
+template<typename T>
+bool readColumn(const QByteArray &file, qsizetype &at, std::vector<T> &column, std::size_t count) {
+    if (count > std::size_t(file.size() - at) / sizeof(T)) return false;
+    column.resize(count);
+    qFromLittleEndian<T>(file.constData() + at, qsizetype(count), column.data());
+    at += qsizetype(count * sizeof(T));
+    return true;
+}
+
+// Offsets are stored as each game's end; a valid run never goes back or
+// past the column it indexes
+bool toStarts(const std::vector<std::uint32_t> &ends, std::size_t total, std::vector<std::uint32_t> &starts) {
+    starts.assign(1, 0);
+    for (std::uint32_t end : ends) {
+        if (end < starts.back() || end > total) return false;
+        starts.push_back(end);
+    }
+    return starts.back() == total;
+}
+}
+
+// ---------- Building ----------
+GameArchive::Game GameArchive::fromState(const GameState &state, Winner winner) {
+    Game game;
+    game.script = state.scriptName();
+    for (const Player &p : state.players) game.seats.push_back({p.character.id, p.character.team});
+    game.days = state.day_log;
+    if (int(game.days.size()) < state.day) game.days.resize(state.day);
+    game.winner = winner;
+    return game;
+}
+
+int GameArchive::scriptIndex(const QString &name) {
+    auto it = scriptLookup.find(name);
+    if (it != scriptLookup.end()) return it->second;
+    int index = int(scriptNames.size());
+    scriptNames.push_back(name);
+    scriptLookup.emplace(name, index);
+    return index;
+}
+
+int GameArchive::characterIndex(const QString &id, const QString &team) {
+    if (id.isEmpty()) return NoCharacter;
+    auto it = characterLookup.find(id);
+    if (it != characterLookup.end()) return it->second;
+    if (characterIds.size() >= NoCharacter) return NoCharacter;
+    int index = int(characterIds.size());
+    characterIds.push_back({id, team});
+    characterLookup.emplace(id, index);
+    return index;
+}
+
+void GameArchive::append(const Game &game) {
+    script.push_back(std::uint16_t(scriptIndex(game.script)));
+    players.push_back(std::uint8_t(std::min<std::size_t>(game.seats.size(), 255)));
+    winner.push_back(game.winner);
+    const std::size_t dayCount = std::min<std::size_t>(game.days.size(), 255);
+    days.push_back(std::uint8_t(dayCount));
+
+    for (const Seat &s : game.seats) seats.push_back(std::uint16_t(characterIndex(s.character, s.team)));
+    seatStart.push_back(std::uint32_t(seats.size()));
+    for (std::size_t d = 0; d < dayCount; ++d) {
+        const DayRecord &r = game.days[d];
+        deaths.push_back(std::uint8_t(std::clamp(r.deaths, 0, 255)));
+        executions.push_back(std::int8_t(r.executed >= 0 && r.executed < 128 ? r.executed : -1));
+    }
+    dayStart.push_back(std::uint32_t(deaths.size()));
+    indexed = false;
+}
+
+void GameArchive::append(const GameArchive &other) {
+    std::vector<std::uint16_t> scriptMap, characterMap;
+    for (const QString &name : other.scriptNames) scriptMap.push_back(std::uint16_t(scriptIndex(name)));
+    for (const Seat &c : other.characterIds) characterMap.push_back(std::uint16_t(characterIndex(c.character, c.team)));
+
+    for (std::uint16_t s : other.script) script.push_back(scriptMap[s]);
+    players.insert(players.end(), other.players.begin(), other.players.end());
+    winner.insert(winner.end(), other.winner.begin(), other.winner.end());
+    days.insert(days.end(), other.days.begin(), other.days.end());
+
+    const std::uint32_t seatBase = std::uint32_t(seats.size());
+    for (std::uint16_t c : other.seats) seats.push_back(c == NoCharacter ? NoCharacter : characterMap[c]);
+    for (std::size_t g = 1; g < other.seatStart.size(); ++g) seatStart.push_back(seatBase + other.seatStart[g]);
+
+    const std::uint32_t dayBase = std::uint32_t(deaths.size());
+    deaths.insert(deaths.end(), other.deaths.begin(), other.deaths.end());
+    executions.insert(executions.end(), other.executions.begin(), other.executions.end());
+    for (std::size_t g = 1; g < other.dayStart.size(); ++g) dayStart.push_back(dayBase + other.dayStart[g]);
+    indexed = false;
+}
+
+void GameArchive::clear() {
+    *this = GameArchive();
+}
+
+GameArchive::Game GameArchive::game(int index) const {
+    Game game;
+    if (index < 0 || index >= games()) return game;
+    game.script = scriptNames[script[index]];
+    for (std::uint32_t i = seatStart[index]; i < seatStart[index + 1]; ++i)
+        game.seats.push_back(seats[i] == NoCharacter ? Seat{} : characterIds[seats[i]]);
+    for (std::uint32_t i = dayStart[index]; i < dayStart[index + 1]; ++i)
+        game.days.push_back({deaths[i], executions[i]});
+    game.winner = Winner(winner[index]);
+    return game;
+}
+
+// ---------- Files ----------
+void GameArchive::writeSegment(QIODevice &out) const {
+    json header;
+    header["games"] = games();
+    header["seats"] = seats.size();
+    header["days"] = deaths.size();
+    header["scripts"] = json::array();
+    for (const QString &name : scriptNames) header["scripts"].push_back(name.toStdString());
+    header["characters"] = json::array();
+    for (const Seat &c : characterIds)
+        header["characters"].push_back({{"id", c.character.toStdString()}, {"team", c.team.toStdString()}});
+
+    const QByteArray text = QByteArray::fromStdString(header.dump());
+    out.write(Magic, sizeof(Magic));
+    const std::uint32_t length = qToLittleEndian(std::uint32_t(text.size()));
+    out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+    out.write(text);
+
+    const std::size_t games = script.size();
+    writeColumn(out, script.data(), games);
+    writeColumn(out, players.data(), games);
+    writeColumn(out, winner.data(), games);
+    writeColumn(out, days.data(), games);
+    writeColumn(out, seatStart.data() + 1, games);
+    writeColumn(out, seats.data(), seats.size());
+    writeColumn(out, dayStart.data() + 1, games);
+    writeColumn(out, deaths.data(), deaths.size());
+    writeColumn(out, executions.data(), executions.size());
+}
+
+OpResult GameArchive::save(const QString &path) const {
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly))
+        return GameError{"Game Archive", QString("Cannot write %1.").arg(QFileInfo(path).fileName())};
+    writeSegment(out);
+    if (!out.commit())
+        return GameError{"Game Archive", QString("Cannot write %1.").arg(QFileInfo(path).fileName())};
+    return std::nullopt;
+}
+
+OpResult GameArchive::appendToFile(const QString &path) const {
+    QFile out(path);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Append))
+        return GameError{"Game Archive", QString("Cannot write %1.").arg(QFileInfo(path).fileName())};
+    writeSegment(out);
+    if (out.error() != QFileDevice::NoError)
+        return GameError{"Game Archive", QString("Cannot write %1.").arg(QFileInfo(path).fileName())};
+    return std::nullopt;
+}
+
+OpResult GameArchive::load(const QString &path) {
+    const QString file = QFileInfo(path).fileName();
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly)) return GameError{"Game Archive", QString("Cannot open %1.").arg(file)};
+    const QByteArray bytes = in.readAll();
+    const GameError corrupt{"Game Archive", QString("%1 is not a game archive or is damaged.").arg(file)};
+
+    clear();
+    qsizetype at = 0;
+    while (at < bytes.size()) {
+        if (bytes.size() - at < qsizetype(sizeof(Magic) + 4) || std::memcmp(bytes.constData() + at, Magic, sizeof(Magic)))
+            return corrupt;
+        at += sizeof(Magic);
+        const std::uint32_t length = qFromLittleEndian<std::uint32_t>(bytes.constData() + at);
+        at += 4;
+        if (length > std::uint64_t(bytes.size() - at)) return corrupt;
+        json header = json::parse(bytes.constData() + at, bytes.constData() + at + length, nullptr, false);
+        at += length;
+        if (!header.is_object()) return corrupt;
+
+        GameArchive segment;
+        if (!header["scripts"].is_array() || !header["characters"].is_array()) return corrupt;
+        for (auto &name : header["scripts"]) {
+            if (!name.is_string()) return corrupt;
+            segment.scriptNames.push_back(QString::fromStdString(name.get<std::string>()));
+        }
+        for (auto &c : header["characters"]) {
+            if (!c.is_object() || !c["id"].is_string() || !c["team"].is_string()) return corrupt;
+            segment.characterIds.push_back({QString::fromStdString(c["id"].get<std::string>()),
+                                            QString::fromStdString(c["team"].get<std::string>())});
+        }
+
+        auto size = [&header](const char *key) {
+            auto it = header.find(key);
+            return it != header.end() && it->is_number_unsigned() ? it->get<std::size_t>() : std::size_t(0);
+        };
+        const std::size_t games = size("games"), seatCount = size("seats"), dayCount = size("days");
+        std::vector<std::uint32_t> seatEnds, dayEnds;
+        if (!readColumn(bytes, at, segment.script, games) || !readColumn(bytes, at, segment.players, games)
+            || !readColumn(bytes, at, segment.winner, games) || !readColumn(bytes, at, segment.days, games)
+            || !readColumn(bytes, at, seatEnds, games) || !readColumn(bytes, at, segment.seats, seatCount)
+            || !readColumn(bytes, at, dayEnds, games) || !readColumn(bytes, at, segment.deaths, dayCount)
+            || !readColumn(bytes, at, segment.executions, dayCount))
+            return corrupt;
+        if (!toStarts(seatEnds, seatCount, segment.seatStart) || !toStarts(dayEnds, dayCount, segment.dayStart))
+            return corrupt;
+
+        // Everything a query indexes with must be in range
+        const std::size_t scripts = segment.scriptNames.size(), characters = segment.characterIds.size();
+        if (std::any_of(segment.script.begin(), segment.script.end(), [scripts](std::uint16_t s) { return s >= scripts; })
+            || std::any_of(segment.winner.begin(), segment.winner.end(), [](std::uint8_t w) { return w > Unfinished; })
+            || std::any_of(segment.seats.begin(), segment.seats.end(),
+                           [characters](std::uint16_t c) { return c != NoCharacter && c >= characters; }))
+            return corrupt;
+        append(segment);
+    }
+    return std::nullopt;
+}
+
+// ---------- Queries ----------
+GameArchive::GroupBy GameArchive::groupByFromString(const QString &name, bool *ok) {
+    static const std::pair<const char *, GroupBy> names[] = {
+        {"none", None}, {"script", ByScript}, {"players", ByPlayers}, {"winner", ByWinner},
+        {"days", ByDays}, {"character", ByCharacter}, {"demon", ByDemon}};
+    for (auto &n : names) {
+        if (name != n.first) continue;
+        if (ok) *ok = true;
+        return n.second;
+    }
+    if (ok) *ok = false;
+    return None;
+}
+
+void GameArchive::buildIndex() const {
+    if (indexed) return;
+    const std::size_t n = script.size();
+    words = std::max(1, int((characterIds.size() + 63) / 64));
+    inPlay.assign(n * words, 0);
+    executedSet.assign(n * words, 0);
+    deathTotal.assign(n, 0);
+    for (std::size_t g = 0; g < n; ++g) {
+        std::uint64_t *bits = inPlay.data() + g * words;
+        for (std::uint32_t i = seatStart[g]; i < seatStart[g + 1]; ++i)
+            if (seats[i] != NoCharacter) bits[seats[i] / 64] |= std::uint64_t(1) << (seats[i] % 64);
+
+        int total = 0;
+        std::uint64_t *executed = executedSet.data() + g * words;
+        for (std::uint32_t d = dayStart[g]; d < dayStart[g + 1]; ++d) {
+            total += deaths[d];
+            const int seat = executions[d];
+            if (seat < 0 || seatStart[g] + std::uint32_t(seat) >= seatStart[g + 1]) continue;
+            const std::uint16_t c = seats[seatStart[g] + seat];
+            if (c != NoCharacter) executed[c / 64] |= std::uint64_t(1) << (c % 64);
+        }
+        deathTotal[g] = std::uint8_t(std::min(total, 255));
+    }
+    indexed = true;
+}
+
+namespace {
+struct Count {
+    long games = 0;
+    long good = 0;
+    long evil = 0;
+    long watch = 0;
+    long days = 0;
+    long deaths = 0;
+
+    void merge(const Count &o) {
+        games += o.games;
+        good += o.good;
+        evil += o.evil;
+        watch += o.watch;
+        days += o.days;
+        deaths += o.deaths;
+    }
+};
+
+// A character set test on one bitset word: everything in `all`, nothing in `none`
+struct WordTest {
+    int word = 0;
+    std::uint64_t all = 0;
+    std::uint64_t none = 0;
+};
+}
+
+GameArchive::Result GameArchive::query(const Query &q) const {
+    QElapsedTimer timer;
+    timer.start();
+    buildIndex();
+
+    Result result;
+    const int n = games();
+    result.scanned = n;
+
+    // ---- resolve names to dictionary indices ----
+    bool impossible = false;
+    int scriptKey = -1;
+    if (!q.script.isEmpty()) {
+        auto it = scriptLookup.find(q.script);
+        if (it == scriptLookup.end()) impossible = true;
+        else scriptKey = it->second;
+    }
+    auto tests = [&](const std::vector<QString> &all, const std::vector<QString> &none) {
+        std::vector<WordTest> out(words);
+        for (int w = 0; w < words; ++w) out[w].word = w;
+        for (const QString &id : all) {
+            auto it = characterLookup.find(id);
+            if (it == characterLookup.end()) impossible = true;
+            else out[it->second / 64].all |= std::uint64_t(1) << (it->second % 64);
+        }
+        for (const QString &id : none) {
+            auto it = characterLookup.find(id);
+            if (it != characterLookup.end()) out[it->second / 64].none |= std::uint64_t(1) << (it->second % 64);
+        }
+        out.erase(std::remove_if(out.begin(), out.end(), [](const WordTest &t) { return !t.all && !t.none; }), out.end());
+        return out;
+    };
+    const std::vector<WordTest> playTests = tests(q.with, q.without);
+    const std::vector<WordTest> executedTests = tests(q.executed, q.notExecuted);
+    int watchWord = -1, watchBit = 0;
+    if (!q.watch.isEmpty()) {
+        auto it = characterLookup.find(q.watch);
+        if (it != characterLookup.end()) { watchWord = it->second / 64; watchBit = it->second % 64; }
+    }
+
+    // Characters counted when grouping by character: all of them, or Demons
+    std::vector<std::uint64_t> groupMask(words, 0);
+    for (std::size_t c = 0; c < characterIds.size(); ++c)
+        if (q.groupBy == ByCharacter || (q.groupBy == ByDemon && WinTracker::teamIndex(characterIds[c].team) == WinTracker::Demon))
+            groupMask[c / 64] |= std::uint64_t(1) << (c % 64);
+
+    const std::uint8_t lo = std::uint8_t(std::clamp(q.minPlayers, 0, 255));
+    const std::uint8_t hi = std::uint8_t(std::clamp(q.maxPlayers, 0, 255));
+    const std::size_t keys = q.groupBy == ByScript ? std::max<std::size_t>(1, scriptNames.size())
+                           : q.groupBy == ByPlayers || q.groupBy == ByDays ? 256
+                           : q.groupBy == ByWinner ? 3
+                           : q.groupBy == ByCharacter || q.groupBy == ByDemon ? std::max<std::size_t>(1, characterIds.size())
+                           : 1;
+
+    // ---- scan: one range of whole blocks per worker ----
+    struct Partial {
+        std::vector<Count> counts;
+        long matched = 0;
+    };
+    auto scan = [&, lo, hi](int begin, int end, Partial &out) {
+        out.counts.assign(keys, Count{});
+        std::uint8_t keep[BlockGames];
+        const std::size_t W = std::size_t(words);
+        for (int b = begin; b < end; b += BlockGames) {
+            const int m = std::min(BlockGames, end - b);
+            const std::uint8_t *pl = players.data() + b;
+            const std::uint8_t *win = winner.data() + b;
+            const std::uint8_t *dy = days.data() + b;
+            const std::uint8_t *dt = deathTotal.data() + b;
+            const std::uint16_t *sc = script.data() + b;
+
+            // ---- filters ----
+            for (int j = 0; j < m; ++j) keep[j] = std::uint8_t((pl[j] >= lo) & (pl[j] <= hi));
+            if (scriptKey >= 0)
+                for (int j = 0; j < m; ++j) keep[j] &= std::uint8_t(sc[j] == scriptKey);
+            if (q.winner >= 0)
+                for (int j = 0; j < m; ++j) keep[j] &= std::uint8_t(win[j] == q.winner);
+            for (const std::vector<WordTest> *list : {&playTests, &executedTests}) {
+                const std::uint64_t *column = (list == &playTests ? inPlay : executedSet).data() + std::size_t(b) * W;
+                for (const WordTest &t : *list) {
+                    const std::uint64_t *bits = column + t.word;
+                    for (int j = 0; j < m; ++j) {
+                        const std::uint64_t v = bits[j * W];
+                        keep[j] &= std::uint8_t(((v & t.all) == t.all) & ((v & t.none) == 0));
+                    }
+                }
+            }
+
+            // ---- aggregate ----
+            auto add = [&](Count &c, int j) {
+                const long k = keep[j];
+                c.games += k;
+                c.good += k & long(win[j] == Good);
+                c.evil += k & long(win[j] == Evil);
+                c.days += k * dy[j];
+                c.deaths += k * dt[j];
+                if (watchWord >= 0)
+                    c.watch += k & long((executedSet[(std::size_t(b) + j) * W + watchWord] >> watchBit) & 1);
+            };
+            for (int j = 0; j < m; ++j) out.matched += keep[j];
+            switch (q.groupBy) {
+            case None:       for (int j = 0; j < m; ++j) add(out.counts[0], j); break;
+            case ByScript:   for (int j = 0; j < m; ++j) add(out.counts[sc[j]], j); break;
+            case ByPlayers:  for (int j = 0; j < m; ++j) add(out.counts[pl[j]], j); break;
+            case ByWinner:   for (int j = 0; j < m; ++j) add(out.counts[win[j]], j); break;
+            case ByDays:     for (int j = 0; j < m; ++j) add(out.counts[dy[j]], j); break;
+            case ByCharacter:
+            case ByDemon:
+                for (int j = 0; j < m; ++j) {
+                    if (!keep[j]) continue;
+                    const std::uint64_t *bits = inPlay.data() + (std::size_t(b) + j) * W;
+                    for (std::size_t w = 0; w < W; ++w)
+                        for (std::uint64_t set = bits[w] & groupMask[w]; set; set &= set - 1)
+                            add(out.counts[w * 64 + qCountTrailingZeroBits(quint64(set))], j);
+                }
+                break;
+            }
+        }
+    };
+
+    const int blocks = (n + BlockGames - 1) / BlockGames;
+    int workers = q.threads > 0 ? q.threads : QThread::idealThreadCount();
+    workers = std::max(1, std::min(workers, blocks));
+    std::vector<Partial> partials(workers);
+    if (!impossible && n > 0) {
+        auto range = [&](int i) { return std::min(n, int(std::int64_t(blocks) * i / workers) * BlockGames); };
+        if (workers == 1) {
+            scan(0, n, partials[0]);
+        } else {
+            QThreadPool pool;
+            pool.setMaxThreadCount(workers);
+            for (int i = 0; i < workers; ++i) {
+                Partial *out = &partials[i];
+                const int begin = range(i), end = range(i + 1);
+                pool.start([&scan, out, begin, end]() { scan(begin, end, *out); });
+            }
+            pool.waitForDone();
+        }
+    }
+
+    // ---- merge ----
+    std::vector<Count> all(keys);
+    for (const Partial &p : partials) {
+        result.matched += p.matched;
+        for (std::size_t k = 0; k < p.counts.size(); ++k) all[k].merge(p.counts[k]);
+    }
+    auto row = [](const QString &label, const Count &c) {
+        Row r;
+        r.label = label;
+        r.games = c.games;
+        r.goodWins = c.good;
+        r.evilWins = c.evil;
+        r.unfinished = c.games - c.good - c.evil;
+        r.watchExecuted = c.watch;
+        r.averageDays = c.games ? double(c.days) / c.games : 0.0;
+        r.averageDeaths = c.games ? double(c.deaths) / c.games : 0.0;
+        return r;
+    };
+    static const char *winners[3] = {"Good", "Evil", "Unfinished"};
+    for (std::size_t k = 0; k < keys; ++k) {
+        if (q.groupBy != None && !all[k].games) continue;
+        switch (q.groupBy) {
+        case None:        result.rows.push_back(row("All games", all[k])); break;
+        case ByScript:    result.rows.push_back(row(scriptNames[k], all[k])); break;
+        case ByPlayers:   result.rows.push_back(row(QString("%1 players").arg(k), all[k])); break;
+        case ByWinner:    result.rows.push_back(row(winners[k], all[k])); break;
+        case ByDays:      result.rows.push_back(row(QString("%1 days").arg(k), all[k])); break;
+        case ByCharacter:
+        case ByDemon:     result.rows.push_back(row(characterIds[k].character, all[k])); break;
+        }
+    }
+    if (q.groupBy == ByCharacter || q.groupBy == ByDemon)
+        std::stable_sort(result.rows.begin(), result.rows.end(), [](const Row &a, const Row &b) { return a.games > b.games; });
+
+    result.elapsedUs = timer.nsecsElapsed() / 1000;
+    return result;
+}
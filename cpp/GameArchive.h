@@ -0,0 +1,137 @@
+#pragma once
+#include <QString>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "GameState.h"
+
+class QIODevice;
+
+// ---------- Game archive ----------
+// Finished games stored column by column, for questions over thousands or
+// millions of them ("the Imp's win rate at 8 players", "how often the Drunk
+// was never executed"). Each column is one flat array:
+//
+//   script      u16 per game    index into scripts()
+//   players     u8  per game
+//   winner      u8  per game    Winner
+//   days        u8  per game    days played
+//   seats       u16 per seat    index into characters(), seatStart[game]..
+//   deaths      u8  per day     dayStart[game]..
+//   executions  i8  per day     seat executed, -1 if none
+//
+// Queries never touch a game's seats or days one by one: on first use each
+// game gets a bitset of the characters in play and another of those
+// executed, and filters are tight loops over a block of games at a time
+// that the compiler vectorises, each and-ing into one mask. Blocks are
+// shared out over a thread pool.
+//
+// On disk an archive is a run of segments, each a small JSON header (the
+// segment's dictionaries and sizes) followed by its columns as raw
+// little-endian arrays. appendToFile() adds a segment without reading what
+// is there; save() writes everything back as one.
+class GameArchive {
+public:
+    enum Winner : std::uint8_t { Good, Evil, Unfinished };
+
+    struct Seat {
+        QString character;   // id
+        QString team;
+    };
+    struct Game {
+        QString script;
+        std::vector<Seat> seats;
+        std::vector<DayRecord> days;
+        Winner winner = Unfinished;
+    };
+    // The game as it stands, e.g. once the tracker has called it
+    static Game fromState(const GameState &state, Winner winner);
+
+    void append(const Game &game);
+    void append(const GameArchive &other);
+    void clear();
+
+    int games() const { return int(script.size()); }
+    const std::vector<QString> &scripts() const { return scriptNames; }
+    const std::vector<Seat> &characters() const { return characterIds; }
+    Game game(int index) const;
+
+    OpResult load(const QString &path);
+    OpResult save(const QString &path) const;
+    OpResult appendToFile(const QString &path) const;
+
+    // ---------- Queries ----------
+    enum GroupBy { None, ByScript, ByPlayers, ByWinner, ByDays, ByCharacter, ByDemon };
+
+    struct Query {
+        QString script;                    // empty: any
+        int minPlayers = 0;
+        int maxPlayers = 255;
+        int winner = -1;                   // Winner, -1: any
+        std::vector<QString> with;         // characters all in play
+        std::vector<QString> without;      // ... none in play
+        std::vector<QString> executed;     // characters all executed at some point
+        std::vector<QString> notExecuted;  // ... never executed
+        GroupBy groupBy = None;
+        QString watch;                     // counts games where this character was executed
+        int threads = 0;                   // 0 = one per core
+    };
+
+    struct Row {
+        QString label;
+        long games = 0;
+        long goodWins = 0;
+        long evilWins = 0;
+        long unfinished = 0;
+        long watchExecuted = 0;            // games where Query::watch was executed
+        double averageDays = 0.0;
+        double averageDeaths = 0.0;
+        double goodRate() const { return games ? double(goodWins) / games : 0.0; }
+    };
+
+    struct Result {
+        std::vector<Row> rows;             // by key; most played first for characters
+        long matched = 0;
+        long scanned = 0;
+        qint64 elapsedUs = 0;
+    };
+
+    // Characters or a script never archived match no game. The first query
+    // after a change builds the bitsets, so queries on one archive are not
+    // to be run from several threads at once.
+    Result query(const Query &query) const;
+    static GroupBy groupByFromString(const QString &name, bool *ok = nullptr);
+
+    static constexpr int BlockGames = 1024;
+    static constexpr std::uint16_t NoCharacter = 0xffff;   // a seat not dealt yet
+
+private:
+    int scriptIndex(const QString &name);
+    int characterIndex(const QString &id, const QString &team);
+    void buildIndex() const;
+    void writeSegment(QIODevice &out) const;
+
+    // ---- columns ----
+    std::vector<std::uint16_t> script;
+    std::vector<std::uint8_t> players;
+    std::vector<std::uint8_t> winner;
+    std::vector<std::uint8_t> days;
+    std::vector<std::uint32_t> seatStart{0};     // games + 1
+    std::vector<std::uint16_t> seats;
+    std::vector<std::uint32_t> dayStart{0};      // games + 1
+    std::vector<std::uint8_t> deaths;
+    std::vector<std::int8_t> executions;
+
+    // ---- dictionaries ----
+    std::vector<QString> scriptNames;
+    std::vector<Seat> characterIds;
+    std::unordered_map<QString, int> scriptLookup;
+    std::unordered_map<QString, int> characterLookup;
+
+    // ---- derived, rebuilt on the first query after a change ----
+    mutable int words = 0;                         // bitset words per game
+    mutable std::vector<std::uint64_t> inPlay;     // games x words
+    mutable std::vector<std::uint64_t> executedSet;
+    mutable std::vector<std::uint8_t> deathTotal;  // per game, capped at 255
+    mutable bool indexed = false;
+};
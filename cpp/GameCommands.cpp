@@ -0,0 +1,161 @@
+#include "GameCommands.h"
+#include <algorithm>
+
+using json = nlohmann::json;
+
+// A seat number or a player's name; -1 if neither
+static int seatOf(const GameState &state, const json &player) {
+    const int n = int(state.players.size());
+    if (player.is_number_integer()) {
+        int seat = player.get<int>();
+        return seat >= 0 && seat < n ? seat : -1;
+    }
+    if (!player.is_string()) return -1;
+    QString name = QString::fromStdString(player.get<std::string>());
+    for (int i = 0; i < n; ++i)
+        if (state.players[i].name == name) return i;
+    return -1;
+}
+
+json GameCommands::run(GameState &state, const json &message, bool &changed) {
+    changed = false;
+    json reply = json::object();
+    if (message.is_object() && message.contains("id")) reply["id"] = message["id"];
+    auto fail = [&reply](int index, const GameError &error) {
+        reply["ok"] = false;
+        if (index >= 0) reply["index"] = index;
+        reply["error"] = {{"title", error.title.toStdString()}, {"message", error.message.toStdString()}};
+        return reply;
+    };
+    if (!message.is_object()) return fail(-1, {"Bad Message", "Expected a JSON object."});
+
+    json single = json::array({message});
+    const json &commands = message.contains("batch") ? message["batch"] : single;
+    if (!commands.is_array()) return fail(-1, {"Bad Message", "\"batch\" must be an array of commands."});
+
+    // A single command fails before it changes anything, and queries change
+    // nothing, so only batches that change the game need a copy
+    bool readOnly = std::all_of(commands.begin(), commands.end(), [](const json &c) {
+        return c.is_object() && c.value("cmd", json()) == "state";
+    });
+    std::optional<GameState> draft;
+    if (!readOnly && commands.size() > 1) draft = state;
+    GameState &target = draft ? *draft : state;
+
+    json results = json::array();
+    bool dirty = false;
+    for (int i = 0; i < int(commands.size()); ++i) {
+        json result = json::object();
+        if (OpResult error = apply(target, commands[i], result, dirty)) return fail(i, *error);
+        results.push_back(std::move(result));
+    }
+
+    if (draft && dirty) {
+        // The draft's changes were not seen by the state's listeners
+        state = std::move(*draft);
+        state.notifyChanged({GameChange::Players});
+    }
+    changed = dirty;
+    reply["ok"] = true;
+    reply["results"] = std::move(results);
+    return reply;
+}
+
+OpResult GameCommands::apply(GameState &state, const json &command, json &result, bool &changed) {
+    if (!command.is_object()) return GameError{"Bad Command", "Each command must be a JSON object."};
+    try {
+        const std::string cmd = command.value("cmd", std::string());
+        auto text = [&command](const char *key) {
+            return QString::fromStdString(command.value(key, std::string()));
+        };
+        auto player = [&](const char *key) -> std::optional<int> {
+            int seat = command.contains(key) ? seatOf(state, command[key]) : -1;
+            if (seat < 0) return std::nullopt;
+            return seat;
+        };
+        auto noPlayer = [&](const char *key) {
+            return GameError{"Bad Command", QString("%1: no such player %2.")
+                .arg(QString::fromStdString(cmd), QString::fromStdString(command.value(key, json()).dump()))};
+        };
+
+        if (cmd == "state") {
+            result = describe(state);
+            return std::nullopt;
+        }
+        changed = true;
+        if (cmd == "addPlayer") {
+            if (command.contains("seat")) return state.insertPlayer(command["seat"].get<int>(), text("name"), text("character"));
+            return state.addPlayer(text("name"), text("character"));
+        }
+        if (cmd == "loadScript") return state.loadScript(text("path"));
+        if (cmd == "generateGame") return state.generateGame(command.value("players", 0));
+        if (cmd == "assignCharacters") return state.assignRandomCharacters();
+        if (cmd == "startNight") { state.startNight(); return std::nullopt; }
+        if (cmd == "endNight") { state.endNight(); return std::nullopt; }
+        if (cmd == "advanceDay") { state.advanceDay(); return std::nullopt; }
+
+        if (cmd == "seat") {
+            const json &names = command.value("order", json::array());
+            std::vector<int> order;
+            std::vector<char> taken(state.players.size(), 0);
+            for (const json &name : names) {
+                // Repeated names take the next player of that name
+                int seat = -1;
+                QString wanted = QString::fromStdString(name.get<std::string>());
+                for (int i = 0; i < int(state.players.size()) && seat < 0; ++i)
+                    if (!taken[i] && state.players[i].name == wanted) seat = i;
+                if (seat < 0) return GameError{"Seat Players", QString("No unseated player is called %1.").arg(wanted)};
+                taken[seat] = 1;
+                order.push_back(seat);
+            }
+            return state.seatPlayers(order);
+        }
+        if (cmd == "effect") {
+            std::optional<int> seat = player("player");
+            if (!seat) return noPlayer("player");
+            QString effect = text("effect");
+            if (effect.isEmpty()) return GameError{"Bad Command", "effect: no effect given."};
+            if (!command.value("on", true)) {
+                state.setEffect(*seat, effect, false);
+                return std::nullopt;
+            }
+            std::optional<int> source = player("source");
+            if (command.contains("source") && !source) return noPlayer("source");
+            state.applyEffect(*seat, effect, source.value_or(-1));
+            return std::nullopt;
+        }
+        if (cmd == "execute") {
+            std::optional<int> seat = player("player");
+            if (!seat) return noPlayer("player");
+            return state.execute(*seat);
+        }
+        if (cmd == "ghostVote") {
+            std::optional<int> seat = player("player");
+            if (!seat) return noPlayer("player");
+            return state.setGhostVote(*seat, command.value("available", false));
+        }
+        return GameError{"Bad Command", QString("Unknown command \"%1\".").arg(QString::fromStdString(cmd))};
+    } catch (const json::exception &e) {
+        return GameError{"Bad Command", QString::fromUtf8(e.what())};
+    }
+}
+
+json GameCommands::describe(const GameState &state) {
+    json players = json::array();
+    for (int i = 0; i < int(state.players.size()); ++i) {
+        const Player &p = state.players[i];
+        std::vector<std::string> effects;
+        for (auto &kv : p.effects)
+            if (kv.second) effects.push_back(kv.first.toStdString());
+        std::sort(effects.begin(), effects.end());
+        players.push_back({
+            {"seat", i}, {"name", p.name.toStdString()}, {"character", p.character.id.toStdString()},
+            {"team", p.team.toStdString()}, {"alive", state.isAlive(i)},
+            {"abilityActive", state.abilityActive(i)}, {"ghostVote", p.ghostVote}, {"effects", effects}
+        });
+    }
+    return {
+        {"day", state.day}, {"night", state.currentNight()}, {"isNight", state.isNight()}, {"firstNight", state.first_night},
+        {"script", state.scriptName().toStdString()}, {"players", std::move(players)}
+    };
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include "GameState.h"
+
+// ---------- Game commands ----------
+// Scripted control of a game, one JSON object per message (the automation
+// server reads them as NDJSON):
+//
+//   {"id": 1, "cmd": "addPlayer", "name": "Ada"}
+//   {"id": 2, "batch": [{"cmd": "addPlayer", "name": "Bo"}, {"cmd": "seat", "order": ["Bo", "Ada"]}]}
+//
+// A batch is one transaction: it runs against a copy of the game, which
+// replaces the game only if every command succeeded. Replies carry the id,
+// "ok", and either "results" (one per command) or the failing "index" and
+// "error". Commands:
+//   addPlayer    name, character (name, optional), seat (optional; the rest move clockwise)
+//   seat         order: every player's name, clockwise from seat 0
+//   loadScript   path
+//   generateGame players
+//   assignCharacters
+//   effect       player (name or seat), effect, on (default true), source (optional)
+//   execute      player
+//   ghostVote    player, available (default false: the vote is spent)
+//   startNight / endNight / advanceDay
+//   state        -> day, night, script and every player
+class GameCommands {
+public:
+    using json = nlohmann::json;
+
+    // `changed` is set when the game was replaced, i.e. needs redrawing
+    static json run(GameState &state, const json &message, bool &changed);
+
+private:
+    static OpResult apply(GameState &state, const json &command, json &result, bool &changed);
+    static json describe(const GameState &state);
+};
@@ -0,0 +1,559 @@
+#include "GameSimulator.h"
+#include "GameArchive.h"
+#include "SetupRules.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+
+// ---------- Per-thread state ----------
+struct GameSimulator::Worker {
+    explicit Worker(std::uint32_t seed) : rng(seed) {}
+
+    std::mt19937 rng;
+    // Everything a game allocates comes from the arena and is dropped in one
+    // go when the next game starts
+    std::vector<std::byte> buffer = std::vector<std::byte>(64 * 1024);
+    std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+    // Reused between games; they keep their capacity
+    AbilityRules::State state;
+    PhaseScheduler scheduler;
+    WinTracker tracker;
+    SeatRing ring;
+    std::vector<PhaseScheduler::Due> due;
+    // The last game, for Options::archive
+    std::vector<int> dealt;               // role per seat, as dealt
+    std::vector<DayRecord> dayLog;
+    GameArchive games;
+};
+
+namespace {
+struct Count {
+    int games = 0;
+    int good = 0;
+    int evil = 0;
+
+    void add(int outcome) {
+        ++games;
+        if (outcome == 0) ++good;
+        else if (outcome == 1) ++evil;
+    }
+    void merge(const Count &o) {
+        games += o.games;
+        good += o.good;
+        evil += o.evil;
+    }
+};
+
+template<typename Key>
+struct KeyHash {
+    std::size_t operator()(const Key &key) const {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        for (std::uint64_t word : key) h = (h ^ word) * 0x100000001b3ull;
+        return std::size_t(h ^ (h >> 29));
+    }
+};
+}
+
+struct GameSimulator::Totals {
+    Count all;
+    long days = 0;
+    std::vector<Count> byDemon;               // by role index
+    std::array<Count, 16> byPlayers{};
+    std::unordered_map<SetupKey, Count, KeyHash<SetupKey>> bySetup;
+};
+
+// ---------- Compiling the script ----------
+GameSimulator::GameSimulator(const GameState &state)
+    : scriptName(state.scriptName()), rules(state.abilityRules())
+{
+    static const char *teams[4] = {"townsfolk", "outsider", "minion", "demon"};
+    for (auto &kv : GameState::role_config) {
+        if (kv.first < 0 || kv.first >= int(distribution.size())) continue;
+        for (int t = 0; t < 4; ++t) {
+            auto it = kv.second.find(teams[t]);
+            distribution[kv.first][t] = it == kv.second.end() ? 0 : it->second;
+        }
+    }
+
+    for (const Character &c : state.scriptCharacters()) {
+        WinTracker::Team team = WinTracker::teamIndex(c.team);
+        if (team > WinTracker::Demon) continue;          // Travellers and Fabled are not dealt
+        if (int(roles.size()) >= MaxCharacters) {
+            setupError = QString("The script has more than %1 characters.").arg(MaxCharacters);
+            return;
+        }
+        Role r;
+        r.id = c.id;
+        r.name = c.name;
+        r.team = c.team;
+        r.teamIndex = team;
+        r.evil = team == WinTracker::Minion || team == WinTracker::Demon;
+        r.drunk = c.id == "drunk";
+        r.scarletWoman = c.id == "scarletwoman";
+        r.empath = c.id == "empath";
+        r.wakesFirst = !c.firstNightReminder.isEmpty();
+        r.wakes = !c.otherNightReminder.isEmpty();
+        r.firstOrder = c.first_night_order.value_or(1000);
+        r.otherOrder = c.other_night_order.value_or(1000);
+        r.firstAbility = rules.abilityFor(c.id, true);
+        r.otherAbility = rules.abilityFor(c.id, false);
+        r.ruleCharacter = rules.characterIndex(c.id);
+        r.outsiderDeltas = parseSetupModifier(c).outsiderDeltas;
+        for (auto &kv : c.reminderExpiry) {
+            int bit = rules.effectBit(kv.first);
+            if (bit < 0) continue;
+            int then = kv.second.then.isEmpty() ? -1 : rules.effectBit(kv.second.then);
+            r.expiries.push_back(Role::Expiry{bit, kv.second.at, kv.second.count, then});
+        }
+        pools[team].push_back(int(roles.size()));
+        roles.push_back(std::move(r));
+    }
+    if (pools[WinTracker::Demon].empty()) setupError = "The script has no Demon.";
+
+    demonRule = rules.abilityFor("imp", false);
+    survivesBit = rules.effectBit("Survives Execution");
+    cursedBit = rules.effectBit("Cursed");
+}
+
+// ---------- Running ----------
+GameSimulator::Report GameSimulator::run(const Options &options) const {
+    Report report;
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!setupError.isEmpty()) {
+        report.error = setupError;
+        return report;
+    }
+    const int lo = std::max(5, options.minPlayers);
+    const int hi = std::min(15, options.maxPlayers);
+    if (lo > hi) {
+        report.error = "Only 5–15 players supported.";
+        return report;
+    }
+    static const char *teams[4] = {"townsfolk", "outsider", "minion", "demon"};
+    for (int n = lo; n <= hi; ++n) {
+        for (int t = 0; t < 4; ++t) {
+            if (int(pools[t].size()) < distribution[n][t]) {
+                report.error = QString("Script does not have enough unique %1 characters").arg(teams[t]);
+                return report;
+            }
+        }
+    }
+
+    const int games = std::max(0, options.games);
+    int workers = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+    workers = std::max(1, std::min(workers, std::max(1, games)));
+    const std::uint32_t seed = options.seed ? options.seed : std::random_device{}();
+
+    std::vector<std::unique_ptr<Worker>> state;
+    std::vector<Totals> totals(workers);
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+    for (int i = 0; i < workers; ++i) {
+        int share = games / workers + (i < games % workers ? 1 : 0);
+        state.push_back(std::make_unique<Worker>(seed + std::uint32_t(i) * 0x9e3779b9u));
+        totals[i].byDemon.assign(roles.size(), Count{});
+        Worker *worker = state.back().get();
+        Totals *total = &totals[i];
+        pool.start([this, worker, total, share, &options]() { playGames(*worker, share, options, *total); });
+    }
+    pool.waitForDone();
+
+    // ---- merge ----
+    if (options.archive)
+        for (const auto &worker : state) options.archive->append(worker->games);
+    Totals all;
+    all.byDemon.assign(roles.size(), Count{});
+    for (const Totals &t : totals) {
+        all.all.merge(t.all);
+        all.days += t.days;
+        for (std::size_t r = 0; r < roles.size(); ++r) all.byDemon[r].merge(t.byDemon[r]);
+        for (std::size_t n = 0; n < t.byPlayers.size(); ++n) all.byPlayers[n].merge(t.byPlayers[n]);
+        for (auto &kv : t.bySetup) all.bySetup[kv.first].merge(kv.second);
+    }
+
+    auto tally = [](const QString &label, const Count &c) {
+        Tally t;
+        t.label = label;
+        t.games = c.games;
+        t.goodWins = c.good;
+        t.evilWins = c.evil;
+        return t;
+    };
+    auto mostPlayed = [](const Tally &a, const Tally &b) { return a.games > b.games; };
+
+    report.games = all.all.games;
+    report.goodWins = all.all.good;
+    report.evilWins = all.all.evil;
+    report.unfinished = report.games - report.goodWins - report.evilWins;
+    report.averageDays = report.games ? double(all.days) / report.games : 0.0;
+
+    for (std::size_t r = 0; r < roles.size(); ++r)
+        if (all.byDemon[r].games) report.byDemon.push_back(tally(roles[r].name, all.byDemon[r]));
+    std::stable_sort(report.byDemon.begin(), report.byDemon.end(), mostPlayed);
+
+    for (int n = lo; n <= hi; ++n)
+        if (all.byPlayers[n].games) report.byPlayers.push_back(tally(QString("%1 players").arg(n), all.byPlayers[n]));
+
+    // Only the most played setups get a label; there can be one per game
+    std::vector<std::pair<const SetupKey *, Count>> setups;
+    setups.reserve(all.bySetup.size());
+    for (auto &kv : all.bySetup) setups.emplace_back(&kv.first, kv.second);
+    std::size_t listed = std::min(setups.size(), std::size_t(std::max(0, options.topSetups)));
+    std::partial_sort(setups.begin(), setups.begin() + listed, setups.end(), [](const auto &a, const auto &b) {
+        return a.second.games != b.second.games ? a.second.games > b.second.games : *a.first < *b.first;
+    });
+    for (std::size_t i = 0; i < listed; ++i) {
+        QStringList names;
+        const SetupKey &key = *setups[i].first;
+        for (int word = 0; word < int(key.size()); ++word)
+            for (std::uint64_t bits = key[word]; bits; bits &= bits - 1)
+                names << roles[word * 64 + int(qCountTrailingZeroBits(quint64(bits)))].name;
+        report.bySetup.push_back(tally(names.join(", "), setups[i].second));
+    }
+
+    report.elapsedMs = timer.elapsed();
+    report.gamesPerSecond = report.elapsedMs > 0 ? report.games * 1000.0 / report.elapsedMs : 0.0;
+    return report;
+}
+
+void GameSimulator::playGames(Worker &worker, int games, const Options &options, Totals &totals) const {
+    std::uniform_int_distribution<int> players(std::max(5, options.minPlayers), std::min(15, options.maxPlayers));
+    for (int g = 0; g < games; ++g) {
+        SetupKey setup{};
+        int demon = 0, days = 0;
+        int n = players(worker.rng);
+        Outcome outcome = playGame(worker, n, options, setup, demon, days);
+        totals.all.add(outcome);
+        totals.days += days;
+        totals.byDemon[demon].add(outcome);
+        totals.byPlayers[n].add(outcome);
+        totals.bySetup[setup].add(outcome);
+
+        if (!options.archive) continue;
+        GameArchive::Game game;
+        game.script = scriptName;
+        for (int r : worker.dealt) game.seats.push_back({roles[r].id, roles[r].team});
+        game.days = worker.dayLog;
+        game.days.resize(days);                // days without a death leave no record
+        game.winner = outcome == GoodWon ? GameArchive::Good : outcome == EvilWon ? GameArchive::Evil : GameArchive::Unfinished;
+        worker.games.append(game);
+    }
+}
+
+// ---------- One game ----------
+GameSimulator::Outcome GameSimulator::playGame(Worker &w, int n, const Options &options,
+                                               SetupKey &setup, int &demon, int &days) const {
+    using Bits = std::uint64_t;
+    constexpr Bits Dead = Bits(1) << AbilityRules::DeadBit;
+    constexpr Bits Impaired = (Bits(1) << AbilityRules::PoisonedBit) | (Bits(1) << AbilityRules::DrunkBit);
+    const Heuristics &h = options.heuristics;
+    std::mt19937 &rng = w.rng;
+    std::pmr::memory_resource *arena = &w.arena;
+    w.arena.release();
+
+    auto below = [&rng](int count) { return std::uniform_int_distribution<int>(0, count - 1)(rng); };
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::normal_distribution<double> judgement(0.0, h.noise > 0 ? h.noise : 1e-9);
+
+    // ---- setup ----
+    std::pmr::vector<int> dealt(arena);
+    dealt.reserve(n);
+    auto draw = [&](const std::vector<int> &pool, int k) {
+        std::pmr::vector<int> left(pool.begin(), pool.end(), arena);
+        k = std::min(k, int(left.size()));
+        for (int i = 0; i < k; ++i) {
+            std::swap(left[i], left[i + below(int(left.size()) - i)]);
+            dealt.push_back(left[i]);
+        }
+    };
+    const std::array<int, 4> &dist = distribution[n];
+    draw(pools[WinTracker::Demon], dist[WinTracker::Demon]);
+    draw(pools[WinTracker::Minion], dist[WinTracker::Minion]);
+    int outsiders = dist[WinTracker::Outsider];
+    for (int r : dealt) {
+        const std::vector<int> &deltas = roles[r].outsiderDeltas;
+        if (!deltas.empty()) outsiders += deltas[below(int(deltas.size()))];
+    }
+    const int evilCount = int(dealt.size());
+    outsiders = std::clamp(outsiders, 0, std::min(int(pools[WinTracker::Outsider].size()), n - evilCount));
+    int townsfolk = n - evilCount - outsiders;
+    if (townsfolk > int(pools[WinTracker::Townsfolk].size())) {
+        townsfolk = int(pools[WinTracker::Townsfolk].size());
+        outsiders = n - evilCount - townsfolk;
+    }
+    draw(pools[WinTracker::Outsider], outsiders);
+    draw(pools[WinTracker::Townsfolk], townsfolk);
+    demon = dealt[0];
+    std::shuffle(dealt.begin(), dealt.end(), rng);
+
+    std::pmr::vector<int> role(dealt.begin(), dealt.end(), arena);   // per seat
+    w.dealt.assign(dealt.begin(), dealt.end());
+    w.dayLog.clear();
+    std::pmr::vector<char> inPlay(roles.size(), 0, arena);
+    for (int r : role) {
+        inPlay[r] = 1;
+        setup[r / 64] |= Bits(1) << (r % 64);
+    }
+
+    // ---- claims ----
+    std::pmr::vector<int> unused(arena);          // good characters not in play
+    for (int team : {WinTracker::Townsfolk, WinTracker::Outsider})
+        for (int r : pools[team]) if (!inPlay[r]) unused.push_back(r);
+    std::pmr::vector<int> bluffs(arena);
+    for (int i = 0; i < 3 && i < int(unused.size()); ++i) {
+        std::swap(unused[i], unused[i + below(int(unused.size()) - i)]);
+        bluffs.push_back(unused[i]);
+    }
+    std::pmr::vector<int> claim(role.begin(), role.end(), arena);
+    std::pmr::vector<double> suspicion(n, 0.0, arena);
+    for (int s = 0; s < n; ++s) {
+        const Role &r = roles[role[s]];
+        if (r.evil && !bluffs.empty()) claim[s] = bluffs[below(int(bluffs.size()))];
+        else if (r.drunk) {
+            for (int tries = 0; tries < 8 && !unused.empty(); ++tries) {
+                int c = unused[below(int(unused.size()))];
+                if (roles[c].teamIndex == WinTracker::Townsfolk) { claim[s] = c; break; }
+            }
+        }
+    }
+    for (int a = 0; a < n; ++a)
+        for (int b = a + 1; b < n; ++b)
+            if (claim[a] == claim[b]) {
+                suspicion[a] += h.doubleClaimWeight;
+                suspicion[b] += h.doubleClaimWeight;
+            }
+
+    // ---- grimoire ----
+    AbilityRules::State &st = w.state;
+    st.resize(n);
+    w.scheduler.clear();
+    w.tracker.clear();
+    w.ring.reset(n);
+    std::pmr::vector<char> evil(n, 0, arena);
+    for (int s = 0; s < n; ++s) {
+        const Role &r = roles[role[s]];
+        evil[s] = r.evil;
+        st.character[s] = r.ruleCharacter;
+        st.team[s] = std::uint8_t(r.teamIndex);
+        if (r.drunk) st.effects[s] |= Bits(1) << AbilityRules::DrunkBit;   // never wears off
+        w.tracker.addSeat(r.id, r.team, true, r.drunk);
+    }
+
+    std::pmr::vector<int> firstOrder(arena), otherOrder(arena);
+    for (int s = 0; s < n; ++s) {
+        if (roles[role[s]].firstAbility >= 0) firstOrder.push_back(s);
+        otherOrder.push_back(s);
+    }
+    std::stable_sort(firstOrder.begin(), firstOrder.end(), [&](int a, int b) { return roles[role[a]].firstOrder < roles[role[b]].firstOrder; });
+    std::stable_sort(otherOrder.begin(), otherOrder.end(), [&](int a, int b) { return roles[role[a]].otherOrder < roles[role[b]].otherOrder; });
+
+    auto alive = [&](int s) { return w.ring.isAlive(s); };
+    auto died = [&](int s, bool executed) {
+        if (int(w.dayLog.size()) < days) w.dayLog.resize(days);
+        ++w.dayLog[days - 1].deaths;
+        if (executed) w.dayLog[days - 1].executed = s;
+    };
+    auto kill = [&](int s, bool executed) {
+        died(s, executed);
+        st.effects[s] |= Dead;
+        w.ring.setAlive(s, false);
+        w.tracker.setAlive(s, false, executed);
+    };
+    // The game is over once the tracker calls it; a Scarlet Woman takes over
+    auto verdict = [&]() -> int {
+        if (!w.tracker.hasAlerts()) return -1;
+        for (const GameAlert &a : w.tracker.takeAlerts()) {
+            if (a.kind == GameAlert::GoodWins) return GoodWon;
+            if (a.kind == GameAlert::EvilWins) return EvilWon;
+            if (a.kind != GameAlert::ScarletWoman || a.seat < 0) continue;
+            for (int s = 0; s < n; ++s) {
+                if (!alive(s) || !roles[role[s]].scarletWoman || (st.effects[s] & Impaired)) continue;
+                role[s] = role[a.seat];
+                st.character[s] = roles[role[s]].ruleCharacter;
+                st.team[s] = std::uint8_t(WinTracker::Demon);
+                w.tracker.setCharacter(s, roles[role[s]].id, roles[role[s]].team);
+                break;
+            }
+        }
+        return -1;
+    };
+    auto boundary = [&](PhaseScheduler::Boundary at) {
+        if (at == PhaseScheduler::Dawn) AbilityRules::dawn(st);
+        else AbilityRules::dusk(st);
+        if (!w.scheduler.advance(at, w.due)) return;
+        for (const PhaseScheduler::Due &d : w.due) {
+            Bits bit = Bits(1) << d.effect;
+            if (!(st.effects[d.seat] & bit)) continue;
+            st.effects[d.seat] &= ~bit;
+            if (d.then == AbilityRules::DeadBit) {
+                if (alive(d.seat)) kill(d.seat, false);
+            } else if (d.then >= 0) {
+                st.effects[d.seat] |= Bits(1) << d.then;
+            }
+        }
+    };
+
+    // Evil players go for whoever looks most useful to good: a night waker
+    // the town does not suspect
+    auto evilTarget = [&](int actor) {
+        int best = -1;
+        double bestScore = -1e9;
+        for (int s = 0; s < n; ++s) {
+            if (s == actor || evil[s] || !alive(s)) continue;
+            double score = (roles[claim[s]].wakes ? 2.0 : 0.0) - suspicion[s] + unit(rng);
+            if (score > bestScore) { bestScore = score; best = s; }
+        }
+        return best;
+    };
+    auto anyOther = [&](int actor, int except) {
+        std::uint64_t pool = w.ring.aliveMask();
+        for (int s : {actor, except}) if (s >= 0) pool &= ~(std::uint64_t(1) << s);
+        if (!pool) return -1;
+        for (int pick = below(int(qPopulationCount(quint64(pool)))); pick > 0; --pick) pool &= pool - 1;
+        return int(qCountTrailingZeroBits(quint64(pool)));
+    };
+
+    std::pmr::vector<char> ghostVote(n, 1, arena);
+    std::pmr::vector<char> nominated(n, 0, arena);
+    std::pmr::vector<int> speakers(arena);
+
+    for (days = 1; days <= options.maxDays; ++days) {
+        const bool first = days == 1;
+
+        // ---- night ----
+        for (int actor : first ? firstOrder : otherOrder) {
+            if (!alive(actor)) continue;
+            const Role &r = roles[role[actor]];
+            int ability = first ? r.firstAbility : r.otherAbility;
+            if (ability < 0 && !first && r.teamIndex == WinTracker::Demon) ability = demonRule;
+            if (ability < 0) continue;
+
+            const int wanted = rules.ability(ability).targets;
+            int target = -1, second = -1;
+            if (wanted >= 1) target = evil[actor] ? evilTarget(actor) : anyOther(actor, -1);
+            if (wanted >= 1 && target < 0) target = anyOther(actor, -1);   // only evil left: the Demon eats its own
+            if (wanted >= 2) second = anyOther(actor, target);
+            const int seats[3] = {actor, target, second};
+            Bits before[3];
+            for (int i = 0; i < 3; ++i) before[i] = seats[i] >= 0 ? st.effects[seats[i]] : 0;
+            if (!rules.run(ability, st, actor, target, second)) continue;
+
+            for (int i = 0; i < 3; ++i) {
+                int s = seats[i];
+                if (s < 0) continue;
+                Bits gained = st.effects[s] & ~before[i];
+                if (gained & Dead) {
+                    died(s, false);
+                    w.tracker.setAlive(s, false);
+                }
+                w.ring.setAlive(s, !(st.effects[s] & Dead));
+                // Effects the rule left open may still end by the character data, e.g. the Pukka's
+                for (const Role::Expiry &e : r.expiries) {
+                    Bits bit = Bits(1) << e.bit;
+                    if ((gained & bit) && !((st.untilDusk[s] | st.untilDawn[s]) & bit))
+                        w.scheduler.schedule(s, e.bit, w.scheduler.tickFor(e.at, e.count), e.then);
+                }
+            }
+        }
+        if (int v = verdict(); v >= 0) return Outcome(v);
+
+        // Sober good players who woke learn something, true or not
+        for (int s = 0; s < n; ++s) {
+            const Role &r = roles[role[s]];
+            if (evil[s] || !alive(s) || !(first ? r.wakesFirst : r.wakes)) continue;
+            const bool sober = !(st.effects[s] & Impaired);
+            if (sober && r.empath) {
+                // Evil neighbours look worse, good ones are cleared a little
+                auto read = [&](int seen) { suspicion[seen] += evil[seen] ? h.infoWeight : -0.5 * h.infoWeight; };
+                int left = w.ring.neighbour(s, false), right = w.ring.neighbour(s, true);
+                if (left >= 0) read(left);
+                if (right >= 0 && right != left) read(right);
+                continue;
+            }
+            int pointed = -1;
+            if (sober && unit(rng) < h.infoReliability) {
+                int count = 0;
+                for (int e = 0; e < n; ++e) count += evil[e];
+                int pick = count ? below(count) : -1;
+                for (int e = 0; e < n && pick >= 0; ++e)
+                    if (evil[e] && pick-- == 0) pointed = e;
+            } else {
+                int count = 0;
+                for (int g = 0; g < n; ++g) count += !evil[g] && g != s;
+                int pick = count ? below(count) : -1;
+                for (int g = 0; g < n && pick >= 0; ++g)
+                    if (!evil[g] && g != s && pick-- == 0) pointed = g;
+            }
+            if (pointed >= 0) suspicion[pointed] += h.infoWeight;
+        }
+        boundary(PhaseScheduler::Dawn);
+        if (int v = verdict(); v >= 0) return Outcome(v);
+
+        // ---- day ----
+        for (int s = 0; s < n; ++s) {
+            if (!evil[s] || !alive(s)) continue;
+            int framed = evilTarget(s);
+            if (framed >= 0) suspicion[framed] += h.evilSway;
+        }
+
+        speakers.clear();
+        const int living = w.ring.aliveCount();
+        for (int s = 0; s < n; ++s)
+            if (alive(s)) speakers.push_back(s);
+        std::shuffle(speakers.begin(), speakers.end(), rng);
+        std::fill(nominated.begin(), nominated.end(), 0);
+
+        int block = -1, blockVotes = 0;
+        bool tied = false;
+        int nominations = 0;
+        for (int nominator : speakers) {
+            if (nominations >= h.maxNominations) break;
+            if (!alive(nominator)) continue;                   // a Witch's curse may have struck
+            int nominee = -1;
+            double most = evil[nominator] ? h.nominateThreshold * 0.5 : h.nominateThreshold;
+            for (int s = 0; s < n; ++s) {
+                if (s == nominator || nominated[s] || !alive(s) || (evil[nominator] && evil[s])) continue;
+                if (suspicion[s] >= most) { most = suspicion[s]; nominee = s; }
+            }
+            if (nominee < 0) continue;
+            nominated[nominee] = 1;
+            ++nominations;
+            if (cursedBit >= 0 && (st.effects[nominator] & (Bits(1) << cursedBit))) {
+                kill(nominator, false);
+                if (int v = verdict(); v >= 0) return Outcome(v);
+                continue;
+            }
+
+            int votes = 0;
+            for (int v = 0; v < n; ++v) {
+                bool yes;
+                if (evil[v]) yes = !evil[nominee];
+                else yes = v != nominee && suspicion[nominee] + judgement(rng) > h.voteThreshold + (alive(v) ? 0.0 : 0.5);
+                if (!yes) continue;
+                if (alive(v)) ++votes;
+                else if (ghostVote[v]) { ghostVote[v] = 0; ++votes; }
+            }
+            if (2 * votes < living || votes < blockVotes) continue;
+            if (votes == blockVotes) tied = true;
+            else { block = nominee; blockVotes = votes; tied = false; }
+        }
+
+        const bool survives = block >= 0 && survivesBit >= 0 && (st.effects[block] & (Bits(1) << survivesBit));
+        if (block >= 0 && !tied && !survives) kill(block, true);
+        w.tracker.endDay();
+        if (int v = verdict(); v >= 0) return Outcome(v);
+
+        boundary(PhaseScheduler::Dusk);
+        if (int v = verdict(); v >= 0) return Outcome(v);
+    }
+    days = options.maxDays;
+    return Unfinished;
+}
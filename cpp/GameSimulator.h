@@ -0,0 +1,132 @@
+#pragma once
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "GameState.h"
+#include "PhaseScheduler.h"
+#include "WinTracker.h"
+
+class GameArchive;
+
+// ---------- Game simulator ----------
+// Plays whole games between bots to see whether a script leans good or
+// evil. Setups are drawn like GameState::generateGame (including Outsider
+// modifiers), nights run the compiled ability rules with reminder expiry
+// from the character data, and WinTracker decides when a game is over.
+//
+// The bots are deliberately simple, with the knobs in Heuristics:
+//  - good players claim their character (the Drunk a Townsfolk not in
+//    play), evil players claim one of three bluffs; a double claim is
+//    suspicious
+//  - a sober good player who wakes at night gets a read that points at an
+//    evil player with probability infoReliability, at a good one otherwise;
+//    a sober Empath reads its actual living neighbours off the SeatRing
+//  - evil players vote for good nominees only and push suspicion on good
+//    players who wake at night; the Demon kills them first
+//  - anyone nominates the player they suspect most past a threshold, and
+//    votes on suspicion plus noise
+//
+// Games run on a thread pool. Each worker keeps its per-game state in a
+// thread-local arena that is reset between games rather than allocating
+// and freeing it game after game. With Options::archive, each worker also
+// archives its games, and the archives are appended in worker order.
+class GameSimulator {
+public:
+    struct Heuristics {
+        double infoReliability = 0.7;     // a sober read points at an evil player
+        double infoWeight = 1.0;          // suspicion a read adds
+        double doubleClaimWeight = 1.5;   // suspicion on both players of a double claim
+        double evilSway = 0.4;            // suspicion evil pushes on good players each day
+        double nominateThreshold = 1.0;   // suspicion needed to nominate
+        double voteThreshold = 0.8;       // ... to vote for a nominee
+        double noise = 0.5;               // spread of each voter's own judgement
+        int maxNominations = 3;           // per day
+    };
+
+    struct Options {
+        int games = 10000;
+        int minPlayers = 5;
+        int maxPlayers = 15;
+        int threads = 0;                  // 0 = one per core
+        std::uint32_t seed = 0;           // 0 = random
+        int maxDays = 20;                 // games still running after this count as unfinished
+        int topSetups = 50;               // setups listed in the report
+        Heuristics heuristics;
+        GameArchive *archive = nullptr;   // if set, every game played is appended to it
+    };
+
+    struct Tally {
+        QString label;
+        int games = 0;
+        int goodWins = 0;
+        int evilWins = 0;
+        double goodRate() const { return games ? double(goodWins) / games : 0.0; }
+    };
+
+    struct Report {
+        int games = 0;
+        int goodWins = 0;
+        int evilWins = 0;
+        int unfinished = 0;
+        double averageDays = 0.0;
+        std::vector<Tally> byDemon;       // most played first
+        std::vector<Tally> byPlayers;     // by player count
+        std::vector<Tally> bySetup;       // most played first, Options::topSetups of them
+        qint64 elapsedMs = 0;
+        double gamesPerSecond = 0.0;
+        QString error;
+    };
+
+    // Takes the character data, script and rules of `state`; the state is
+    // not used after construction
+    explicit GameSimulator(const GameState &state);
+
+    Report run(const Options &options) const;
+    QString error() const { return setupError; }
+
+    static constexpr int MaxCharacters = 256;   // per script
+
+private:
+    // Script characters, compiled once
+    struct Role {
+        QString id;
+        QString name;
+        QString team;
+        WinTracker::Team teamIndex = WinTracker::Other;
+        bool evil = false;
+        bool drunk = false;               // the Drunk
+        bool scarletWoman = false;
+        bool empath = false;              // reads its living neighbours
+        bool wakesFirst = false;          // has a first-night reminder
+        bool wakes = false;               // ... an other-night one
+        int firstOrder = 1000;
+        int otherOrder = 1000;
+        int firstAbility = -1;            // AbilityRules index
+        int otherAbility = -1;
+        std::uint16_t ruleCharacter = AbilityRules::NoCharacter;
+        std::vector<int> outsiderDeltas;  // setup modifier
+        struct Expiry { int bit; PhaseScheduler::Boundary at; int count; int then; };
+        std::vector<Expiry> expiries;     // untimed rule effects the character data ends
+    };
+
+    enum Outcome { GoodWon, EvilWon, Unfinished };
+    using SetupKey = std::array<std::uint64_t, MaxCharacters / 64>;
+    struct Worker;
+    struct Totals;
+
+    void playGames(Worker &worker, int games, const Options &options, Totals &totals) const;
+    Outcome playGame(Worker &worker, int players, const Options &options,
+                     SetupKey &setup, int &demon, int &days) const;
+
+    QString scriptName;
+    std::vector<Role> roles;
+    std::array<std::vector<int>, WinTracker::TeamCount> pools;   // role indices by team
+    std::array<std::array<int, 4>, 16> distribution{};           // [players][team] from GameState::role_config
+    AbilityRules rules;
+    int demonRule = -1;                   // kill rule for Demons the rules do not cover
+    int survivesBit = -1;
+    int cursedBit = -1;
+    QString setupError;
+};
@@ -0,0 +1,644 @@
+#include "GameState.h"
+#include "BluffOptimiser.h"
+#include <QFileInfo>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// ---------- Static config ----------
+const std::unordered_map<int, std::unordered_map<QString,int>> GameState::role_config = {
+    {5,  {{"townsfolk",3},{"outsider",0},{"minion",1},{"demon",1}}},
+    {6,  {{"townsfolk",3},{"outsider",1},{"minion",1},{"demon",1}}},
+    {7,  {{"townsfolk",5},{"outsider",0},{"minion",1},{"demon",1}}},
+    {8,  {{"townsfolk",5},{"outsider",1},{"minion",1},{"demon",1}}},
+    {9,  {{"townsfolk",5},{"outsider",2},{"minion",1},{"demon",1}}},
+    {10, {{"townsfolk",7},{"outsider",0},{"minion",2},{"demon",1}}},
+    {11, {{"townsfolk",7},{"outsider",1},{"minion",2},{"demon",1}}},
+    {12, {{"townsfolk",7},{"outsider",2},{"minion",2},{"demon",1}}},
+    {13, {{"townsfolk",9},{"outsider",0},{"minion",3},{"demon",1}}},
+    {14, {{"townsfolk",9},{"outsider",1},{"minion",3},{"demon",1}}},
+    {15, {{"townsfolk",9},{"outsider",2},{"minion",3},{"demon",1}}}
+};
+
+const std::vector<QString> GameState::all_teams = {"townsfolk","demon","minion","outsider","evil townsfolk"};
+
+// Shared by every game that has not loaded anything yet
+static const std::shared_ptr<const CharacterDB> &emptyCharacterDB() {
+    static const std::shared_ptr<const CharacterDB> empty = std::make_shared<const CharacterDB>();
+    return empty;
+}
+
+static const std::shared_ptr<const Script> &emptyScript() {
+    static const std::shared_ptr<const Script> empty = std::make_shared<const Script>();
+    return empty;
+}
+
+GameState::GameState()
+    : db(emptyCharacterDB()),
+      script(emptyScript()),
+      rng(std::random_device{}())
+{
+}
+
+// ---------- Random helpers ----------
+template<typename T>
+std::vector<T> GameState::sample(const std::vector<T> &data, size_t k) {
+    std::vector<T> pool = data;
+    if (k >= pool.size()) return pool;
+    std::shuffle(pool.begin(), pool.end(), rng);
+    pool.resize(k);
+    return pool;
+}
+
+// ---------- Loading ----------
+OpResult GameState::loadCharacterDB(const QString &path) {
+    QString file = QFileInfo(path).fileName();
+    std::ifstream f(path.toStdString());
+    if (!f) return GameError{"Error", QString("Cannot open %1.").arg(file)};
+
+    json j;
+    try { f >> j; }
+    catch(...) { return GameError{"Error", QString("Invalid JSON in %1.").arg(file)}; }
+
+    auto loaded = std::make_shared<CharacterDB>();
+    for (auto &it : j) {
+        Character c;
+        c.id = QString::fromStdString(it.value("id",""));
+        c.name = QString::fromStdString(it.value("name",""));
+        c.team = QString::fromStdString(it.value("team",""));
+        c.ability = QString::fromStdString(it.value("ability",""));
+
+        // Null night orders mean no night action
+        if (it.contains("first_night_order") && !it["first_night_order"].is_null())
+            c.first_night_order = it["first_night_order"].get<int>();
+        else
+            c.first_night_order = std::nullopt;
+
+        if (it.contains("other_night_order") && !it["other_night_order"].is_null())
+            c.other_night_order = it["other_night_order"].get<int>();
+        else
+            c.other_night_order = std::nullopt;
+
+        c.firstNightReminder = QString::fromStdString(it.value("firstNightReminder",""));
+        c.otherNightReminder = QString::fromStdString(it.value("otherNightReminder",""));
+        if (it.contains("reminders")) {
+            for (auto &r : it["reminders"])
+                c.reminders.push_back(QString::fromStdString(r));
+        }
+
+        // "reminderExpiry": {"Safe": "dawn", "Poisoned": {"at": "dawn", "count": 2, "then": "Dead"}}
+        if (it.contains("reminderExpiry") && it["reminderExpiry"].is_object()) {
+            for (auto &e : it["reminderExpiry"].items()) {
+                const json &v = e.value();
+                PhaseScheduler::Expiry expiry;
+                std::string at = v.is_string() ? v.get<std::string>() : v.value("at", "dusk");
+                expiry.at = at == "dawn" ? PhaseScheduler::Dawn : PhaseScheduler::Dusk;
+                if (v.is_object()) {
+                    expiry.count = v.value("count", 1);
+                    expiry.then = QString::fromStdString(v.value("then", ""));
+                }
+                c.reminderExpiry[QString::fromStdString(e.key())] = expiry;
+            }
+        }
+
+        loaded->characters[c.id] = c;
+    }
+
+    // Ability rules live next to the database, e.g. Master_BotC.rules
+    QFileInfo info(path);
+    QString rulesPath = info.path() + "/" + info.completeBaseName() + ".rules";
+    if (QFileInfo::exists(rulesPath)) {
+        if (auto err = loaded->rules.load(rulesPath)) {
+            loaded->rules.clear();
+            db = std::move(loaded);   // the characters are still good
+            return GameError{"Ability Rules", QString("%1: %2").arg(QFileInfo(rulesPath).fileName(), *err)};
+        }
+    }
+    db = std::move(loaded);
+    return std::nullopt;
+}
+
+OpResult GameState::loadScript(const QString &path) {
+    std::ifstream f(path.toStdString());
+    if (!f) return GameError{"Error", "Cannot open script file."};
+
+    json j;
+    try { f >> j; } catch(...) { return GameError{"Error", "Invalid script JSON."}; }
+
+    auto loaded = std::make_shared<Script>();
+    loaded->name = QFileInfo(path).completeBaseName();
+    std::vector<QString> &reminders = loaded->reminders;
+    for (auto &entry : j) {
+        QString id = QString::fromStdString(entry.value("id",""));
+        auto it = db->characters.find(id);
+        if (it != db->characters.end()) {
+            const Character &c = it->second;
+            loaded->characters.push_back(c);
+            for (auto &r : c.reminders) if (std::find(reminders.begin(), reminders.end(), r) == reminders.end()) reminders.push_back(r);
+        }
+    }
+
+    std::sort(reminders.begin(), reminders.end());
+    setScript(std::move(loaded));
+    return std::nullopt;
+}
+
+void GameState::setScript(std::shared_ptr<const Script> value) {
+    script = value ? std::move(value) : emptyScript();
+    init_effects.clear();
+    for (auto &r : script->reminders) init_effects[r] = false;
+}
+
+void GameState::shareData(const GameState &other) {
+    db = other.db;
+    setScript(other.script);
+}
+
+// ---------- Players ----------
+std::vector<Character> GameState::availableCharacters(bool includeAssigned) const {
+    if (includeAssigned) return scriptCharacters();
+
+    std::unordered_set<QString> assigned;
+    for (auto &p : players) assigned.insert(p.character.id);
+    std::vector<Character> available;
+    for (auto &c : scriptCharacters()) if (!assigned.count(c.id)) available.push_back(c);
+    return available;
+}
+
+OpResult GameState::addPlayer(const QString &name, const QString &characterName) {
+    return insertPlayer(int(players.size()), name, characterName);
+}
+
+OpResult GameState::insertPlayer(int seat, const QString &name, const QString &characterName) {
+    if (seat < 0 || seat > int(players.size())) return GameError{"Add Player", "No such seat."};
+    if (name.isEmpty()) return GameError{"Add Player", "Player name is empty."};
+    if (int(players.size()) >= SeatRing::MaxSeats)
+        return GameError{"Add Player", QString("The grimoire seats at most %1 players.").arg(SeatRing::MaxSeats)};
+
+    Player p;
+    p.name = name;
+    if (!characterName.isEmpty()) {
+        auto it = std::find_if(scriptCharacters().begin(), scriptCharacters().end(), [&](const Character &c){ return c.name == characterName; });
+        if (it == scriptCharacters().end()) return GameError{"Add Player", QString("%1 is not on the script.").arg(characterName)};
+        p.character = *it;
+        p.team = it->team;
+    }
+    p.effects = init_effects;
+    std::vector<int> newSeat(players.size());
+    for (int i = 0; i < int(newSeat.size()); ++i) newSeat[i] = i < seat ? i : i + 1;
+    players.insert(players.begin() + seat, std::move(p));
+    remapSeats(newSeat);
+    return std::nullopt;
+}
+
+OpResult GameState::editPlayer(int seat, const QString &name, const QString &characterName) {
+    if (seat < 0 || seat >= int(players.size())) return GameError{"Edit Player", "No such seat."};
+    if (name.isEmpty()) return GameError{"Edit Player", "Player name is empty."};
+    auto it = std::find_if(scriptCharacters().begin(), scriptCharacters().end(), [&](const Character &c){ return c.name == characterName; });
+    if (it == scriptCharacters().end()) return GameError{"Edit Player", QString("%1 is not on the script.").arg(characterName)};
+
+    players[seat].name = name;
+    players[seat].character = *it;
+    players[seat].team = it->team;
+    tracker.setCharacter(seat, it->id, it->team);
+    updateImpaired(graph.setInnate(seat, innatelyImpaired(seat)));
+    seatChanged(seat);
+    return std::nullopt;
+}
+
+void GameState::setCharacter(int seat, const QString &characterId) {
+    if (seat < 0 || seat >= int(players.size())) return;
+    auto it = characterDB().find(characterId);
+    Player &p = players[seat];
+    p.character = it != characterDB().end() ? it->second : Character{};
+    p.character.id = characterId;
+    p.team = p.character.team;
+    tracker.setCharacter(seat, characterId, p.team);
+    updateImpaired(graph.setInnate(seat, innatelyImpaired(seat)));
+    seatChanged(seat);
+}
+
+OpResult GameState::seatPlayers(const std::vector<int> &order) {
+    const int n = int(players.size());
+    GameError mismatch{"Seat Players", "The seating order must list every seat once."};
+    if (int(order.size()) != n) return mismatch;
+    std::vector<int> newSeat(n, -1);
+    for (int i = 0; i < n; ++i) {
+        if (order[i] < 0 || order[i] >= n || newSeat[order[i]] >= 0) return mismatch;
+        newSeat[order[i]] = i;
+    }
+
+    std::vector<Player> seated;
+    seated.reserve(n);
+    for (int from : order) seated.push_back(std::move(players[from]));
+    players = std::move(seated);
+    remapSeats(newSeat);
+    return std::nullopt;
+}
+
+void GameState::remapSeats(const std::vector<int> &newSeat) {
+    const int n = int(newSeat.size());
+    const int seats = int(players.size());
+    auto moved = [&](int seat) { return seat >= 0 && seat < n ? newSeat[seat] : seat; };
+    for (InfoRecord &r : info_log) {
+        r.seat = moved(r.seat);
+        for (int &s : r.seats) s = moved(s);
+    }
+    for (DayRecord &d : day_log) d.executed = moved(d.executed);
+
+    scheduler.remap(newSeat);
+    ring.remap(newSeat, seats);
+    tracker.remap(newSeat, seats);
+    updateImpaired(graph.remap(newSeat, seats));
+
+    // Seats nobody moved to hold someone new
+    std::vector<char> kept(seats, 0);
+    for (int to : newSeat)
+        if (to >= 0 && to < seats) kept[to] = 1;
+    for (int i = 0; i < seats; ++i) {
+        if (kept[i]) continue;
+        ring.setAlive(i, isAlive(i));
+        graph.setAlive(i, isAlive(i));
+        updateImpaired(graph.setInnate(i, innatelyImpaired(i)));
+        updateImpaired(graph.setUnsourced(i, AbilityGraph::Poisoned, hasEffect(i, "Poisoned")));
+        updateImpaired(graph.setUnsourced(i, AbilityGraph::Drunk, hasEffect(i, "Drunk")));
+        tracker.placeSeat(i, players[i].character.id, players[i].team, isAlive(i), isImpaired(i));
+    }
+    notifyChanged({GameChange::Players});
+}
+
+bool GameState::hasEffect(int seat, const QString &effect) const {
+    auto &effects = players[seat].effects;
+    auto it = effects.find(effect);
+    return it != effects.end() && it->second;
+}
+
+// Impaired whoever applies what: the Drunk, and the old per-player flags
+bool GameState::innatelyImpaired(int seat) const {
+    const Player &p = players[seat];
+    return p.character.id == "drunk" || p.poisoned || p.drunk;
+}
+
+void GameState::setEffect(int seat, const QString &effect, bool on) {
+    setEffectFrom(seat, effect, on, -1);
+}
+
+// Poisoned / Drunk from a seat become graph edges, so they lapse when the
+// source dies or turns out to have been impaired itself
+void GameState::setEffectFrom(int seat, const QString &effect, bool on, int sourceSeat) {
+    const bool wasAlive = effect == "Dead" && isAlive(seat);
+    players[seat].effects[effect] = on;
+    if (!on) scheduler.cancel(seat, effect);
+    if (effect == "Dead") {
+        // A revival the same day undoes the death, e.g. a misclick
+        if (wasAlive && !isAlive(seat)) ++today().deaths;
+        else if (!wasAlive && isAlive(seat) && today().deaths > 0) {
+            --today().deaths;
+            if (today().executed == seat) today().executed = -1;
+        }
+        tracker.setAlive(seat, isAlive(seat));
+        ring.setAlive(seat, isAlive(seat));
+        updateImpaired(graph.setAlive(seat, isAlive(seat)));
+        seatChanged(seat);
+    } else if (effect == "Poisoned" || effect == "Drunk") {
+        AbilityGraph::Effect e = effect == "Poisoned" ? AbilityGraph::Poisoned : AbilityGraph::Drunk;
+        if (!on) updateImpaired(graph.clearEffect(seat, e));
+        else if (sourceSeat >= 0 && sourceSeat < int(players.size())) updateImpaired(graph.addEdge(sourceSeat, seat, e));
+        else updateImpaired(graph.setUnsourced(seat, e, true));
+    }
+    if (effect != "Dead") notifyChanged({GameChange::Effect, seat});
+}
+
+void GameState::updateImpaired(const std::vector<int> &seats) {
+    for (int seat : seats) tracker.setImpaired(seat, isImpaired(seat));
+}
+
+const PhaseScheduler::Expiry *GameState::expiryFor(const QString &effect, int sourceSeat) const {
+    if (sourceSeat >= 0 && sourceSeat < int(players.size())) {
+        auto &table = players[sourceSeat].character.reminderExpiry;
+        auto it = table.find(effect);
+        return it == table.end() ? nullptr : &it->second;
+    }
+    const PhaseScheduler::Expiry *found = nullptr;
+    QString foundId;
+    for (auto &p : players) {
+        auto it = p.character.reminderExpiry.find(effect);
+        if (it == p.character.reminderExpiry.end() || p.character.id == foundId) continue;
+        if (found) return nullptr;   // ambiguous, e.g. Poisoner and Pukka: leave it to the Storyteller
+        found = &it->second;
+        foundId = p.character.id;
+    }
+    return found;
+}
+
+void GameState::applyEffect(int seat, const QString &effect, int sourceSeat) {
+    if (seat < 0 || seat >= int(players.size())) return;
+    setEffectFrom(seat, effect, true, sourceSeat);
+    if (const PhaseScheduler::Expiry *expiry = expiryFor(effect, sourceSeat))
+        scheduler.schedule(seat, effect, *expiry);
+}
+
+OpResult GameState::execute(int seat) {
+    if (seat < 0 || seat >= int(players.size())) return GameError{"Execute", "No such seat."};
+    if (!isAlive(seat)) return GameError{"Execute", QString("%1 is already dead.").arg(players[seat].name)};
+    players[seat].effects["Dead"] = true;
+    ++today().deaths;
+    today().executed = seat;
+    tracker.setAlive(seat, false, true);
+    ring.setAlive(seat, false);
+    updateImpaired(graph.setAlive(seat, false));
+    seatChanged(seat);
+    return std::nullopt;
+}
+
+DayRecord &GameState::today() {
+    if (int(day_log.size()) < day) day_log.resize(std::max(day, 1));
+    return day_log[std::max(day, 1) - 1];
+}
+
+OpResult GameState::setGhostVote(int seat, bool available) {
+    if (seat < 0 || seat >= int(players.size())) return GameError{"Ghost Vote", "No such seat."};
+    if (players[seat].ghostVote == available) return std::nullopt;
+    players[seat].ghostVote = available;
+    seatChanged(seat);
+    return std::nullopt;
+}
+
+void GameState::rebuildTracker() {
+    graph.reset(int(players.size()));
+    ring.reset(int(players.size()));
+    for (int i = 0; i < int(players.size()); ++i) {
+        ring.setAlive(i, isAlive(i));
+        graph.setAlive(i, isAlive(i));
+        graph.setInnate(i, innatelyImpaired(i));
+        graph.setUnsourced(i, AbilityGraph::Poisoned, hasEffect(i, "Poisoned"));
+        graph.setUnsourced(i, AbilityGraph::Drunk, hasEffect(i, "Drunk"));
+    }
+    tracker.clear();
+    for (int i = 0; i < int(players.size()); ++i)
+        tracker.addSeat(players[i].character.id, players[i].team, isAlive(i), isImpaired(i));
+    notifyChanged({GameChange::Players});
+}
+
+// ---------- Change events ----------
+int GameState::addChangeListener(ChangeListener listener) {
+    int id = listeners.nextId++;
+    listeners.list.emplace_back(id, std::move(listener));
+    return id;
+}
+
+void GameState::removeChangeListener(int id) {
+    auto &list = listeners.list;
+    list.erase(std::remove_if(list.begin(), list.end(), [id](const auto &l) { return l.first == id; }), list.end());
+}
+
+void GameState::notifyChanged(const GameChange &change) const {
+    for (auto &l : listeners.list) l.second(change);
+}
+
+// ---------- Claims & info ----------
+OpResult GameState::setClaim(int seat, const QString &characterId) {
+    if (seat < 0 || seat >= int(players.size())) return GameError{"Set Claim", "No such seat."};
+    if (!characterId.isEmpty() && !characterDB().count(characterId))
+        return GameError{"Set Claim", QString("Unknown character %1.").arg(characterId)};
+    players[seat].claim = characterId;
+    return std::nullopt;
+}
+
+OpResult GameState::recordInfo(const InfoRecord &record) {
+    if (record.seat < 0 || record.seat >= int(players.size())) return GameError{"Record Info", "No such seat."};
+    for (int s : record.seats)
+        if (s < 0 || s >= int(players.size())) return GameError{"Record Info", "Info names a seat that does not exist."};
+    info_log.push_back(record);
+    return std::nullopt;
+}
+
+// ---------- Setup ----------
+// Samples a setup for `num` players from the script's team pools
+OpResult GameState::drawSetup(int num, std::vector<Character> &selected) {
+    if (!role_config.count(num)) return GameError{"Unsupported", "Only 5–15 players supported."};
+
+    auto &cfg = role_config.at(num);
+    std::unordered_map<QString, std::vector<Character>> team_pool;
+    for (auto &c : scriptCharacters()) team_pool[c.team].push_back(c);
+
+    // Check for enough characters
+    for (auto &kv : cfg) {
+        if (team_pool[kv.first].size() < (size_t)kv.second)
+            return GameError{"Not enough characters",
+                             QString("Script does not have enough unique %1 characters").arg(kv.first)};
+    }
+
+    selected.clear();
+    for (auto &kv : cfg) {
+        auto s = sample(team_pool[kv.first], kv.second);
+        selected.insert(selected.end(), s.begin(), s.end());
+    }
+    std::shuffle(selected.begin(), selected.end(), rng);
+    return std::nullopt;
+}
+
+void GameState::resetForNewGame() {
+    rebuildTracker();
+    scheduler.clear();
+    chooseBluffs();
+    info_log.clear();
+    day_log.clear();
+    archived = false;
+    first_night = true;
+    night = false;
+    day = 1;
+    notifyChanged({GameChange::Phase});
+}
+
+OpResult GameState::assignRandomCharacters() {
+    int num_players = players.size();
+    if (num_players == 0) return GameError{"No Players", "Add players first."};
+
+    std::vector<Character> selected;
+    if (auto err = drawSetup(num_players, selected)) return err;
+
+    for (int i = 0; i < num_players; i++) {
+        players[i].character = selected[i];
+        players[i].team = selected[i].team;
+        players[i].alive = true;
+        players[i].poisoned = false;
+        players[i].drunk = false;
+        players[i].ghostVote = true;
+        players[i].effects = init_effects;
+    }
+
+    resetForNewGame();
+    return std::nullopt;
+}
+
+OpResult GameState::generateGame(int num) {
+    std::vector<Character> selected;
+    if (auto err = drawSetup(num, selected)) return err;
+
+    players.clear();
+    for (int i = 0; i < num; i++) {
+        Player p;
+        p.name = QString("Player %1").arg(i + 1);
+        p.character = selected[i];
+        p.team = selected[i].team;
+        p.effects = init_effects;   // copy of initial effects map
+        players.push_back(p);
+    }
+
+    resetForNewGame();
+    return std::nullopt;
+}
+
+OpResult GameState::assignCharacters(std::vector<Character> selected) {
+    if (selected.size() < players.size())
+        return GameError{"Not enough characters", "Select at least as many characters as players."};
+
+    std::shuffle(selected.begin(), selected.end(), rng);
+    for (size_t i = 0; i < players.size(); ++i) {
+        players[i].character = selected[i];
+        players[i].team = selected[i].team;
+        players[i].alive = true;
+        players[i].poisoned = false;
+        players[i].drunk = false;
+        players[i].ghostVote = true;
+        players[i].effects = init_effects;
+    }
+    resetForNewGame();
+    return std::nullopt;
+}
+
+std::vector<Character> GameState::bluffCandidates() const {
+    std::vector<Character> eligible;
+    for (auto &c : scriptCharacters())
+        if (c.team == "townsfolk" || c.team == "outsider") eligible.push_back(c);
+    return eligible;
+}
+
+void GameState::chooseBluffs() {
+    BluffOptimiser optimiser(*this, &rng);
+    std::vector<BluffOptimiser::Option> options = optimiser.rank(5);
+    if (options.empty()) {
+        bluffs.clear();
+        return;
+    }
+
+    // Vary between the near-best combinations so the Demon does not always get the same three
+    size_t nearBest = 1;
+    while (nearBest < options.size() && options[nearBest].score >= options[0].score - 10) ++nearBest;
+    std::uniform_int_distribution<size_t> pick(0, nearBest - 1);
+    bluffs = optimiser.charactersOf(options[pick(rng)]);
+}
+
+// ---------- Ability rules ----------
+AbilityRules::State GameState::ruleState() const {
+    AbilityRules::State s;
+    s.resize(int(players.size()));
+    for (int i = 0; i < int(players.size()); ++i) {
+        const Player &p = players[i];
+        std::uint64_t bits = 0;
+        for (auto &kv : p.effects) {
+            int bit = kv.second ? abilityRules().effectBit(kv.first) : -1;
+            if (bit >= 0) bits |= std::uint64_t(1) << bit;
+        }
+        if (!p.alive) bits |= std::uint64_t(1) << AbilityRules::DeadBit;
+        if (p.poisoned) bits |= std::uint64_t(1) << AbilityRules::PoisonedBit;
+        if (p.drunk) bits |= std::uint64_t(1) << AbilityRules::DrunkBit;
+        s.effects[i] = bits;
+        s.character[i] = abilityRules().characterIndex(p.character.id);
+        s.team[i] = std::uint8_t(WinTracker::teamIndex(p.team));
+    }
+    return s;
+}
+
+OpResult GameState::resolveAbility(int seat, const std::vector<int> &targets) {
+    if (seat < 0 || seat >= int(players.size())) return GameError{"Night Action", "No such seat."};
+    const Player &p = players[seat];
+    int ability = abilityRules().abilityFor(p.character.id, first_night);
+    if (ability < 0) return GameError{"Night Action", QString("No rule resolves the %1 tonight.").arg(p.character.name)};
+    if (!abilityActive(seat))
+        return GameError{"Night Action", QString("%1 is drunk or poisoned: the ability has no effect.").arg(p.name)};
+
+    // The graph has the last word: a reminder whose source lapsed no longer impairs
+    AbilityRules::State s = ruleState();
+    s.effects[seat] &= ~((std::uint64_t(1) << AbilityRules::PoisonedBit) | (std::uint64_t(1) << AbilityRules::DrunkBit));
+    const AbilityRules::State before = s;
+    int target = targets.size() > 0 ? targets[0] : -1;
+    int second = targets.size() > 1 ? targets[1] : -1;
+    if (!abilityRules().run(ability, s, seat, target, second))
+        return GameError{"Night Action", QString("%1 is drunk or poisoned: the ability has no effect.").arg(p.name)};
+
+    // Write back only what the rule changed, so the win tracker sees each change
+    const QStringList &names = abilityRules().effectNames();
+    for (int i = 0; i < s.seats(); ++i) {
+        const std::uint64_t timed = s.untilDusk[i] | s.untilDawn[i];
+        for (std::uint64_t changed = s.effects[i] ^ before.effects[i]; changed; changed &= changed - 1) {
+            int bit = int(qCountTrailingZeroBits(quint64(changed)));
+            bool on = (s.effects[i] >> bit) & 1;
+            if (on && !(timed >> bit & 1)) applyEffect(i, names[bit], seat); // the character data may still time it
+            else setEffectFrom(i, names[bit], on, on ? seat : -1);
+        }
+        for (std::uint64_t bits = s.untilDusk[i]; bits; bits &= bits - 1)
+            scheduler.schedule(i, names[int(qCountTrailingZeroBits(quint64(bits)))], PhaseScheduler::Expiry{PhaseScheduler::Dusk, 1, {}});
+        for (std::uint64_t bits = s.untilDawn[i]; bits; bits &= bits - 1)
+            scheduler.schedule(i, names[int(qCountTrailingZeroBits(quint64(bits)))], PhaseScheduler::Expiry{PhaseScheduler::Dawn, 1, {}});
+    }
+    return std::nullopt;
+}
+
+// Ends what is due at the boundary; an effect cleared by hand in the
+// meantime is left alone and does not turn into its follow-up
+void GameState::expire(PhaseScheduler::Boundary boundary) {
+    if (!scheduler.advance(boundary, due)) return;
+    for (auto &d : due) {
+        if (d.seat >= int(players.size())) continue;
+        const QString &effect = scheduler.effectName(d.effect);
+        if (!hasEffect(d.seat, effect)) continue;
+        setEffect(d.seat, effect, false);
+        if (d.then >= 0) applyEffect(d.seat, scheduler.effectName(d.then));
+    }
+}
+
+// ---------- Phases ----------
+std::vector<int> GameState::nightOrder(bool showAll) const {
+    std::vector<int> seats;
+    for (int i = 0; i < int(players.size()); ++i) {
+        const Character &c = players[i].character;
+        if (showAll) seats.push_back(i);
+        else if (first_night && !c.firstNightReminder.isEmpty()) seats.push_back(i);
+        else if (!first_night && !c.otherNightReminder.isEmpty()) seats.push_back(i);
+    }
+
+    // Sort by night order; characters without one go last
+    std::stable_sort(seats.begin(), seats.end(), [this](int a, int b) {
+        const Character &ca = players[a].character;
+        const Character &cb = players[b].character;
+        int orderA = first_night ? ca.first_night_order.value_or(1000) : ca.other_night_order.value_or(1000);
+        int orderB = first_night ? cb.first_night_order.value_or(1000) : cb.other_night_order.value_or(1000);
+        return orderA < orderB;
+    });
+    return seats;
+}
+
+void GameState::startNight() {
+    expire(PhaseScheduler::Dusk);
+    night = true;
+    notifyChanged({GameChange::Phase});
+}
+
+void GameState::endNight() {
+    expire(PhaseScheduler::Dawn);
+    first_night = false;
+    night = false;
+    notifyChanged({GameChange::Phase});
+}
+
+void GameState::advanceDay() {
+    tracker.endDay();
+    day++;
+    first_night = false;
+    notifyChanged({GameChange::Phase});
+}
@@ -0,0 +1,277 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "AbilityGraph.h"
+#include "AbilityRules.h"
+#include "PhaseScheduler.h"
+#include "SeatRing.h"
+#include "WinTracker.h"
+
+// ---------- Data models ----------
+struct Character {
+    QString id;
+    QString name;
+    QString team;
+    QString ability;
+    std::optional<int> first_night_order = 999;
+    std::optional<int> other_night_order = 999;
+    QString firstNightReminder;
+    QString otherNightReminder;
+    std::vector<QString> reminders;
+    std::unordered_map<QString, PhaseScheduler::Expiry> reminderExpiry;   // reminders that end on their own
+};
+
+struct Player {
+    QString name;
+    QString team;
+    Character character;
+    QString claim;           // character id the player publicly claims, empty if none
+    bool alive = true;
+    bool poisoned = false;
+    bool drunk = false;
+    bool ghostVote = true;   // a dead player's one remaining vote, until spent
+    std::unordered_map<QString,bool> effects;
+
+    QString status() const {
+        QStringList flags;
+        if (!alive) flags << "Dead";
+        if (poisoned) flags << "Poisoned";
+        if (drunk) flags << "Drunk";
+        for (auto &kv : effects) if (kv.second) flags << kv.first;
+        return flags.empty() ? "Healthy" : flags.join(" / ");
+    }
+};
+
+// Something a player learnt from their ability, as the Storyteller gave it
+struct InfoRecord {
+    int seat = -1;           // who received it
+    int night = 1;
+    QString role;            // character id of the ability, e.g. "empath"
+    std::vector<int> seats;  // players shown or chosen (Empath: its alive neighbours)
+    QString character;       // character id shown, if any
+    int number = 0;          // Chef / Empath count
+    bool yes = false;        // Fortune Teller answer
+
+    bool operator==(const InfoRecord &o) const {
+        return seat == o.seat && night == o.night && role == o.role && seats == o.seats
+            && character == o.character && number == o.number && yes == o.yes;
+    }
+};
+
+// What one day of a game cost: deaths that day and the night before it
+struct DayRecord {
+    int deaths = 0;
+    int executed = -1;       // seat executed, -1 if none
+};
+
+// ---------- Shared data ----------
+// The character database and a loaded script never change once built:
+// loading makes a new snapshot instead of editing the old one. Any number
+// of games (window tabs, worker threads) share one reference-counted copy.
+struct CharacterDB {
+    std::unordered_map<QString, Character> characters;
+    AbilityRules rules;      // from the .rules file next to the character database
+};
+
+struct Script {
+    QString name;                        // file name without extension
+    std::vector<Character> characters;   // from the character database, in script order
+    std::vector<QString> reminders;      // of those characters, sorted
+};
+
+// ---------- Change events ----------
+// What a mutation changed, for views that follow the game without
+// rebuilding everything (see GameState::addChangeListener)
+struct GameChange {
+    enum Kind {
+        Seat,       // one seat's name, character, life or ghost vote
+        Players,    // seats added, reordered or dealt again: anything may differ
+        Phase,      // day / night
+        Effect      // one seat's reminders other than Dead, which is a Seat change
+    };
+    Kind kind = Players;
+    int seat = -1;          // for Seat and Effect
+};
+
+// ---------- Errors ----------
+// Core operations never open dialogs; they return std::nullopt on success
+// or an error the caller can show however it likes.
+struct GameError {
+    QString title;
+    QString message;
+};
+using OpResult = std::optional<GameError>;
+
+// ---------- Game state ----------
+// Everything a game needs, with no QtWidgets dependency, so it can be driven
+// from the window, worker threads, CLIs and benchmarks alike. Each state owns
+// its RNG; seed() makes sampling deterministic.
+class GameState {
+public:
+    GameState();
+
+    // Static configs
+    static const std::unordered_map<int, std::unordered_map<QString,int>> role_config;
+    static const std::vector<QString> all_teams;
+
+    void seed(std::uint32_t value) { rng.seed(value); }
+
+    // ---------- Loading ----------
+    OpResult loadCharacterDB(const QString &path);
+    OpResult loadScript(const QString &path);
+    // Another game's snapshots as they are, e.g. for a new table
+    void shareData(const GameState &other);
+    void setScript(std::shared_ptr<const Script> value);
+
+    const std::unordered_map<QString, Character> &characterDB() const { return db->characters; }
+    const AbilityRules &abilityRules() const { return db->rules; }
+    const std::vector<Character> &scriptCharacters() const { return script->characters; }
+    const std::vector<QString> &scriptReminders() const { return script->reminders; }
+    const QString &scriptName() const { return script->name; }
+    std::shared_ptr<const CharacterDB> sharedCharacterDB() const { return db; }
+    std::shared_ptr<const Script> sharedScript() const { return script; }
+
+    // ---------- Players ----------
+    std::vector<Character> availableCharacters(bool includeAssigned) const;
+    // An empty character name seats the player without a character yet
+    OpResult addPlayer(const QString &name, const QString &characterName);
+    // The same at `seat`, e.g. a Traveller; everyone from there on moves one clockwise
+    OpResult insertPlayer(int seat, const QString &name, const QString &characterName);
+    OpResult editPlayer(int seat, const QString &name, const QString &characterName);
+    // By id, on the script or not; an id not in the database gives a blank
+    // character with that id (e.g. from a peer with a newer database)
+    void setCharacter(int seat, const QString &characterId);
+    // order[i] is the current seat of whoever sits at seat i afterwards
+    OpResult seatPlayers(const std::vector<int> &order);
+    // For whoever reorders `players` directly: newSeat[i] is where the player
+    // from seat i sits now (-1 if they left). Their logs, timed reminders,
+    // who impairs them and the tracker's counts follow them; anyone new is
+    // read from `players`.
+    void remapSeats(const std::vector<int> &newSeat);
+
+    bool hasEffect(int seat, const QString &effect) const;
+    void setEffect(int seat, const QString &effect, bool on);
+    void toggleEffect(int seat, const QString &effect) { setEffect(seat, effect, !hasEffect(seat, effect)); }
+    // Sets an effect and schedules its end from the character data: the
+    // source seat's character, else the one character in play that defines it
+    void applyEffect(int seat, const QString &effect, int sourceSeat = -1);
+    bool isAlive(int seat) const { return players[seat].alive && !hasEffect(seat, "Dead"); }
+    bool isImpaired(int seat) const { return !graph.abilityActive(seat); }
+    OpResult execute(int seat);
+    OpResult setGhostVote(int seat, bool available);
+
+    // ---------- Setup ----------
+    OpResult assignRandomCharacters();
+    OpResult generateGame(int num);
+    OpResult assignCharacters(std::vector<Character> selected);
+    void chooseBluffs();
+    std::vector<Character> bluffCandidates() const;
+
+    // ---------- Claims & info ----------
+    OpResult setClaim(int seat, const QString &characterId);
+    OpResult recordInfo(const InfoRecord &record);
+
+    // ---------- Ability rules ----------
+    // Runs the compiled rule for the seat's character tonight on the chosen
+    // targets and applies the effects it changed
+    OpResult resolveAbility(int seat, const std::vector<int> &targets);
+    // The grimoire as the rules VM sees it, e.g. to seed a simulation
+    AbilityRules::State ruleState() const;
+
+    // ---------- Phases ----------
+    // Seats in night order; all seats when showAll, else only those with a reminder
+    std::vector<int> nightOrder(bool showAll) const;
+    int currentNight() const { return first_night ? 1 : day; }
+    bool isNight() const { return night; }
+    void startNight();       // dusk
+    void endNight();         // dawn
+    void advanceDay();
+
+    // ---------- Win conditions ----------
+    // Kept current by every mutation above; rebuildTracker() is only needed
+    // after writing `players` directly, and forgets who applied each effect
+    const WinTracker &winTracker() const { return tracker; }
+    std::vector<GameAlert> takeAlerts() { return tracker.takeAlerts(); }
+    bool hasAlerts() const { return tracker.hasAlerts(); }
+    void rebuildTracker();
+
+    const PhaseScheduler &phaseScheduler() const { return scheduler; }
+
+    // ---------- Ability validity ----------
+    // Whether the seat's ability works, following Poisoned / Drunk back to
+    // who applied them (see AbilityGraph); kept current like the tracker
+    bool abilityActive(int seat) const { return graph.abilityActive(seat); }
+    std::vector<int> impairedBy(int seat) const { return graph.impairedBy(seat); }
+    const AbilityGraph &abilityGraph() const { return graph; }
+
+    // ---------- Seating ----------
+    // Who is alive around the circle, kept current like the tracker
+    const SeatRing &seatRing() const { return ring; }
+    int aliveNeighbour(int seat, bool clockwise) const { return ring.neighbour(seat, clockwise); }
+
+    // ---------- Change events ----------
+    // Listeners run synchronously after each mutation above that a player
+    // could see. A copy of the state starts with none, so drafts and worker
+    // copies stay silent; whoever writes `players` directly calls
+    // notifyChanged() (rebuildTracker() does so).
+    using ChangeListener = std::function<void(const GameChange &)>;
+    int addChangeListener(ChangeListener listener);
+    void removeChangeListener(int id);
+    void notifyChanged(const GameChange &change) const;
+
+    // ---------- State ----------
+    int day = 1;
+    bool first_night = true;
+
+    std::vector<Player> players;
+    std::vector<Character> bluffs;
+    std::unordered_map<QString,bool> init_effects;
+    std::vector<InfoRecord> info_log;
+    // [day - 1], kept by kills, revivals and executions; cleared for each
+    // new game, as is `archived` (set once the game is in a GameArchive)
+    std::vector<DayRecord> day_log;
+    bool archived = false;
+
+private:
+    template<typename T>
+    std::vector<T> sample(const std::vector<T> &data, size_t k);
+    OpResult drawSetup(int num, std::vector<Character> &selected);
+    void resetForNewGame();
+
+    void expire(PhaseScheduler::Boundary boundary);
+    void seatChanged(int seat) const { notifyChanged({GameChange::Seat, seat}); }
+    DayRecord &today();
+    void setEffectFrom(int seat, const QString &effect, bool on, int sourceSeat);
+    void updateImpaired(const std::vector<int> &seats);
+    bool innatelyImpaired(int seat) const;
+    const PhaseScheduler::Expiry *expiryFor(const QString &effect, int sourceSeat) const;
+
+    std::shared_ptr<const CharacterDB> db;
+    std::shared_ptr<const Script> script;
+    std::mt19937 rng;
+    WinTracker tracker;
+    AbilityGraph graph;
+    SeatRing ring;
+    PhaseScheduler scheduler;
+    std::vector<PhaseScheduler::Due> due;               // reused between boundaries
+    bool night = false;
+
+    // Belong to the object, not its value: copying or assigning a state
+    // leaves each side's listeners where they were
+    struct Listeners {
+        Listeners() = default;
+        Listeners(const Listeners &) {}
+        Listeners &operator=(const Listeners &) { return *this; }
+        std::vector<std::pair<int, ChangeListener>> list;
+        int nextId = 0;
+    };
+    Listeners listeners;
+};
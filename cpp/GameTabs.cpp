@@ -0,0 +1,80 @@
+#include "GameTabs.h"
+#include "AutomationServer.h"
+#include "storyteller.h"
+#include <QMessageBox>
+#include <QTabWidget>
+#include <QToolButton>
+
+GameTabs::GameTabs(QWidget *parent)
+    : QMainWindow(parent)
+{
+    setWindowTitle("Blood on the Clocktower - Qt");
+    resize(1200, 800);
+
+    tabs = new QTabWidget(this);
+    tabs->setDocumentMode(true);
+    tabs->setTabsClosable(true);
+    tabs->setMovable(true);
+    setCentralWidget(tabs);
+    connect(tabs, &QTabWidget::tabCloseRequested, this, &GameTabs::closeGame);
+
+    QToolButton *addButton = new QToolButton(tabs);
+    addButton->setText("+");
+    addButton->setToolTip("New table (Ctrl+T)");
+    tabs->setCornerWidget(addButton, Qt::TopRightCorner);
+    connect(addButton, &QToolButton::clicked, this, [this]() { addGame(currentGame()); });
+
+    addGame();
+
+    automation = new AutomationServer([this](const nlohmann::json &message) { return runCommands(message); }, this);
+    if (automation->start())
+        qDebug() << "Automation server listening on" << automation->serverName();
+    else if (!automation->errorString().isEmpty())
+        qWarning() << "Automation server:" << automation->errorString();
+}
+
+StorytellerWindow *GameTabs::currentGame() const {
+    return qobject_cast<StorytellerWindow *>(tabs->currentWidget());
+}
+
+StorytellerWindow *GameTabs::addGame(const StorytellerWindow *shareFrom) {
+    StorytellerWindow *game = shareFrom ? new StorytellerWindow(nullptr, false, &shareFrom->gameState())
+                                        : new StorytellerWindow(nullptr, true);
+    game->setWindowFlags(Qt::Widget);   // a page, not a window of its own
+
+    int index = tabs->addTab(game, game->gameTitle());
+    tabs->setCurrentIndex(index);
+    connect(game, &StorytellerWindow::gameTitleChanged, this, [this, game](const QString &title) {
+        int i = tabs->indexOf(game);
+        if (i >= 0) tabs->setTabText(i, title);
+    });
+    connect(game, &StorytellerWindow::newGameRequested, this, [this, game]() { addGame(game); });
+    return game;
+}
+
+nlohmann::json GameTabs::runCommands(const nlohmann::json &message) {
+    int index = -1;
+    if (message.is_object() && message.contains("table") && message["table"].is_number_integer())
+        index = message["table"].get<int>();
+    auto *game = qobject_cast<StorytellerWindow *>(index < 0 ? tabs->currentWidget() : tabs->widget(index));
+    if (!game) {
+        nlohmann::json reply = {{"ok", false}, {"error", {{"title", "Bad Message"}, {"message", "No such table."}}}};
+        if (message.is_object() && message.contains("id")) reply["id"] = message["id"];
+        return reply;
+    }
+    return game->runCommands(message);
+}
+
+void GameTabs::closeGame(int index) {
+    if (tabs->count() <= 1) return;   // the window always has a table
+    auto *game = qobject_cast<StorytellerWindow *>(tabs->widget(index));
+    if (!game) return;
+
+    if (!game->gameState().players.empty()) {
+        auto answer = QMessageBox::question(this, "Close Table",
+            QString("Close %1? Its game will be lost.").arg(game->gameTitle()));
+        if (answer != QMessageBox::Yes) return;
+    }
+    tabs->removeTab(index);
+    game->deleteLater();
+}
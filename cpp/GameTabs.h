@@ -0,0 +1,34 @@
+#pragma once
+#include <QMainWindow>
+#include <nlohmann/json.hpp>
+
+class AutomationServer;
+class QTabWidget;
+class StorytellerWindow;
+
+// ---------- Game tabs ----------
+// One StorytellerWindow per table, for running several games from one
+// machine. A new table starts on the character database and script
+// snapshots of the table it was opened from, and icons and token sprites
+// come from the process-wide caches, so each extra table costs its own
+// GameState and widgets only. Switching tabs just shows another page.
+//
+// Automation messages (see AutomationServer) go to the current table, or
+// to the table at index "table" when a message names one.
+class GameTabs : public QMainWindow {
+    Q_OBJECT
+public:
+    explicit GameTabs(QWidget *parent = nullptr);
+
+    StorytellerWindow *currentGame() const;
+    // The first table loads the database and asks for a script; later
+    // ones share those of `shareFrom`
+    StorytellerWindow *addGame(const StorytellerWindow *shareFrom = nullptr);
+
+private:
+    void closeGame(int index);
+    nlohmann::json runCommands(const nlohmann::json &message);
+
+    QTabWidget *tabs;
+    AutomationServer *automation = nullptr;
+};
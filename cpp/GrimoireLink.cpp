@@ -0,0 +1,135 @@
+#include "GrimoireLink.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <algorithm>
+#include <string>
+
+using json = nlohmann::json;
+
+GrimoireLink::GrimoireLink(GrimoireSync &sync, QObject *parent)
+    : QObject(parent), sync(sync)
+{
+    sync.setSender([this](const SyncOp &op) { broadcast(op, nullptr); });
+}
+
+GrimoireLink::~GrimoireLink() {
+    sync.setSender(nullptr);
+}
+
+bool GrimoireLink::join(const QString &session) {
+    QString name = "botc-sync-" + session;
+    return connectTo(name) || listen(name);
+}
+
+bool GrimoireLink::listen(const QString &name) {
+    if (server) return true;
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    bool listening = server->listen(name);
+    if (!listening && server->serverError() == QAbstractSocket::AddressInUseError) {
+        // Only take the name over if it was left behind by a run that
+        // crashed: a live instance still answers on it
+        QLocalSocket probe;
+        probe.connectToServer(name);
+        if (probe.waitForConnected(200)) {
+            probe.abort();
+            lastError = QString("Another instance is already listening on %1").arg(name);
+            delete server;
+            server = nullptr;
+            return false;
+        }
+        QLocalServer::removeServer(name);
+        listening = server->listen(name);
+    }
+    if (!listening) {
+        lastError = server->errorString();
+        delete server;
+        server = nullptr;
+        return false;
+    }
+    connect(server, &QLocalServer::newConnection, this, [this]() {
+        while (QLocalSocket *socket = server->nextPendingConnection()) attach(socket);
+    });
+    return true;
+}
+
+bool GrimoireLink::connectTo(const QString &name, int timeoutMs) {
+    auto *socket = new QLocalSocket(this);
+    socket->connectToServer(name);
+    if (!socket->waitForConnected(timeoutMs)) {
+        lastError = socket->errorString();
+        delete socket;
+        return false;
+    }
+    attach(socket);
+    return true;
+}
+
+void GrimoireLink::attach(QLocalSocket *socket) {
+    peers.push_back({socket, {}});
+    connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { read(socket); });
+    connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    connect(socket, &QObject::destroyed, this, [this, socket]() {
+        peers.erase(std::remove_if(peers.begin(), peers.end(), [socket](const Peer &p) { return p.socket == socket; }),
+                    peers.end());
+        emit peersChanged(peerCount());
+    });
+
+    json clock = json::object();
+    for (auto &kv : sync.replica().clock()) clock[std::to_string(kv.first)] = kv.second;
+    sendLine(socket, {{"hello", sync.replica().id()}, {"clock", std::move(clock)}});
+    emit peersChanged(peerCount());
+}
+
+void GrimoireLink::sendLine(QLocalSocket *socket, const json &message) {
+    socket->write(QByteArray::fromStdString(message.dump()) + '\n');
+}
+
+void GrimoireLink::broadcast(const SyncOp &op, QLocalSocket *except) {
+    if (peers.empty()) return;
+    const QByteArray line = QByteArray::fromStdString(json{{"op", op.toJson()}}.dump()) + '\n';
+    for (const Peer &p : peers)
+        if (p.socket != except) p.socket->write(line);
+}
+
+// ---------- Messages ----------
+void GrimoireLink::read(QLocalSocket *socket) {
+    auto peer = std::find_if(peers.begin(), peers.end(), [socket](const Peer &p) { return p.socket == socket; });
+    if (peer == peers.end()) return;
+    peer->buffer += socket->readAll();
+
+    int applied = 0;
+    qsizetype start = 0;
+    for (qsizetype end; (end = peer->buffer.indexOf('\n', start)) >= 0; start = end + 1) {
+        json message = json::parse(peer->buffer.constData() + start, peer->buffer.constData() + end, nullptr, false);
+        if (!message.is_object()) continue;
+
+        if (message.contains("op")) {
+            std::optional<SyncOp> op = SyncOp::fromJson(message["op"]);
+            if (!op) continue;
+            for (const SyncOp &done : sync.receive(*op)) {
+                broadcast(done, socket);
+                ++applied;
+            }
+        } else if (message.contains("clock") && message["clock"].is_object()) {
+            // A hello: send whatever the peer has not seen
+            VectorClock clock;
+            for (auto it = message["clock"].begin(); it != message["clock"].end(); ++it) {
+                if (!it.value().is_number_unsigned()) continue;
+                try { clock[std::stoull(it.key())] = it.value().get<std::uint64_t>(); }
+                catch (const std::exception &) {}
+            }
+            QByteArray out;
+            for (const SyncOp &op : sync.replica().missing(clock))
+                out += QByteArray::fromStdString(json{{"op", op.toJson()}}.dump()) + '\n';
+            if (!out.isEmpty()) socket->write(out);
+        }
+    }
+    peer->buffer.remove(0, start);
+
+    if (peer->buffer.size() > MaxLineBytes) {
+        lastError = "A peer sent a line that is too long.";
+        socket->disconnectFromServer();
+    }
+    if (applied) emit received(applied);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <QByteArray>
+#include <QObject>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "GrimoireSync.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+// ---------- Grimoire link ----------
+// Carries a GrimoireSync's operations between instances over local
+// sockets, one JSON object per line. On connecting, each side sends
+//
+//   {"hello": <replica id>, "clock": {"<origin>": <counter>, ...}}
+//
+// and answers the other's hello with the operations its clock lacks. After
+// that each local operation goes to every peer as {"op": {...}}, and an
+// operation new to this replica is passed on to the other peers, so any
+// connected set of instances converges; join() makes a star around the
+// session's first instance.
+class GrimoireLink : public QObject {
+    Q_OBJECT
+public:
+    using json = nlohmann::json;
+
+    // The sync must outlive the link
+    explicit GrimoireLink(GrimoireSync &sync, QObject *parent = nullptr);
+    ~GrimoireLink() override;
+
+    // Connects to the instance serving the session, or becomes it
+    bool join(const QString &session);
+    bool listen(const QString &name);
+    bool connectTo(const QString &name, int timeoutMs = 500);
+
+    int peerCount() const { return int(peers.size()); }
+    QString errorString() const { return lastError; }
+
+    static constexpr int MaxLineBytes = 4 * 1024 * 1024;
+
+signals:
+    void peersChanged(int peers);
+    void received(int ops);   // peers' operations just applied to the game
+
+private:
+    struct Peer {
+        QLocalSocket *socket = nullptr;   // removed from peers when destroyed
+        QByteArray buffer;
+    };
+
+    void attach(QLocalSocket *socket);
+    void read(QLocalSocket *socket);
+    void broadcast(const SyncOp &op, QLocalSocket *except);
+    static void sendLine(QLocalSocket *socket, const json &message);
+
+    GrimoireSync &sync;
+    QLocalServer *server = nullptr;
+    std::vector<Peer> peers;
+    QString lastError;
+};
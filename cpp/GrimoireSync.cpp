@@ -0,0 +1,379 @@
+#include "GrimoireSync.h"
+#include <algorithm>
+#include <unordered_set>
+
+using json = nlohmann::json;
+
+// ---------- Sync operations ----------
+static const char *kindNames[] = {"seat", "effect", "day"};
+
+json SyncOp::toJson() const {
+    json j = {{"origin", origin}, {"n", counter}, {"t", lamport}, {"kind", kindNames[kind]}};
+    switch (kind) {
+    case Seat:
+        j["player"] = player.toStdString();
+        j["character"] = character.toStdString();
+        j["position"] = position;
+        j["on"] = on;
+        break;
+    case Effect:
+        j["player"] = player.toStdString();
+        j["effect"] = effect.toStdString();
+        j["on"] = on;
+        break;
+    case Day:
+        j["day"] = day;
+        break;
+    }
+    return j;
+}
+
+std::optional<SyncOp> SyncOp::fromJson(const json &j) {
+    if (!j.is_object()) return std::nullopt;
+    try {
+        SyncOp op;
+        op.origin = j.at("origin").get<std::uint64_t>();
+        op.counter = j.at("n").get<std::uint64_t>();
+        op.lamport = j.at("t").get<std::uint64_t>();
+        const std::string kind = j.at("kind").get<std::string>();
+        if (kind == "seat") {
+            op.kind = Seat;
+            op.character = QString::fromStdString(j.value("character", std::string()));
+            op.position = j.at("position").get<double>();
+        } else if (kind == "effect") {
+            op.kind = Effect;
+            op.effect = QString::fromStdString(j.at("effect").get<std::string>());
+        } else if (kind == "day") {
+            op.kind = Day;
+            op.day = j.at("day").get<int>();
+        } else {
+            return std::nullopt;
+        }
+        if (op.kind != Day) {
+            op.player = QString::fromStdString(j.at("player").get<std::string>());
+            op.on = j.value("on", true);
+        }
+        if (op.counter == 0 || (op.kind != Day && op.player.isEmpty())) return std::nullopt;
+        return op;
+    } catch (const json::exception &) {
+        return std::nullopt;
+    }
+}
+
+// ---------- Grimoire replica ----------
+GrimoireReplica::GrimoireReplica(std::uint64_t id)
+    : self(id)
+{
+}
+
+SyncOp GrimoireReplica::local(SyncOp op) {
+    op.origin = self;
+    op.counter = ++seen[self];
+    op.lamport = ++lamport;
+    apply(op);
+    applied.push_back(op);
+    return op;
+}
+
+SyncOp GrimoireReplica::seat(const QString &player, const QString &character, double position, bool seated) {
+    SyncOp op;
+    op.kind = SyncOp::Seat;
+    op.player = player;
+    op.character = character;
+    op.position = position;
+    op.on = seated;
+    return local(std::move(op));
+}
+
+SyncOp GrimoireReplica::setEffect(const QString &player, const QString &effect, bool on) {
+    SyncOp op;
+    op.kind = SyncOp::Effect;
+    op.player = player;
+    op.effect = effect;
+    op.on = on;
+    return local(std::move(op));
+}
+
+SyncOp GrimoireReplica::setDay(int day) {
+    SyncOp op;
+    op.kind = SyncOp::Day;
+    op.day = day;
+    return local(std::move(op));
+}
+
+std::vector<SyncOp> GrimoireReplica::receive(const SyncOp &op) {
+    std::vector<SyncOp> done;
+    std::uint64_t &last = seen[op.origin];
+    if (op.counter <= last) return done;
+    if (op.counter > last + 1) {
+        early.emplace(std::make_pair(op.origin, op.counter), op);
+        return done;
+    }
+
+    // Apply it, then whatever from the same origin was waiting on it
+    SyncOp next = op;
+    for (;;) {
+        apply(next);
+        lamport = std::max(lamport, next.lamport);
+        last = next.counter;
+        applied.push_back(next);
+        done.push_back(next);
+
+        auto waiting = early.find({op.origin, last + 1});
+        if (waiting == early.end()) break;
+        next = std::move(waiting->second);
+        early.erase(waiting);
+    }
+    return done;
+}
+
+std::vector<SyncOp> GrimoireReplica::missing(const VectorClock &peer) const {
+    std::vector<SyncOp> ops;
+    for (const SyncOp &op : applied) {
+        auto it = peer.find(op.origin);
+        if (it == peer.end() || op.counter > it->second) ops.push_back(op);
+    }
+    return ops;
+}
+
+// The register merge: a write replaces one with a smaller stamp
+void GrimoireReplica::apply(const SyncOp &op) {
+    const Stamp stamp{op.lamport, op.origin};
+    switch (op.kind) {
+    case SyncOp::Seat: {
+        PlayerRegs &p = players[op.player];
+        if (stamp < p.seatStamp) return;
+        p.seatStamp = stamp;
+        p.seated = op.on;
+        p.character = op.character;
+        p.position = op.position;
+        break;
+    }
+    case SyncOp::Effect: {
+        auto &reg = players[op.player].effects[op.effect];
+        if (stamp < reg.first) return;
+        reg = {stamp, op.on};
+        break;
+    }
+    case SyncOp::Day:
+        currentDay = std::max(currentDay, op.day);
+        break;
+    }
+}
+
+std::vector<GrimoireReplica::SeatState> GrimoireReplica::seating() const {
+    std::vector<SeatState> seats;
+    for (auto &kv : players)
+        if (kv.second.seated) seats.push_back({kv.first, kv.second.character, kv.second.position});
+    std::sort(seats.begin(), seats.end(), [](const SeatState &a, const SeatState &b) {
+        return a.position != b.position ? a.position < b.position : a.player < b.player;
+    });
+    return seats;
+}
+
+std::optional<GrimoireReplica::SeatState> GrimoireReplica::seatOf(const QString &player) const {
+    auto it = players.find(player);
+    if (it == players.end() || !it->second.seated) return std::nullopt;
+    return SeatState{player, it->second.character, it->second.position};
+}
+
+bool GrimoireReplica::hasEffect(const QString &player, const QString &effect) const {
+    auto it = players.find(player);
+    if (it == players.end()) return false;
+    auto e = it->second.effects.find(effect);
+    return e != it->second.effects.end() && e->second.second;
+}
+
+std::vector<QString> GrimoireReplica::effectsOf(const QString &player) const {
+    std::vector<QString> on;
+    auto it = players.find(player);
+    if (it == players.end()) return on;
+    for (auto &kv : it->second.effects)
+        if (kv.second.second) on.push_back(kv.first);
+    std::sort(on.begin(), on.end());
+    return on;
+}
+
+// FNV-1a over the grimoire in a fixed order
+std::uint64_t GrimoireReplica::digest() const {
+    std::uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](const void *data, size_t size) {
+        auto bytes = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < size; ++i) h = (h ^ bytes[i]) * 1099511628211ull;
+    };
+    auto mixText = [&mix](const QString &s) {
+        std::string utf8 = s.toStdString();
+        mix(utf8.c_str(), utf8.size() + 1);
+    };
+
+    mix(&currentDay, sizeof currentDay);
+    std::vector<QString> names;
+    for (auto &kv : players) names.push_back(kv.first);
+    std::sort(names.begin(), names.end());
+    for (const QString &name : names) {
+        const PlayerRegs &p = players.at(name);
+        mixText(name);
+        mix(&p.seated, sizeof p.seated);
+        if (p.seated) {
+            mixText(p.character);
+            mix(&p.position, sizeof p.position);
+        }
+        for (const QString &effect : effectsOf(name)) mixText(effect);
+    }
+    return h;
+}
+
+// ---------- Grimoire sync ----------
+GrimoireSync::GrimoireSync(GameState &game, std::uint64_t id)
+    : game(game), state(id)
+{
+    publishSeating();
+    for (int i = 0; i < int(game.players.size()); ++i) publishEffects(i);
+    publishDay();
+    listener = game.addChangeListener([this](const GameChange &change) { changed(change); });
+}
+
+GrimoireSync::~GrimoireSync() {
+    game.removeChangeListener(listener);
+}
+
+void GrimoireSync::setSender(Sender value) {
+    sender = std::move(value);
+}
+
+void GrimoireSync::send(const SyncOp &op) {
+    if (sender) sender(op);
+}
+
+// ---------- Local edits ----------
+void GrimoireSync::changed(const GameChange &change) {
+    if (applying) return;   // our own writes from a peer's operations
+    switch (change.kind) {
+    case GameChange::Seat:
+        publishSeating();
+        publishEffects(change.seat);
+        break;
+    case GameChange::Effect:
+        publishEffects(change.seat);
+        break;
+    case GameChange::Players:
+        publishSeating();
+        for (int i = 0; i < int(game.players.size()); ++i) publishEffects(i);
+        publishDay();
+        break;
+    case GameChange::Phase:
+        publishDay();
+        break;
+    }
+}
+
+// Seats whose player, character or place differ, and players who left
+void GrimoireSync::publishSeating() {
+    std::unordered_set<QString> present;
+    for (int i = 0; i < int(game.players.size()); ++i) {
+        const Player &p = game.players[i];
+        if (!present.insert(p.name).second) continue;   // a repeated name is one player to peers
+        std::optional<GrimoireReplica::SeatState> seat = state.seatOf(p.name);
+        if (!seat || seat->character != p.character.id || seat->position != i)
+            send(state.seat(p.name, p.character.id, i));
+    }
+    for (const GrimoireReplica::SeatState &seat : state.seating())
+        if (!present.count(seat.player)) send(state.seat(seat.player, seat.character, seat.position, false));
+}
+
+void GrimoireSync::publishEffects(int seat) {
+    if (seat < 0 || seat >= int(game.players.size())) return;
+    const Player &p = game.players[seat];
+    for (auto &kv : p.effects)
+        if (kv.second != state.hasEffect(p.name, kv.first)) send(state.setEffect(p.name, kv.first, kv.second));
+    for (const QString &effect : state.effectsOf(p.name))
+        if (!game.hasEffect(seat, effect)) send(state.setEffect(p.name, effect, false));
+}
+
+void GrimoireSync::publishDay() {
+    if (game.day > state.day()) send(state.setDay(game.day));
+}
+
+// ---------- Peer edits ----------
+std::vector<SyncOp> GrimoireSync::receive(const SyncOp &op) {
+    std::vector<SyncOp> done = state.receive(op);
+    if (done.empty()) return done;
+
+    applying = true;
+    bool seating = std::any_of(done.begin(), done.end(), [](const SyncOp &o) { return o.kind == SyncOp::Seat; });
+    if (seating) applySeating();
+    for (const SyncOp &o : done) {
+        if (o.kind != SyncOp::Effect) continue;
+        auto p = std::find_if(game.players.begin(), game.players.end(), [&o](const Player &pl) { return pl.name == o.player; });
+        if (p == game.players.end()) continue;
+        int seat = int(p - game.players.begin());
+        bool on = state.hasEffect(o.player, o.effect);   // o may have lost to a later write
+        if (game.hasEffect(seat, o.effect) != on) game.setEffect(seat, o.effect, on);
+    }
+    while (game.day < state.day()) game.advanceDay();
+    applying = false;
+    return done;
+}
+
+// Moves the players to the replica's seating, keeping each player's own
+// state where they were already seated, then brings characters and effects
+// in line through the game's API
+void GrimoireSync::applySeating() {
+    std::vector<GrimoireReplica::SeatState> seats = state.seating();
+    bool same = seats.size() == game.players.size();
+    for (size_t i = 0; same && i < seats.size(); ++i)
+        same = game.players[i].name == seats[i].player && game.players[i].character.id == seats[i].character;
+    if (same) return;
+
+    std::vector<Player> seated;
+    seated.reserve(seats.size());
+    std::vector<int> newSeat(game.players.size(), -1);
+    for (const GrimoireReplica::SeatState &s : seats) {
+        auto old = std::find_if(game.players.begin(), game.players.end(), [&s](const Player &p) { return p.name == s.player; });
+        Player p;
+        if (old != game.players.end()) {
+            newSeat[old - game.players.begin()] = int(seated.size());
+            p = std::move(*old);
+            old->name.clear();   // taken
+        } else {
+            // Someone new is read from `players` by remapSeats()
+            p.name = s.player;
+            auto c = game.characterDB().find(s.character);
+            p.character = c != game.characterDB().end() ? c->second : Character{};
+            p.character.id = s.character;
+            p.team = p.character.team;
+            p.effects = game.init_effects;
+            for (auto &kv : p.effects) kv.second = state.hasEffect(p.name, kv.first);
+            for (const QString &effect : state.effectsOf(p.name)) p.effects[effect] = true;
+        }
+        seated.push_back(std::move(p));
+    }
+    game.players = std::move(seated);
+    game.remapSeats(newSeat);
+
+    for (int i = 0; i < int(seats.size()); ++i) {
+        const QString &name = seats[i].player;
+        if (game.players[i].character.id != seats[i].character) game.setCharacter(i, seats[i].character);
+        std::vector<QString> stale;
+        for (auto &kv : game.players[i].effects)
+            if (kv.second && !state.hasEffect(name, kv.first)) stale.push_back(kv.first);
+        for (const QString &effect : stale) game.setEffect(i, effect, false);
+        for (const QString &effect : state.effectsOf(name))
+            if (!game.hasEffect(i, effect)) game.setEffect(i, effect, true);
+    }
+}
+
+bool GrimoireSync::inStep() const {
+    std::vector<GrimoireReplica::SeatState> seats = state.seating();
+    if (seats.size() != game.players.size() || game.day != state.day()) return false;
+    for (int i = 0; i < int(seats.size()); ++i) {
+        const Player &p = game.players[i];
+        if (p.name != seats[i].player || p.character.id != seats[i].character) return false;
+        std::vector<QString> on;
+        for (auto &kv : p.effects)
+            if (kv.second) on.push_back(kv.first);
+        std::sort(on.begin(), on.end());
+        if (on != state.effectsOf(p.name)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <QString>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "GameState.h"
+
+// ---------- Sync operations ----------
+// One edit to a shared grimoire. Every edit is a write to a register: a
+// player's seat, one effect on one player, or the day. A write wins over
+// another to the same register when its (lamport, origin) stamp is larger,
+// so replicas may apply the same operations in any order and still agree.
+// Kill / revive is the "Dead" effect, as in GameState.
+struct SyncOp {
+    enum Kind : std::uint8_t { Seat, Effect, Day };
+
+    std::uint64_t origin = 0;    // replica that made it
+    std::uint64_t counter = 0;   // its n-th operation, from 1
+    std::uint64_t lamport = 0;
+    Kind kind = Seat;
+    QString player;              // Seat, Effect: players are known by name
+    QString character;           // Seat: character id, empty if not dealt
+    double position = 0;         // Seat: place around the circle
+    bool on = true;              // Seat: seated rather than gone; Effect: set
+    QString effect;              // Effect
+    int day = 1;                 // Day: the day only moves forward
+
+    nlohmann::json toJson() const;
+    static std::optional<SyncOp> fromJson(const nlohmann::json &j);
+};
+
+// Operations seen from each replica: origin -> highest counter
+using VectorClock = std::map<std::uint64_t, std::uint64_t>;
+
+// ---------- Grimoire replica ----------
+// The shared grimoire as last-writer-wins registers, with the log of every
+// operation applied. Operations are applied in each origin's order: one
+// that arrives ahead of an earlier one from the same origin waits for it,
+// so the vector clock always summarises exactly what is in the log, and
+// missing() is the delta a peer with a given clock needs.
+class GrimoireReplica {
+public:
+    explicit GrimoireReplica(std::uint64_t id);
+
+    std::uint64_t id() const { return self; }
+    const VectorClock &clock() const { return seen; }
+    const std::vector<SyncOp> &log() const { return applied; }
+
+    // Local edits: applied here, returned for sending
+    SyncOp seat(const QString &player, const QString &character, double position, bool seated = true);
+    SyncOp setEffect(const QString &player, const QString &effect, bool on);
+    SyncOp setDay(int day);
+
+    // An operation from a peer. Returns those applied as a result, in
+    // order: none for one already seen or still waiting on an earlier one.
+    std::vector<SyncOp> receive(const SyncOp &op);
+    std::vector<SyncOp> missing(const VectorClock &peer) const;
+
+    // ---------- Materialised grimoire ----------
+    struct SeatState {
+        QString player;
+        QString character;
+        double position = 0;
+    };
+    std::vector<SeatState> seating() const;   // by position, then name
+    std::optional<SeatState> seatOf(const QString &player) const;
+    bool hasEffect(const QString &player, const QString &effect) const;
+    std::vector<QString> effectsOf(const QString &player) const;
+    int day() const { return currentDay; }
+    // Equal on replicas that hold the same grimoire
+    std::uint64_t digest() const;
+
+private:
+    struct Stamp {
+        std::uint64_t lamport = 0;
+        std::uint64_t origin = 0;
+        bool operator<(const Stamp &o) const { return lamport != o.lamport ? lamport < o.lamport : origin < o.origin; }
+    };
+    struct PlayerRegs {
+        Stamp seatStamp;
+        bool seated = false;
+        QString character;
+        double position = 0;
+        std::unordered_map<QString, std::pair<Stamp, bool>> effects;
+    };
+
+    SyncOp local(SyncOp op);
+    void apply(const SyncOp &op);
+
+    std::uint64_t self;
+    std::uint64_t lamport = 0;
+    VectorClock seen;
+    std::vector<SyncOp> applied;
+    std::map<std::pair<std::uint64_t, std::uint64_t>, SyncOp> early;   // (origin, counter)
+    std::unordered_map<QString, PlayerRegs> players;
+    int currentDay = 1;
+};
+
+// ---------- Grimoire sync ----------
+// Keeps a GameState and a replica in step. Local edits reach it as change
+// events, whatever made them (the window, automation, a night step); the
+// game is compared with the replica and the differences become operations
+// for `send`. Operations from peers go to receive(), which updates the game
+// through its own API so trackers and views follow.
+//
+// Reseating from a peer moves the players through GameState::remapSeats(),
+// so timed reminders and who applied each effect go with them; characters
+// and effects that differ then go through setCharacter() and setEffect().
+// The day only moves forward, so a new game needs a new sync session.
+class GrimoireSync {
+public:
+    using Sender = std::function<void(const SyncOp &op)>;
+
+    // The game must outlive the sync. The game's current grimoire is
+    // published as the replica's first operations.
+    GrimoireSync(GameState &game, std::uint64_t id);
+    ~GrimoireSync();
+
+    void setSender(Sender sender);
+    const GrimoireReplica &replica() const { return state; }
+
+    // Returns the operations newly applied, e.g. to forward to other peers
+    std::vector<SyncOp> receive(const SyncOp &op);
+    // Whether the game shows exactly the replica's grimoire
+    bool inStep() const;
+
+private:
+    void changed(const GameChange &change);
+    void send(const SyncOp &op);
+    void publishSeating();
+    void publishEffects(int seat);
+    void publishDay();
+    void applySeating();
+
+    GameState &game;
+    GrimoireReplica state;
+    Sender sender;                // ops made before there is one reach peers as missing()
+    int listener = -1;
+    bool applying = false;
+};
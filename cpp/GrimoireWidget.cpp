@@ -0,0 +1,219 @@
+#include "GrimoireWidget.h"
+#include "IconCache.h"
+#include "TokenSprites.h"
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <algorithm>
+#include <cmath>
+
+GrimoireWidget::GrimoireWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setMouseTracking(true);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    // Real art replaces the placeholder as soon as it has been decoded
+    connect(&IconCache::instance(), &IconCache::iconReady, this, [this](const QString &name) {
+        for (auto &s : seats)
+            if (s.characterName == name) { update(); return; }
+    });
+}
+
+void GrimoireWidget::setSeats(std::vector<SeatView> newSeats) {
+    seats = std::move(newSeats);
+    relayout();
+    update();
+}
+
+void GrimoireWidget::setSelectedSeat(int seat) {
+    if (selectedSeat == seat) return;
+    selectedSeat = seat;
+    update();
+}
+
+void GrimoireWidget::setBackground(const QString &path) {
+    backgroundPath = path;
+    renderBackground();
+    update();
+}
+
+void GrimoireWidget::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    renderBackground();
+    relayout();
+}
+
+void GrimoireWidget::renderBackground() {
+    backgroundPixmap = TokenSprites::instance().background(backgroundPath, size(), devicePixelRatioF());
+}
+
+// ---------- Layout ----------
+// Radius based on number of players and window size
+int GrimoireWidget::circleRadius(int seats, const QSize &area) {
+    int maxRadius = std::min(area.width(), area.height()) / 2 - 80;
+    return std::clamp(150 + (seats - 1) * 20, 150, std::max(150, maxRadius));
+}
+
+QRect GrimoireWidget::seatRect(int seat, int seats, const QSize &area) {
+    int radius = circleRadius(seats, area);
+    double angle = 2 * M_PI * seat / seats;
+    int x = area.width() / 2 + radius * std::cos(angle) - seatSize / 2;
+    int y = area.height() / 2 + radius * std::sin(angle) - seatSize / 2;
+    return QRect(x, y, seatSize, seatSize);
+}
+
+void GrimoireWidget::relayout() {
+    items.clear();
+    hovered = -1;
+
+    int n = seats.size();
+    if (n == 0) return;
+
+    QPoint center(width() / 2, height() / 2);
+    int radius = circleRadius(n, size());
+
+    for (int i = 0; i < n; ++i) {
+        double angle = 2 * M_PI * i / n;
+        double c = std::cos(angle), s = std::sin(angle);
+        items.push_back({seatRect(i, n, size()), HitKind::Seat, i, -1});
+
+        // Status circle, then effects going inward toward the centre
+        auto inner = [&](int step) {
+            double d = 0.78 * radius - step * effectSpacing;
+            return QRect(int(center.x() + d * c - effectCircleSize / 2),
+                         int(center.y() + d * s - effectCircleSize / 2),
+                         effectCircleSize, effectCircleSize);
+        };
+        items.push_back({inner(1), HitKind::Status, i, -1});
+        for (int e = 0; e < int(seats[i].effects.size()); ++e)
+            items.push_back({inner(e + 2), HitKind::Effect, i, e});
+    }
+}
+
+bool GrimoireWidget::isSelectedNeighbour(int seat) const {
+    if (selectedSeat < 0 || selectedSeat >= int(seats.size())) return false;
+    const SeatView &s = seats[selectedSeat];
+    return seat == s.leftNeighbour || seat == s.rightNeighbour;
+}
+
+int GrimoireWidget::hitTest(const QPoint &pos) const {
+    for (int k = int(items.size()) - 1; k >= 0; --k) {
+        const QRect &r = items[k].rect;
+        QPointF d = pos - QRectF(r).center();
+        double rad = r.width() / 2.0;
+        if (d.x() * d.x() + d.y() * d.y() <= rad * rad) return k;
+    }
+    return -1;
+}
+
+// ---------- Painting ----------
+void GrimoireWidget::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+    qreal dpr = devicePixelRatioF();
+
+    if (backgroundPixmap.isNull())
+        painter.fillRect(event->rect(), palette().window());
+    else
+        painter.drawPixmap(event->rect(), backgroundPixmap, QRectF(QPointF(event->rect().topLeft()) * dpr,
+                                                                   QSizeF(event->rect().size()) * dpr));
+
+    TokenSprites &sprites = TokenSprites::instance();
+    for (int k = 0; k < int(items.size()); ++k) {
+        const HitItem &item = items[k];
+        if (!item.rect.intersects(event->rect().adjusted(-40, -40, 40, 40))) continue;
+
+        const SeatView &s = seats[item.seat];
+        TokenSprites::State state = k == hovered ? TokenSprites::Hover : TokenSprites::Normal;
+
+        switch (item.kind) {
+        case HitKind::Seat:
+            if (item.seat == selectedSeat) state = TokenSprites::Selected;
+            else if (isSelectedNeighbour(item.seat)) state = TokenSprites::Hover;   // who an Empath there would read
+            painter.drawPixmap(item.rect.topLeft(),
+                               sprites.seat(s.characterName, s.team, seatSize, dpr, state));
+            painter.drawPixmap(item.rect.left(), item.rect.bottom() + 3,
+                               sprites.label(s.playerName + "\n" + s.characterName, seatSize, 30, dpr));
+            break;
+        case HitKind::Status: {
+            // A living player whose ability is off shows that instead of "Alive"
+            const char *label = s.dead ? "Dead" : s.abilityActive ? "Alive" : "No Ability";
+            const char *color = s.dead ? "red" : s.abilityActive ? "limegreen" : "gray";
+            painter.drawPixmap(item.rect.topLeft(),
+                               sprites.disc(label, QColor(color), effectCircleSize, dpr, state));
+            break;
+        }
+        case HitKind::Effect: {
+            const QString &effect = s.effects[item.effect];
+            painter.drawPixmap(item.rect.topLeft(),
+                               sprites.disc(effect, TokenSprites::reminderColor(effect),
+                                            effectCircleSize, dpr, state));
+            break;
+        }
+        }
+    }
+}
+
+// ---------- Interaction ----------
+void GrimoireWidget::mouseMoveEvent(QMouseEvent *event) {
+    int hit = hitTest(event->pos());
+    if (hit == hovered) return;
+
+    // Only the two tokens whose hover state changed are repainted
+    if (hovered >= 0) update(items[hovered].rect.adjusted(-2, -2, 2, 2));
+    hovered = hit;
+    if (hovered >= 0) update(items[hovered].rect.adjusted(-2, -2, 2, 2));
+    setCursor(hovered >= 0 ? Qt::PointingHandCursor : Qt::ArrowCursor);
+}
+
+void GrimoireWidget::leaveEvent(QEvent *event) {
+    QWidget::leaveEvent(event);
+    if (hovered >= 0) update(items[hovered].rect.adjusted(-2, -2, 2, 2));
+    hovered = -1;
+}
+
+void GrimoireWidget::mousePressEvent(QMouseEvent *event) {
+    if (event->button() != Qt::LeftButton) return;
+    int hit = hitTest(event->pos());
+    if (hit < 0) return;
+
+    HitItem item = items[hit];
+    switch (item.kind) {
+    case HitKind::Seat:
+        emit seatClicked(item.seat, mapToGlobal(QPoint(item.rect.left(), item.rect.bottom())));
+        break;
+    case HitKind::Status:
+        emit statusClicked(item.seat);
+        break;
+    case HitKind::Effect:
+        emit effectClicked(item.seat, seats[item.seat].effects[item.effect]);
+        break;
+    }
+}
+
+bool GrimoireWidget::event(QEvent *event) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 6, 0)
+    if (event->type() == QEvent::DevicePixelRatioChange) renderBackground();
+#endif
+    if (event->type() == QEvent::ToolTip) {
+        auto *help = static_cast<QHelpEvent *>(event);
+        int hit = hitTest(help->pos());
+        if (hit < 0) {
+            QToolTip::hideText();
+            event->ignore();
+            return true;
+        }
+        const HitItem &item = items[hit];
+        const SeatView &s = seats[item.seat];
+        QString tip;
+        switch (item.kind) {
+        case HitKind::Seat: tip = s.tooltip; break;
+        case HitKind::Status: tip = s.status; break;
+        case HitKind::Effect: tip = QString("Click to remove '%1'").arg(s.effects[item.effect]); break;
+        }
+        QToolTip::showText(help->globalPos(), tip, this, item.rect);
+        return true;
+    }
+    return QWidget::event(event);
+}
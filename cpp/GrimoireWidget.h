@@ -0,0 +1,76 @@
+#pragma once
+#include <QPixmap>
+#include <QWidget>
+#include <vector>
+
+// ---------- Seat view ----------
+// What the grimoire needs to draw one seat; built by StorytellerWindow.
+struct SeatView {
+    QString playerName;
+    QString characterName;
+    QString team;
+    QString tooltip;
+    QString status;
+    bool dead = false;
+    bool abilityActive = true;    // see GameState::abilityActive
+    int leftNeighbour = -1;       // nearest living seats, see GameState::seatRing
+    int rightNeighbour = -1;
+    std::vector<QString> effects; // active effects except "Dead"
+};
+
+// ---------- Grimoire widget ----------
+// Draws the players circle from cached token sprites and does its own hit
+// testing, instead of creating a stylesheeted button per token.
+class GrimoireWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit GrimoireWidget(QWidget *parent = nullptr);
+
+    void setSeats(std::vector<SeatView> seats);
+    void setBackground(const QString &path);
+    const QString &background() const { return backgroundPath; }
+    void setSelectedSeat(int seat);
+
+    static constexpr int seatSize = 90;
+    static constexpr int effectCircleSize = 45;
+    static constexpr int effectSpacing = 45;
+
+    // The players circle for `seats` seats in a widget of `area`, shared
+    // with the town square so both screens put everyone in the same place
+    static int circleRadius(int seats, const QSize &area);
+    static QRect seatRect(int seat, int seats, const QSize &area);
+
+signals:
+    void seatClicked(int seat, const QPoint &globalPos);
+    void statusClicked(int seat);
+    void effectClicked(int seat, const QString &effect);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+    bool event(QEvent *event) override;
+
+private:
+    enum class HitKind { Seat, Status, Effect };
+    struct HitItem {
+        QRect rect;
+        HitKind kind;
+        int seat;
+        int effect; // index into SeatView::effects, -1 otherwise
+    };
+
+    void relayout();
+    void renderBackground();   // on resize, dpr or path changes, never per paint
+    int hitTest(const QPoint &pos) const;
+    bool isSelectedNeighbour(int seat) const;
+
+    std::vector<SeatView> seats;
+    std::vector<HitItem> items; // in paint order; later items are on top
+    QString backgroundPath;
+    QPixmap backgroundPixmap;   // at size() and the widget's dpr
+    int hovered = -1;
+    int selectedSeat = -1;
+};
@@ -0,0 +1,133 @@
+#include "IconCache.h"
+#include "ThumbnailCache.h"
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+#include <QThread>
+#include <algorithm>
+
+// Generation 0 is used for on-demand decodes, which are never cancelled
+static constexpr quint64 kOnDemand = 0;
+
+IconCache &IconCache::instance() {
+    // Owned by the application so pixmaps are released before the GUI goes away
+    static IconCache *cache = new IconCache(qApp);
+    return *cache;
+}
+
+IconCache::IconCache(QObject *parent)
+    : QObject(parent)
+{
+    cache.setMaxCost(64 * 1024); // 64 MB of decoded pixmaps
+    pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+IconCache::~IconCache() {
+    cancelPrefetch();
+    pool.clear();
+    pool.waitForDone();
+}
+
+QString IconCache::iconPath(const QString &characterName) {
+    return QString("../../Resources/botc_icons/%1.png").arg(characterName);
+}
+
+QString IconCache::key(const QString &characterName, int size) {
+    return characterName + '@' + QString::number(size);
+}
+
+bool IconCache::contains(const QString &characterName, int size) const {
+    return cache.contains(key(characterName, size));
+}
+
+QPixmap IconCache::pixmap(const QString &characterName, const QString &team, int size) {
+    QString k = key(characterName, size);
+    if (QPixmap *pm = cache.object(k)) return *pm;
+
+    if (!missing.contains(k)) requestDecode(characterName, size, kOnDemand);
+    return placeholder(team, size);
+}
+
+void IconCache::prefetch(const std::vector<Character> &characters, const std::vector<int> &sizes) {
+    cancelPrefetch();
+    quint64 generation = prefetchGeneration.load();
+    for (auto &c : characters)
+        for (int size : sizes)
+            requestDecode(c.name, size, generation);
+}
+
+void IconCache::cancelPrefetch() {
+    // Queued prefetch jobs see the new generation and return without decoding
+    prefetchGeneration.fetch_add(1);
+}
+
+void IconCache::requestDecode(const QString &characterName, int size, quint64 generation) {
+    QString k = key(characterName, size);
+    if (missing.contains(k) || cache.contains(k)) return;
+    // A job from a cancelled prefetch is about to drop out, so a key it
+    // still holds is queued again; any other pending job will deliver
+    auto it = pending.constFind(k);
+    if (it != pending.constEnd() && (it.value() == kOnDemand || it.value() == prefetchGeneration.load())) return;
+    pending.insert(k, generation);
+
+    qreal dpr = qApp ? qApp->devicePixelRatio() : 1.0;
+    QString path = iconPath(characterName);
+
+    pool.start([this, characterName, size, dpr, path, generation]() {
+        QImage img;
+        if (generation == kOnDemand || generation == prefetchGeneration.load()) {
+            // QImage is safe to decode and scale off the UI thread; the disk
+            // cache hands back a pre-scaled, pre-circled copy after the first run
+            img = ThumbnailCache::instance().load(path, QSize(size, size), dpr,
+                                                  ThumbnailCache::Circle);
+        } else {
+            // Cancelled: let the UI thread drop the pending entry, unless a
+            // newer request has taken it over
+            QMetaObject::invokeMethod(this, [this, characterName, size, generation]() {
+                auto it = pending.find(key(characterName, size));
+                if (it != pending.end() && it.value() == generation) pending.erase(it);
+            }, Qt::QueuedConnection);
+            return;
+        }
+        QMetaObject::invokeMethod(this, [this, characterName, size, img]() {
+            onDecoded(characterName, size, img);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void IconCache::onDecoded(const QString &characterName, int size, const QImage &img) {
+    QString k = key(characterName, size);
+    pending.remove(k);
+
+    if (img.isNull()) {
+        missing.insert(k);
+        return;
+    }
+
+    // QPixmap must be created on the UI thread
+    QPixmap *pm = new QPixmap(QPixmap::fromImage(img));
+    int costKB = std::max<qsizetype>(1, img.sizeInBytes() / 1024);
+    cache.insert(k, pm, costKB);
+    emit iconReady(characterName);
+}
+
+QPixmap IconCache::placeholder(const QString &team, int size) {
+    QString k = team + '@' + QString::number(size);
+    auto it = placeholders.find(k);
+    if (it != placeholders.end()) return *it;
+
+    qreal dpr = qApp ? qApp->devicePixelRatio() : 1.0;
+    QPixmap pm(qRound(size * dpr), qRound(size * dpr));
+    pm.setDevicePixelRatio(dpr);
+    pm.fill(Qt::transparent);
+
+    QPainter painter(&pm);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(StorytellerWindow::colors.value(team, "gray")));
+    painter.drawEllipse(QRectF(0, 0, size, size));
+    painter.end();
+
+    placeholders.insert(k, pm);
+    return pm;
+}
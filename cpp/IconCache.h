@@ -0,0 +1,54 @@
+#pragma once
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QPixmap>
+#include <QSet>
+#include <QThreadPool>
+#include <atomic>
+#include <vector>
+#include "storyteller.h" // for Character, StorytellerWindow::colors
+
+// ---------- Icon cache ----------
+// Character art is decoded to QImage on a worker pool and turned into a
+// QPixmap on the UI thread. Until then callers get a team-coloured
+// placeholder and iconReady() fires once the real icon is available.
+// Decoded pixmaps live in an LRU cache bounded by memory cost.
+class IconCache : public QObject {
+    Q_OBJECT
+public:
+    static IconCache &instance();
+
+    static QString iconPath(const QString &characterName);
+
+    // Decoded icon at the given logical size, or a placeholder while it loads
+    QPixmap pixmap(const QString &characterName, const QString &team, int size);
+    bool contains(const QString &characterName, int size) const;
+
+    // Decode every character of a script in the background. A new call
+    // cancels whatever is left of the previous prefetch.
+    void prefetch(const std::vector<Character> &characters, const std::vector<int> &sizes);
+    void cancelPrefetch();
+
+    void setMaxCostKB(int kb) { cache.setMaxCost(kb); }
+    int maxCostKB() const { return cache.maxCost(); }
+
+signals:
+    void iconReady(const QString &characterName);
+
+private:
+    explicit IconCache(QObject *parent = nullptr);
+    ~IconCache() override;
+
+    static QString key(const QString &characterName, int size);
+    void requestDecode(const QString &characterName, int size, quint64 generation);
+    void onDecoded(const QString &characterName, int size, const QImage &img);
+    QPixmap placeholder(const QString &team, int size);
+
+    QCache<QString, QPixmap> cache;           // cost in KB
+    QHash<QString, QPixmap> placeholders;     // one per team and size
+    QHash<QString, quint64> pending;          // keys queued or decoding -> generation of the latest job
+    QSet<QString> missing;                    // keys whose source failed to load
+    QThreadPool pool;
+    std::atomic<quint64> prefetchGeneration{1};
+};
@@ -0,0 +1,196 @@
+#include "InfoGenerator.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+static inline std::uint64_t seatBit(int s) { return std::uint64_t(1) << s; }
+static inline int popCount(std::uint64_t bits) { return int(qPopulationCount(quint64(bits))); }
+
+static bool isPingRole(const QString &role) {
+    return role == "washerwoman" || role == "librarian" || role == "investigator";
+}
+
+// The team a ping role shows a character from
+static QString pingTeam(const QString &role) {
+    if (role == "washerwoman") return "townsfolk";
+    if (role == "librarian") return "outsider";
+    return "minion";
+}
+
+InfoGenerator::InfoGenerator(const GameState &state)
+    : state(state),
+      n(int(state.players.size())),
+      night(state.currentNight())
+{
+    all = n == 64 ? ~std::uint64_t(0) : seatBit(n) - 1;
+    for (int i = 0; i < n; ++i) {
+        const Player &p = state.players[i];
+        std::uint64_t bit = seatBit(i);
+        const QString &team = p.character.team;
+        if (team == "minion" || team == "demon") evil |= bit;
+        if (team == "demon") demons |= bit;
+        if (team == "outsider") outsiders |= bit;
+        if (p.character.id == "spy") spies |= bit;
+        if (p.character.id == "recluse") recluses |= bit;
+        if (state.hasEffect(i, "Red Herring")) herrings |= bit;
+    }
+}
+
+bool InfoGenerator::supports(const QString &role) {
+    return isPingRole(role) || role == "chef" || role == "empath" || role == "fortuneteller";
+}
+
+QString InfoGenerator::roleFor(int seat) const {
+    const Player &p = state.players[seat];
+    return p.character.id == "drunk" ? p.claim : p.character.id;
+}
+
+// The Drunk, or poisoned / drunk by someone whose ability still holds
+bool InfoGenerator::impaired(int seat) const {
+    return !state.abilityActive(seat);
+}
+
+// ---------- Ring queries ----------
+// Whether `number` evil players (or adjacent evil pairs) among `seats` is
+// possible for some Spy / Recluse registration
+bool InfoGenerator::countPossible(std::uint64_t seats, int number, bool pairs) const {
+    std::uint64_t fixed = evil & ~spies;
+    std::uint64_t flex = spies | recluses;
+    std::uint64_t sub = flex;
+    for (;;) {
+        std::uint64_t e = fixed | sub;
+        int count = pairs ? popCount(e & (((e >> 1) | (e << (n - 1))) & all)) // seat i+1 onto seat i
+                          : popCount(e & seats);
+        if (count == number) return true;
+        if (!sub) return false;
+        sub = (sub - 1) & flex;
+    }
+}
+
+bool InfoGenerator::registersAs(int seat, const QString &characterId) const {
+    if (state.players[seat].character.id == characterId) return true;
+    auto it = state.characterDB().find(characterId);
+    if (it == state.characterDB().end()) return false;
+    const QString &team = it->second.team;
+    if ((spies & seatBit(seat)) && (team == "townsfolk" || team == "outsider")) return true;
+    if ((recluses & seatBit(seat)) && (team == "minion" || team == "demon")) return true;
+    return false;
+}
+
+// ---------- Outputs ----------
+std::vector<InfoRecord> InfoGenerator::outputs(int seat) const {
+    std::vector<InfoRecord> out;
+    if (seat < 0 || seat >= n) return out;
+    QString role = roleFor(seat);
+    if (!supports(role)) return out;
+
+    InfoRecord base;
+    base.seat = seat;
+    base.night = night;
+    base.role = role;
+
+    if (isPingRole(role)) {
+        QString team = pingTeam(role);
+        for (auto &c : state.scriptCharacters()) {
+            if (c.team != team) continue;
+            for (int a = 0; a < n; ++a) {
+                if (a == seat) continue;
+                for (int b = a + 1; b < n; ++b) {
+                    if (b == seat) continue;
+                    InfoRecord r = base;
+                    r.seats = {a, b};
+                    r.character = c.id;
+                    out.push_back(r);
+                }
+            }
+        }
+        if (role == "librarian") out.push_back(base); // "zero Outsiders are in play"
+    } else if (role == "chef") {
+        for (int k = 0; k <= n / 2; ++k) {
+            InfoRecord r = base;
+            r.number = k;
+            out.push_back(r);
+        }
+    } else if (role == "empath") {
+        int left = state.aliveNeighbour(seat, false);
+        int right = state.aliveNeighbour(seat, true);
+        if (left >= 0) base.seats.push_back(left);
+        if (right >= 0 && right != left) base.seats.push_back(right);
+        for (int k = 0; k <= int(base.seats.size()); ++k) {
+            InfoRecord r = base;
+            r.number = k;
+            out.push_back(r);
+        }
+    } else if (role == "fortuneteller") {
+        for (int a = 0; a < n; ++a) {
+            for (int b = a + 1; b < n; ++b) {
+                for (bool yes : {true, false}) {
+                    InfoRecord r = base;
+                    r.seats = {a, b};
+                    r.yes = yes;
+                    out.push_back(r);
+                }
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<InfoRecord> InfoGenerator::trueInfo(int seat) const {
+    std::vector<InfoRecord> out;
+    for (auto &r : outputs(seat))
+        if (isTrue(r)) out.push_back(r);
+    return out;
+}
+
+std::vector<InfoRecord> InfoGenerator::falseInfo(int seat) const {
+    std::vector<InfoRecord> out;
+    for (auto &r : outputs(seat))
+        if (!isTrue(r)) out.push_back(r);
+    return out;
+}
+
+bool InfoGenerator::isTrue(const InfoRecord &r) const {
+    std::uint64_t seats = 0;
+    for (int s : r.seats) {
+        if (s < 0 || s >= n) return false;
+        seats |= seatBit(s);
+    }
+
+    if (isPingRole(r.role)) {
+        if (r.seats.empty()) return r.role == "librarian" && !(outsiders & ~recluses);
+        for (int s : r.seats)
+            if (registersAs(s, r.character)) return true;
+        return false;
+    }
+    if (r.role == "chef") return countPossible(all, r.number, true);
+    if (r.role == "empath") return countPossible(seats, r.number, false);
+    if (r.role == "fortuneteller") {
+        std::uint64_t registersDemon = demons | herrings;
+        if (r.yes) return seats & (registersDemon | recluses);
+        return !(seats & registersDemon);
+    }
+    return false;
+}
+
+// ---------- Text ----------
+QString InfoGenerator::characterName(const QString &id) const {
+    auto it = state.characterDB().find(id);
+    return it == state.characterDB().end() ? id : it->second.name;
+}
+
+QString InfoGenerator::describe(const InfoRecord &r) const {
+    auto name = [this](int s) {
+        return s >= 0 && s < int(state.players.size()) ? state.players[s].name : QString("?");
+    };
+
+    if (isPingRole(r.role)) {
+        if (r.seats.empty()) return "Zero Outsiders are in play";
+        if (r.seats.size() == 1) return QString("%1 is the %2").arg(name(r.seats[0]), characterName(r.character));
+        return QString("One of %1 or %2 is the %3").arg(name(r.seats[0]), name(r.seats[1]), characterName(r.character));
+    }
+    if (r.role == "chef") return QString("%1 pair(s) of evil players").arg(r.number);
+    if (r.role == "empath") return QString("%1 of your alive neighbours are evil").arg(r.number);
+    if (r.role == "fortuneteller" && r.seats.size() == 2)
+        return QString("%1 or %2: %3").arg(name(r.seats[0]), name(r.seats[1]), r.yes ? "Yes" : "No");
+    return characterName(r.role);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <QString>
+#include <cstdint>
+#include <vector>
+#include "GameState.h"
+
+// ---------- Info generator ----------
+// Works out what a Washerwoman, Librarian, Investigator, Chef, Empath or
+// Fortune Teller can be told from the current grimoire. Seat sets are
+// bitmasks (bit i = seat i, up to SeatRing::MaxSeats), so every query is a
+// few mask operations; living neighbours come from GameState::seatRing(). The Spy and the Recluse may register either way, so "true" means true
+// under some registration.
+class InfoGenerator {
+public:
+    explicit InfoGenerator(const GameState &state);
+
+    static bool supports(const QString &role);
+
+    // The ability the player at `seat` uses: their character, or their claim
+    // if they are the Drunk
+    QString roleFor(int seat) const;
+
+    // Whether the player's info is unreliable tonight (Drunk or poisoned)
+    bool impaired(int seat) const;
+
+    // Every output of the right shape for the seat's ability tonight, and the
+    // subsets that are true / false
+    std::vector<InfoRecord> outputs(int seat) const;
+    std::vector<InfoRecord> trueInfo(int seat) const;
+    std::vector<InfoRecord> falseInfo(int seat) const;
+
+    bool isTrue(const InfoRecord &record) const;
+    QString describe(const InfoRecord &record) const;
+
+private:
+    bool registersAs(int seat, const QString &characterId) const;
+    bool countPossible(std::uint64_t seats, int number, bool pairs) const;
+    QString characterName(const QString &id) const;
+
+    const GameState &state;
+    int n = 0;
+    int night = 1;
+    std::uint64_t all = 0;
+    std::uint64_t evil = 0;
+    std::uint64_t demons = 0;
+    std::uint64_t outsiders = 0;
+    std::uint64_t spies = 0;       // evil, may register good
+    std::uint64_t recluses = 0;    // good, may register evil
+    std::uint64_t herrings = 0;    // Fortune Teller red herring
+};
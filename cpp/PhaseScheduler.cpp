@@ -0,0 +1,89 @@
+#include "PhaseScheduler.h"
+
+void PhaseScheduler::clear() {
+    for (auto &slot : wheel) slot.clear();
+    latest.clear();
+    generations = 0;
+    tick = 0;
+    last = Dusk;
+}
+
+int PhaseScheduler::effectId(const QString &effect) {
+    int id = names.indexOf(effect);
+    if (id >= 0) return id;
+    names << effect;
+    return int(names.size()) - 1;
+}
+
+// Dawns fall on odd ticks, dusks on even ones
+std::uint32_t PhaseScheduler::tickFor(Boundary at, int count) const {
+    std::uint32_t next = tick + 1;
+    if ((next & 1) != (at == Dawn ? 1u : 0u)) ++next;
+    return next + 2 * std::uint32_t(count > 1 ? count - 1 : 0);
+}
+
+void PhaseScheduler::schedule(int seat, int effect, std::uint32_t at, int then) {
+    if (at <= tick) return;
+    std::uint32_t generation = ++generations;
+    latest[key(seat, effect)] = generation;
+    wheel[at % Slots].push_back(Entry{at, generation, std::uint16_t(seat), std::uint16_t(effect), then});
+}
+
+void PhaseScheduler::schedule(int seat, const QString &effect, const Expiry &expiry) {
+    int then = expiry.then.isEmpty() ? -1 : effectId(expiry.then);
+    schedule(seat, effectId(effect), tickFor(expiry.at, expiry.count), then);
+}
+
+// The wheel entry stays and is skipped, like a superseded one
+void PhaseScheduler::cancel(int seat, const QString &effect) {
+    int id = names.indexOf(effect);
+    if (id >= 0) latest.erase(key(seat, id));
+}
+
+void PhaseScheduler::remap(const std::vector<int> &newSeat) {
+    auto moved = [&](int seat) { return seat < int(newSeat.size()) ? newSeat[seat] : -1; };
+    std::unordered_map<std::uint32_t, std::uint32_t> kept;
+    for (const auto &kv : latest) {
+        int to = moved(int(kv.first >> 16));
+        if (to >= 0) kept[key(to, int(kv.first & 0xffff))] = kv.second;
+    }
+    latest.swap(kept);
+    for (auto &slot : wheel) {
+        for (std::size_t i = 0; i < slot.size();) {
+            int to = moved(slot[i].seat);
+            if (to < 0) {
+                slot[i] = slot.back();
+                slot.pop_back();
+                continue;
+            }
+            slot[i].seat = std::uint16_t(to);
+            ++i;
+        }
+    }
+}
+
+bool PhaseScheduler::advance(Boundary boundary, std::vector<Due> &due) {
+    due.clear();
+    if (boundary == last) return false;
+    last = boundary;
+    ++tick;
+
+    // Entries a full turn or more ahead share the slot and stay put
+    std::vector<Entry> &slot = wheel[tick % Slots];
+    for (std::size_t i = 0; i < slot.size();) {
+        const Entry &e = slot[i];
+        if (e.tick != tick) { ++i; continue; }
+        auto it = latest.find(key(e.seat, e.effect));
+        if (it != latest.end() && it->second == e.generation) {
+            due.push_back(Due{e.seat, e.effect, e.then});
+            latest.erase(it);
+        }
+        slot[i] = slot.back();
+        slot.pop_back();
+    }
+    return true;
+}
+
+std::size_t PhaseScheduler::pending() const {
+    return latest.size();
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// ---------- Phase scheduler ----------
+// Timed reminders ("Poisoned until dusk", "Safe tonight", the Pukka's victim
+// dying a night later) on a timing wheel indexed by phase boundary. Ticks
+// count boundaries from the first night: dawns are odd, dusks even, so day N
+// ends at tick 2N. Each boundary only visits its own wheel slot, i.e. the
+// seats with something due, never the whole circle. Re-applying an effect
+// supersedes its earlier expiry. Reminders follow their players through
+// remap() when the circle is reseated.
+class PhaseScheduler {
+public:
+    enum Boundary { Dusk, Dawn };
+
+    // When a reminder ends, as given in the character data
+    struct Expiry {
+        Boundary at = Dusk;
+        int count = 1;           // the count-th such boundary from now
+        QString then;            // effect it turns into, if any
+    };
+
+    struct Due {
+        int seat = 0;
+        int effect = 0;          // effectName()
+        int then = -1;
+    };
+
+    void clear();                // back to the first night
+
+    int effectId(const QString &effect);
+    const QString &effectName(int id) const { return names[id]; }
+
+    std::uint32_t now() const { return tick; }
+    std::uint32_t tickFor(Boundary at, int count = 1) const;
+    static std::uint32_t endOfDay(int day) { return std::uint32_t(2 * day); }
+
+    void schedule(int seat, int effect, std::uint32_t at, int then = -1);
+    void schedule(int seat, const QString &effect, const Expiry &expiry);
+    // The effect was cleared before its time: nothing is due for it
+    void cancel(int seat, const QString &effect);
+    // Seat i's reminders move to newSeat[i]; -1 (or past the end) drops them
+    void remap(const std::vector<int> &newSeat);
+
+    // Moves to the next boundary and fills `due`; false (and nothing due)
+    // if the game is already past a boundary of that kind
+    bool advance(Boundary boundary, std::vector<Due> &due);
+
+    std::size_t pending() const;   // expiries still to come
+
+private:
+    static constexpr int Slots = 16;
+
+    struct Entry {
+        std::uint32_t tick;
+        std::uint32_t generation;
+        std::uint16_t seat;
+        std::uint16_t effect;
+        std::int32_t then;
+    };
+
+    static std::uint32_t key(int seat, int effect) { return std::uint32_t(seat) << 16 | std::uint32_t(effect); }
+
+    std::array<std::vector<Entry>, Slots> wheel;
+    std::unordered_map<std::uint32_t, std::uint32_t> latest;   // key -> generation in force
+    std::uint32_t generations = 0;
+    std::uint32_t tick = 0;
+    Boundary last = Dusk;        // the game starts at dusk of the first night
+    QStringList names;
+};
@@ -0,0 +1,393 @@
+#include "PlayerServer.h"
+#include "IconCache.h"
+#include "StallWatchdog.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QNetworkInterface>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrl>
+#include <QUrlQuery>
+#include <algorithm>
+
+using json = nlohmann::json;
+
+// The whole client: connects back to the server it came from and applies
+// what it is sent
+static const char *playerPage = R"(<!doctype html>
+<html><head><meta charset="utf-8"><meta name="viewport" content="width=device-width,initial-scale=1">
+<title>Blood on the Clocktower</title>
+<style>
+body{font-family:sans-serif;background:#111;color:#eee;text-align:center;margin:0;padding:1em}
+#token{width:60vw;max-width:240px;border-radius:50%;background:#333}
+.dead #token{filter:grayscale(1) brightness(.5)}
+#messages{text-align:left;max-width:30em;margin:1em auto}
+#messages p{background:#222;padding:.6em;border-radius:.4em;font-size:1.3em}
+#status{color:#999}
+</style></head><body>
+<div id="phase"></div><h1 id="name"></h1>
+<img id="token" alt=""><h2 id="character"></h2><p id="ability"></p>
+<p id="life"></p><div id="messages"></div><p id="status">Connecting...</p>
+<script>
+const token = new URLSearchParams(location.search).get("t");
+let view = {};
+function show() {
+  document.getElementById("name").textContent = view.name || "";
+  document.getElementById("phase").textContent = (view.night ? "Night " : "Day ") + (view.day || "");
+  document.getElementById("character").textContent = view.character || "";
+  document.getElementById("ability").textContent = view.ability || "";
+  const img = document.getElementById("token");
+  if (view.character && img.dataset.icon !== view.icon) { img.dataset.icon = view.icon; img.src = view.icon; }
+  img.style.visibility = view.character ? "visible" : "hidden";
+  document.body.className = view.alive === false ? "dead" : "";
+  document.getElementById("life").textContent = view.alive === false
+      ? (view.ghostVote ? "You are dead. You have one ghost vote." : "You are dead. Your ghost vote is spent.") : "";
+}
+function message(m) {
+  const p = document.createElement("p");
+  p.textContent = m.text;
+  document.getElementById("messages").prepend(p);
+}
+function connect() {
+  const ws = new WebSocket((location.protocol === "https:" ? "wss://" : "ws://") + location.host + "/ws?t=" + token);
+  ws.onopen = () => { document.getElementById("status").textContent = ""; };
+  ws.onmessage = (e) => {
+    const m = JSON.parse(e.data);
+    if (m.type === "state") {
+      view = m.state;
+      document.getElementById("messages").innerHTML = "";
+      m.messages.forEach(message);
+    } else if (m.type === "delta") {
+      Object.assign(view, m.set);
+    } else if (m.type === "message") {
+      message(m);
+    }
+    show();
+  };
+  ws.onclose = () => {
+    document.getElementById("status").textContent = "Reconnecting...";
+    setTimeout(connect, 2000);
+  };
+}
+connect();
+</script></body></html>
+)";
+
+static QByteArray httpResponse(const char *status, const char *type, const QByteArray &body) {
+    return QByteArray("HTTP/1.1 ") + status + "\r\nContent-Type: " + type
+        + "\r\nContent-Length: " + QByteArray::number(body.size())
+        + "\r\nCache-Control: no-store\r\nConnection: close\r\n\r\n" + body;
+}
+
+// A server frame: final, unmasked
+static QByteArray wsFrame(quint8 opcode, const QByteArray &payload) {
+    QByteArray frame;
+    frame.append(char(0x80 | opcode));
+    const quint64 n = quint64(payload.size());
+    if (n < 126) {
+        frame.append(char(n));
+    } else if (n < 65536) {
+        frame.append(char(126));
+        frame.append(char(n >> 8));
+        frame.append(char(n & 0xff));
+    } else {
+        frame.append(char(127));
+        for (int shift = 56; shift >= 0; shift -= 8) frame.append(char((n >> shift) & 0xff));
+    }
+    return frame + payload;
+}
+
+static QByteArray textFrame(const json &message) {
+    return wsFrame(0x1, QByteArray::fromStdString(message.dump()));
+}
+
+PlayerServer::PlayerServer(GameState &game, QObject *parent)
+    : QObject(parent), game(game)
+{
+    listener = game.addChangeListener([this](const GameChange &change) { changed(change); });
+}
+
+PlayerServer::~PlayerServer() {
+    game.removeChangeListener(listener);
+}
+
+bool PlayerServer::start(const QHostAddress &address, quint16 port) {
+    if (server) return true;
+    if (port == 0) port = quint16(qEnvironmentVariableIntValue("BOTC_PLAYER_PORT"));
+    if (port == 0) port = 8765;
+
+    server = new QTcpServer(this);
+    bool listening = server->listen(address, port);
+    if (!listening && server->serverError() == QAbstractSocket::AddressInUseError)
+        listening = server->listen(address, 0);
+    if (!listening) {
+        lastError = server->errorString();
+        delete server;
+        server = nullptr;
+        return false;
+    }
+    connect(server, &QTcpServer::newConnection, this, &PlayerServer::accept);
+    return true;
+}
+
+quint16 PlayerServer::port() const {
+    return server ? server->serverPort() : 0;
+}
+
+QString PlayerServer::lanAddress() {
+    for (const QHostAddress &a : QNetworkInterface::allAddresses())
+        if (a.protocol() == QAbstractSocket::IPv4Protocol && !a.isLoopback()) return a.toString();
+    return "127.0.0.1";
+}
+
+QString PlayerServer::tokenFor(int seat) {
+    if (seat < 0 || seat >= int(game.players.size())) return QString();
+    const QString &name = game.players[seat].name;
+    Feed &feed = feeds[name];
+    if (feed.token.isEmpty()) {
+        quint64 bits = QRandomGenerator::system()->generate64();
+        feed.token = QString::number(bits, 16);
+        names[feed.token] = name;
+    }
+    return feed.token;
+}
+
+QString PlayerServer::playerUrl(int seat, const QString &host) {
+    QString token = tokenFor(seat);
+    if (token.isEmpty()) return QString();
+    return QString("http://%1:%2/?t=%3").arg(host).arg(port()).arg(token);
+}
+
+int PlayerServer::phoneCount() const {
+    int n = 0;
+    for (auto &kv : feeds) n += int(kv.second.phones.size());
+    return n;
+}
+
+// ---------- Connections ----------
+void PlayerServer::accept() {
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        clients.push_back({socket, {}, {}});
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { read(socket); });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QObject::destroyed, this, [this, socket]() { closed(socket); });
+    }
+}
+
+void PlayerServer::closed(QTcpSocket *socket) {
+    auto client = std::find_if(clients.begin(), clients.end(), [socket](const Client &c) { return c.socket == socket; });
+    if (client == clients.end()) return;
+    auto feed = feeds.find(client->player);
+    if (feed != feeds.end()) {
+        auto &phones = feed->second.phones;
+        phones.erase(std::remove(phones.begin(), phones.end(), socket), phones.end());
+    }
+    clients.erase(client);
+}
+
+void PlayerServer::read(QTcpSocket *socket) {
+    StallWatchdog::ActionScope action("playerServer");
+    auto client = std::find_if(clients.begin(), clients.end(), [socket](const Client &c) { return c.socket == socket; });
+    if (client == clients.end()) return;
+    client->buffer += socket->readAll();
+    bool open = client->player.isEmpty() ? handleRequest(*client) : handleFrames(*client);
+    if (!open) socket->disconnectFromHost();
+}
+
+// ---------- HTTP ----------
+// Returns false once the connection is done with
+bool PlayerServer::handleRequest(Client &client) {
+    qsizetype end = client.buffer.indexOf("\r\n\r\n");
+    if (end < 0) {
+        if (client.buffer.size() <= MaxRequestBytes) return true;
+        client.socket->write(httpResponse("431 Request Header Fields Too Large", "text/plain", "Too large"));
+        return false;
+    }
+    QList<QByteArray> lines = client.buffer.left(end).split('\n');
+    client.buffer.remove(0, end + 4);
+
+    QList<QByteArray> request = lines.value(0).trimmed().split(' ');
+    if (request.size() < 2 || request[0] != "GET") {
+        client.socket->write(httpResponse("405 Method Not Allowed", "text/plain", "GET only"));
+        return false;
+    }
+    QHash<QByteArray, QByteArray> headers;
+    for (int i = 1; i < lines.size(); ++i) {
+        qsizetype colon = lines[i].indexOf(':');
+        if (colon > 0) headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+    }
+
+    QUrl url(QString::fromLatin1("http://phone" + request[1]));
+    QString token = QUrlQuery(url).queryItemValue("t");
+    auto player = names.find(token);
+    const QString path = url.path();
+
+    if (path == "/") {
+        client.socket->write(httpResponse("200 OK", "text/html; charset=utf-8", playerPage));
+        return false;
+    }
+    if (player == names.end()) {
+        client.socket->write(httpResponse("404 Not Found", "text/plain", "Unknown player link"));
+        return false;
+    }
+    if (path == "/icon") {
+        QByteArray png = iconFor(player->second);
+        client.socket->write(png.isEmpty() ? httpResponse("404 Not Found", "text/plain", "No icon")
+                                           : httpResponse("200 OK", "image/png", png));
+        return false;
+    }
+    if (path == "/ws" && headers.value("upgrade").toLower() == "websocket" && headers.contains("sec-websocket-key")) {
+        serveUpgrade(client, headers.value("sec-websocket-key"), player->second);
+        return handleFrames(client);   // a client may not wait for the answer
+    }
+    client.socket->write(httpResponse("404 Not Found", "text/plain", "Not found"));
+    return false;
+}
+
+QByteArray PlayerServer::iconFor(const QString &player) {
+    int seat = seatOf(player);
+    if (seat < 0 || game.players[seat].character.id == "drunk") return QByteArray();
+    QString path = IconCache::iconPath(game.players[seat].character.name);
+    auto it = icons.find(path);
+    if (it == icons.end()) {
+        QFile file(path);
+        it = icons.insert(path, file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray());
+    }
+    return *it;
+}
+
+// ---------- WebSocket ----------
+void PlayerServer::serveUpgrade(Client &client, const QByteArray &key, const QString &player) {
+    QByteArray accept = QCryptographicHash::hash(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11",
+                                                 QCryptographicHash::Sha1).toBase64();
+    client.socket->write("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                         "Sec-WebSocket-Accept: " + accept + "\r\n\r\n");
+    client.player = player;
+
+    Feed &feed = feeds[player];
+    feed.phones.push_back(client.socket);
+    // Other phones of this player already hold `sent`; a change since then
+    // is still queued for all of them, this one included
+    if (feed.phones.size() == 1 || feed.sent.is_null()) feed.sent = viewOf(player);
+    client.socket->write(textFrame({{"type", "state"}, {"state", feed.sent}, {"messages", feed.messages}}));
+}
+
+// Phones send nothing but control frames; returns false once closed
+bool PlayerServer::handleFrames(Client &client) {
+    QByteArray &buf = client.buffer;
+    while (buf.size() >= 2) {
+        const quint8 b0 = quint8(buf[0]), b1 = quint8(buf[1]);
+        const int opcode = b0 & 0x0f;
+        quint64 length = b1 & 0x7f;
+        qsizetype pos = 2;
+        if (length == 126) {
+            if (buf.size() < 4) return true;
+            length = quint64(quint8(buf[2])) << 8 | quint8(buf[3]);
+            pos = 4;
+        } else if (length == 127) {
+            if (buf.size() < 10) return true;
+            length = 0;
+            for (int i = 2; i < 10; ++i) length = length << 8 | quint8(buf[i]);
+            pos = 10;
+        }
+        if (length > quint64(MaxFrameBytes)) {
+            client.socket->write(wsFrame(0x8, QByteArray("\x03\xf1", 2)));   // 1009: too big
+            return false;
+        }
+        const bool masked = b1 & 0x80;
+        const qsizetype mask = pos;
+        if (masked) pos += 4;
+        if (buf.size() < pos + qsizetype(length)) return true;
+
+        QByteArray payload = buf.mid(pos, qsizetype(length));
+        if (masked)
+            for (qsizetype i = 0; i < payload.size(); ++i) payload[i] = char(payload[i] ^ buf[mask + (i & 3)]);
+        buf.remove(0, pos + qsizetype(length));
+
+        if (opcode == 0x8) {
+            client.socket->write(wsFrame(0x8, payload.left(2)));
+            return false;
+        }
+        if (opcode == 0x9) client.socket->write(wsFrame(0xA, payload));
+    }
+    return true;
+}
+
+// ---------- Player views ----------
+int PlayerServer::seatOf(const QString &player) const {
+    for (int i = 0; i < int(game.players.size()); ++i)
+        if (game.players[i].name == player) return i;
+    return -1;
+}
+
+// What one player may know. The Drunk's token is left blank: who they
+// believe they are is not recorded, so the Storyteller tells them in person.
+json PlayerServer::viewOf(const QString &player) const {
+    json view = {{"name", player.toStdString()}, {"day", game.day}, {"night", game.isNight()}};
+    int seat = seatOf(player);
+    view["seat"] = seat;
+    if (seat < 0) return view;
+
+    const Player &p = game.players[seat];
+    const bool known = !p.character.id.isEmpty() && p.character.id != "drunk";
+    view["character"] = known ? p.character.name.toStdString() : std::string();
+    view["ability"] = known ? p.character.ability.toStdString() : std::string();
+    view["icon"] = known ? QString("/icon?t=%1&c=%2").arg(feeds.at(player).token, p.character.id).toStdString()
+                         : std::string();
+    view["alive"] = game.isAlive(seat);
+    view["ghostVote"] = p.ghostVote;
+    return view;
+}
+
+void PlayerServer::changed(const GameChange &change) {
+    if (change.kind == GameChange::Effect) return;   // no player sees reminders
+    if (change.kind == GameChange::Seat && change.seat >= 0) {
+        if (int(dirtySeats.size()) <= change.seat) dirtySeats.resize(change.seat + 1, 0);
+        dirtySeats[change.seat] = 1;
+    } else {
+        allDirty = true;
+    }
+    if (flushQueued || feeds.empty()) return;
+    flushQueued = true;
+    QTimer::singleShot(0, this, &PlayerServer::flush);
+}
+
+// Builds each affected player's view once and sends what changed in it
+void PlayerServer::flush() {
+    StallWatchdog::ActionScope action("playerServer");
+    flushQueued = false;
+    for (auto &kv : feeds) {
+        Feed &feed = kv.second;
+        if (feed.phones.empty()) continue;
+        int seat = seatOf(kv.first);
+        bool dirty = allDirty || (seat >= 0 && seat < int(dirtySeats.size()) && dirtySeats[seat]);
+        if (!dirty) continue;
+
+        json view = viewOf(kv.first);
+        json set = json::object();
+        for (auto it = view.begin(); it != view.end(); ++it)
+            if (!feed.sent.contains(it.key()) || feed.sent[it.key()] != it.value()) set[it.key()] = it.value();
+        if (set.empty()) continue;
+        feed.sent = std::move(view);
+
+        const QByteArray frame = textFrame({{"type", "delta"}, {"set", std::move(set)}});
+        for (QTcpSocket *phone : feed.phones) phone->write(frame);
+    }
+    std::fill(dirtySeats.begin(), dirtySeats.end(), 0);
+    allDirty = false;
+}
+
+void PlayerServer::sendMessage(int seat, const QString &text) {
+    if (seat < 0 || seat >= int(game.players.size())) return;
+    tokenFor(seat);
+    Feed &feed = feeds[game.players[seat].name];
+    json message = {{"type", "message"}, {"text", text.toStdString()}, {"night", game.currentNight()}};
+    feed.messages.push_back(message);
+    if (int(feed.messages.size()) > MaxMessages) feed.messages.erase(feed.messages.begin());
+
+    const QByteArray frame = textFrame(message);
+    for (QTcpSocket *phone : feed.phones) phone->write(frame);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "GameState.h"
+
+class QTcpServer;
+class QTcpSocket;
+
+// ---------- Player server ----------
+// Players' phones on the venue network: a QTcpServer speaking just enough
+// HTTP to serve one small page and a player's token art, and WebSocket
+// (RFC 6455, text frames only) to keep that page current.
+//
+// Each player gets a link with a random token, keyed by their name so it
+// survives reseating. A phone receives that player's view once on
+// connecting, then only the fields that changed, and any messages the
+// Storyteller sends them. Game changes are collected until the event loop
+// is next idle; each affected player's view is then built and encoded once
+// and written to all of that player's phones.
+//
+// The port comes from BOTC_PLAYER_PORT (default 8765); when that port is
+// taken, e.g. by another table, any free port is used.
+class PlayerServer : public QObject {
+    Q_OBJECT
+public:
+    using json = nlohmann::json;
+
+    // The game must outlive the server
+    explicit PlayerServer(GameState &game, QObject *parent = nullptr);
+    ~PlayerServer() override;
+
+    bool start(const QHostAddress &address = QHostAddress::Any, quint16 port = 0);
+    quint16 port() const;
+    QString errorString() const { return lastError; }
+
+    QString tokenFor(int seat);   // made the first time it is asked for
+    QString playerUrl(int seat, const QString &host);
+    // The first IPv4 address a phone on the LAN could reach, else loopback
+    static QString lanAddress();
+
+    void sendMessage(int seat, const QString &text);
+    int phoneCount() const;
+
+    static constexpr int MaxRequestBytes = 16 * 1024;
+    static constexpr int MaxFrameBytes = 64 * 1024;
+    static constexpr int MaxMessages = 50;   // kept per player for phones that reconnect
+
+private:
+    // An open connection: HTTP until it upgrades, then a phone
+    struct Client {
+        QTcpSocket *socket = nullptr;
+        QByteArray buffer;
+        QString player;      // set once upgraded
+    };
+    // One per player given a link
+    struct Feed {
+        QString token;
+        json sent;                          // the view their phones last received
+        json messages = json::array();
+        std::vector<QTcpSocket *> phones;
+    };
+
+    void accept();
+    void read(QTcpSocket *socket);
+    void closed(QTcpSocket *socket);
+    bool handleRequest(Client &client);
+    bool handleFrames(Client &client);
+    void serveUpgrade(Client &client, const QByteArray &key, const QString &player);
+    QByteArray iconFor(const QString &player);
+
+    int seatOf(const QString &player) const;
+    json viewOf(const QString &player) const;
+    void changed(const GameChange &change);
+    void flush();
+
+    GameState &game;
+    int listener = -1;
+    QTcpServer *server = nullptr;
+    std::vector<Client> clients;
+    std::unordered_map<QString, Feed> feeds;     // by player name
+    std::unordered_map<QString, QString> names;  // token -> player name
+    QHash<QString, QByteArray> icons;            // PNG bytes by path
+    std::vector<char> dirtySeats;
+    bool allDirty = false;
+    bool flushQueued = false;
+    QString lastError;
+};
@@ -0,0 +1,67 @@
+#include "SeatRing.h"
+#include <algorithm>
+
+static inline std::uint64_t seatBit(int s) { return std::uint64_t(1) << s; }
+
+void SeatRing::reset(int seats, bool alive) {
+    n = std::clamp(seats, 0, MaxSeats);
+    mask = alive ? all() : 0;
+}
+
+void SeatRing::setAlive(int seat, bool alive) {
+    if (seat < 0 || seat >= n) return;
+    if (alive) mask |= seatBit(seat);
+    else mask &= ~seatBit(seat);
+}
+
+bool SeatRing::insert(int seat, bool alive) {
+    if (n >= MaxSeats || seat < 0 || seat > n) return false;
+    std::uint64_t below = mask & (seatBit(seat) - 1);
+    std::uint64_t above = seat + 1 < 64 ? (mask >> seat) << (seat + 1) : 0;
+    mask = below | above | (alive ? seatBit(seat) : 0);
+    ++n;
+    return true;
+}
+
+void SeatRing::remove(int seat) {
+    if (seat < 0 || seat >= n) return;
+    std::uint64_t below = mask & (seatBit(seat) - 1);
+    std::uint64_t above = seat + 1 < 64 ? (mask >> (seat + 1)) << seat : 0;
+    mask = below | above;
+    --n;
+}
+
+void SeatRing::swap(int a, int b) {
+    if (a < 0 || b < 0 || a >= n || b >= n || isAlive(a) == isAlive(b)) return;
+    mask ^= seatBit(a) | seatBit(b);
+}
+
+void SeatRing::remap(const std::vector<int> &newSeat, int seats) {
+    std::uint64_t moved = 0;
+    for (int s = 0; s < n && s < int(newSeat.size()); ++s)
+        if (newSeat[s] >= 0 && newSeat[s] < MaxSeats && isAlive(s)) moved |= seatBit(newSeat[s]);
+    n = std::clamp(seats, 0, MaxSeats);
+    mask = moved & all();
+}
+
+int SeatRing::neighbour(int seat, bool clockwise) const {
+    if (seat < 0 || seat >= n) return -1;
+    std::uint64_t others = mask & ~seatBit(seat);
+    if (!others) return -1;
+
+    if (clockwise) {
+        int k = (seat + 1) % n;
+        return (k + int(qCountTrailingZeroBits(quint64(rotated(others, k))))) % n;
+    }
+    int highest = 63 - int(qCountLeadingZeroBits(quint64(rotated(others, seat))));
+    return (seat + highest) % n;
+}
+
+int SeatRing::aliveBetween(int a, int b) const {
+    if (a < 0 || b < 0 || a >= n || b >= n) return 0;
+    int d = distance(a, b);
+    if (d <= 1) return 0;
+    // Bits 1 .. d-1 of the ring turned to a
+    std::uint64_t between = (seatBit(d) - 1) & ~std::uint64_t(1);
+    return int(qPopulationCount(quint64(rotated(mask, a) & between)));
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <QtAlgorithms>
+#include <cstdint>
+#include <vector>
+
+// ---------- Seating ring ----------
+// Who sits where around the circle and who is still alive, for the "nearest
+// living neighbour" questions the Empath, Tea Lady and friends ask. Seat
+// i + 1 is clockwise of seat i and the last seat wraps to seat 0.
+//
+// The ring is one 64-bit alive mask. Rotating it so a seat lands on bit 0
+// turns the nearest living neighbour into a trailing / leading zero count
+// and "living players between" into a popcount, so kills, revivals, swaps,
+// Traveller insertions and every query are constant time, with no links to
+// repair when someone dies or comes back.
+class SeatRing {
+public:
+    static constexpr int MaxSeats = 64;
+
+    SeatRing() = default;
+    explicit SeatRing(int seats, bool alive = true) { reset(seats, alive); }
+
+    void reset(int seats, bool alive = true);
+    int size() const { return n; }
+
+    // ---------- Seats ----------
+    bool isAlive(int seat) const { return seat >= 0 && seat < n && (mask >> seat & 1); }
+    void setAlive(int seat, bool alive);
+    // A new seat at `seat`; seats from there on move one clockwise
+    bool insert(int seat, bool alive = true);
+    void remove(int seat);
+    void swap(int a, int b);
+    // Seat i moves to newSeat[i] (-1: leaves); `seats` seats afterwards, dead
+    // where nobody moved to
+    void remap(const std::vector<int> &newSeat, int seats);
+
+    // ---------- Queries ----------
+    std::uint64_t aliveMask() const { return mask; }
+    int aliveCount() const { return int(qPopulationCount(quint64(mask))); }
+    // Nearest other living seat to that side, -1 if nobody else is alive
+    int neighbour(int seat, bool clockwise) const;
+    // Seats stepped over going clockwise from a to b (0 when a == b)
+    int distance(int a, int b) const { return n ? ((b - a) % n + n) % n : 0; }
+    // Living seats strictly between a and b going clockwise
+    int aliveBetween(int a, int b) const;
+
+private:
+    std::uint64_t all() const { return n == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1; }
+    // The ring turned so seat k sits on bit 0
+    std::uint64_t rotated(std::uint64_t m, int k) const {
+        return k == 0 ? m : ((m >> k) | (m << (n - k))) & all();
+    }
+
+    int n = 0;
+    std::uint64_t mask = 0;
+};
@@ -0,0 +1,154 @@
+#include "SetupRules.h"
+#include <QRegularExpression>
+#include <QStringList>
+#include <algorithm>
+#include <set>
+
+// ---------- parseSetupModifier ----------
+SetupModifier parseSetupModifier(const Character &c) {
+    SetupModifier mod;
+
+    static const QRegularExpression bracketRe("\\[([^\\]]*)\\]");
+    QRegularExpressionMatch bracket = bracketRe.match(c.ability);
+    if (!bracket.hasMatch()) return mod;
+
+    QString text = bracket.captured(1);
+    text.replace(QChar(0x2212), '-'); // unicode minus sign used in the almanac
+
+    if (text.contains("Outsider")) {
+        if (text.contains('?') || text.contains(QRegularExpression("\\bX Outsiders?")))
+            mod.anyOutsiders = true;
+
+        static const QRegularExpression outsiderRe(
+            "([+-]\\d+)(?:\\s+(or|to)\\s+([+-]\\d+))?\\s+Outsiders?");
+        QRegularExpressionMatch m = outsiderRe.match(text);
+        if (m.hasMatch()) {
+            int a = m.captured(1).toInt();
+            if (m.captured(2) == "to") {
+                int b = m.captured(3).toInt();
+                for (int d = std::min(a, b); d <= std::max(a, b); ++d) mod.outsiderDeltas.push_back(d);
+            } else if (m.captured(2) == "or") {
+                mod.outsiderDeltas = {a, m.captured(3).toInt()};
+            } else {
+                mod.outsiderDeltas = {a};
+            }
+        }
+    }
+
+    static const QRegularExpression minionRe("([+-]\\d+)\\s+Minions?");
+    QRegularExpressionMatch mm = minionRe.match(text);
+    if (mm.hasMatch()) mod.minionDelta = mm.captured(1).toInt();
+
+    return mod;
+}
+
+// ---------- SetupValidator ----------
+SetupValidator::SetupValidator(int numPlayers)
+    : numPlayers(numPlayers)
+{
+    auto it = GameState::role_config.find(numPlayers);
+    if (it != GameState::role_config.end()) distribution = &it->second;
+}
+
+SetupValidator::Team SetupValidator::teamIndex(const QString &team) {
+    if (team == "townsfolk") return Townsfolk;
+    if (team == "outsider") return Outsider;
+    if (team == "minion") return Minion;
+    if (team == "demon") return Demon;
+    if (team == "evil townsfolk") return EvilTownsfolk;
+    if (team == "traveller") return Traveller;
+    return Other;
+}
+
+QString SetupValidator::teamName(Team team) {
+    static const char *names[TeamCount] = {
+        "townsfolk", "outsider", "minion", "demon", "evil townsfolk", "traveller", "other"
+    };
+    return names[team];
+}
+
+void SetupValidator::add(int key, Team team, const SetupModifier &mod) {
+    counts[team]++;
+    totalCount++;
+    if (mod.active()) activeModifiers[key] = mod;
+}
+
+void SetupValidator::remove(int key, Team team) {
+    counts[team]--;
+    totalCount--;
+    activeModifiers.erase(key);
+}
+
+SetupValidator::Verdict SetupValidator::validate() const {
+    Verdict v;
+    if (!distribution) {
+        v.reason = QString("No role distribution for %1 players").arg(numPlayers);
+        return v;
+    }
+    if (counts[Other] > 0) {
+        v.reason = "Selection contains characters with an unknown team";
+        return v;
+    }
+
+    auto base = [&](const char *team) {
+        auto it = distribution->find(team);
+        return it == distribution->end() ? 0 : it->second;
+    };
+
+    // Fold the active modifiers into the expected distribution
+    int minionDelta = 0;
+    bool anyOutsiders = false;
+    std::set<int> outsiderDeltas = {0};
+    for (auto &kv : activeModifiers) {
+        const SetupModifier &mod = kv.second;
+        minionDelta += mod.minionDelta;
+        anyOutsiders = anyOutsiders || mod.anyOutsiders;
+        if (mod.outsiderDeltas.empty()) continue;
+        std::set<int> next;
+        for (int a : outsiderDeltas)
+            for (int b : mod.outsiderDeltas) next.insert(a + b);
+        outsiderDeltas.swap(next);
+    }
+
+    int needDemons = base("demon");
+    int needMinions = base("minion") + minionDelta;
+    int goodSlots = base("townsfolk") + base("outsider") - minionDelta;
+    int baseOutsiders = base("outsider");
+
+    int townsfolk = counts[Townsfolk] + counts[EvilTownsfolk];
+    int outsiders = counts[Outsider];
+
+    if (counts[Demon] != needDemons) {
+        v.reason = QString("Need %1 demon, have %2").arg(needDemons).arg(counts[Demon]);
+        return v;
+    }
+    if (counts[Minion] != needMinions) {
+        v.reason = QString("Need %1 minion(s), have %2").arg(needMinions).arg(counts[Minion]);
+        return v;
+    }
+
+    if (anyOutsiders) {
+        if (townsfolk + outsiders != goodSlots) {
+            v.reason = QString("Need %1 townsfolk + outsiders, have %2")
+                           .arg(goodSlots).arg(townsfolk + outsiders);
+            return v;
+        }
+        v.playable = true;
+        return v;
+    }
+
+    QStringList allowed;
+    for (int d : outsiderDeltas) {
+        int needOutsiders = baseOutsiders + d;
+        if (needOutsiders < 0 || needOutsiders > goodSlots) continue;
+        if (outsiders == needOutsiders && townsfolk == goodSlots - needOutsiders) {
+            v.playable = true;
+            return v;
+        }
+        allowed << QString("%1 townsfolk + %2 outsider(s)").arg(goodSlots - needOutsiders).arg(needOutsiders);
+    }
+
+    v.reason = QString("Need %1, have %2 townsfolk + %3 outsider(s)")
+                   .arg(allowed.join(" or ")).arg(townsfolk).arg(outsiders);
+    return v;
+}
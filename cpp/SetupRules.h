@@ -0,0 +1,52 @@
+#pragma once
+#include <QString>
+#include <array>
+#include <unordered_map>
+#include <vector>
+#include "GameState.h" // for Character
+
+// ---------- Setup modifiers ----------
+// Parsed from the bracketed part of an ability, e.g. "[+2 Outsiders]" or
+// "[−1 or +1 Outsider]". Townsfolk absorb whatever the other teams gain or lose.
+struct SetupModifier {
+    std::vector<int> outsiderDeltas;   // allowed outsider adjustments, empty = none
+    bool anyOutsiders = false;         // "-? to +? Outsiders", "[X Outsiders]"
+    int minionDelta = 0;               // "+1 Minion"
+
+    bool active() const { return !outsiderDeltas.empty() || anyOutsiders || minionDelta != 0; }
+};
+
+SetupModifier parseSetupModifier(const Character &c);
+
+// ---------- Incremental setup validator ----------
+// Keeps per-team counts of a character selection and checks it against the
+// role distribution for a player count. add/remove are O(1); validate() only
+// looks at the handful of active setup modifiers.
+class SetupValidator {
+public:
+    enum Team { Townsfolk, Outsider, Minion, Demon, EvilTownsfolk, Traveller, Other, TeamCount };
+
+    explicit SetupValidator(int numPlayers);
+
+    static Team teamIndex(const QString &team);
+    static QString teamName(Team team);
+
+    void add(int key, Team team, const SetupModifier &mod);
+    void remove(int key, Team team);
+
+    int count(Team team) const { return counts[team]; }
+    int total() const { return totalCount; }
+
+    struct Verdict {
+        bool playable = false;
+        QString reason;
+    };
+    Verdict validate() const;
+
+private:
+    int numPlayers;
+    const std::unordered_map<QString,int> *distribution = nullptr;
+    std::array<int, TeamCount> counts{};
+    int totalCount = 0;
+    std::unordered_map<int, SetupModifier> activeModifiers; // keyed by caller row/id
+};
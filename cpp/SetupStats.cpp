@@ -0,0 +1,214 @@
+#include "SetupStats.h"
+#include "SetupRules.h"
+#include <algorithm>
+#include <set>
+
+SetupStats::SetupStats(const std::vector<Character> &script) {
+    std::vector<SetupModifier> mods;
+    for (const Character &c : script) {
+        int t;
+        switch (SetupValidator::teamIndex(c.team)) {
+        case SetupValidator::Townsfolk:
+        case SetupValidator::EvilTownsfolk: t = Townsfolk; break;
+        case SetupValidator::Outsider: t = Outsider; break;
+        case SetupValidator::Minion: t = Minion; break;
+        case SetupValidator::Demon: t = Demon; break;
+        default: continue;                   // Travellers and Fabled are not dealt
+        }
+        SetupModifier mod = parseSetupModifier(c);
+        chars.push_back(c);
+        team.push_back(t);
+        ++onScript[t];
+        if (mod.active()) {
+            modifierBit.push_back(int(mods.size()));
+            mods.push_back(mod);
+        } else {
+            modifierBit.push_back(-1);
+            ++plain[t];
+        }
+    }
+    termsByPlayers.resize(16);
+    if (int(mods.size()) > MaxModifiers) {
+        setupError = QString("The script has more than %1 characters with setup modifiers.").arg(MaxModifiers);
+        return;
+    }
+
+    pascalSize = int(chars.size()) + 1;
+    pascal.assign(std::size_t(pascalSize) * pascalSize, 0);
+    for (int n = 0; n < pascalSize; ++n) {
+        pascal[std::size_t(n) * pascalSize] = 1;
+        for (int k = 1; k <= n; ++k)
+            pascal[std::size_t(n) * pascalSize + k] = pascal[std::size_t(n - 1) * pascalSize + k - 1]
+                                                    + (k < n ? pascal[std::size_t(n - 1) * pascalSize + k] : 0);
+    }
+
+    // Modifier characters per team, by subset bit
+    std::vector<int> modTeam(mods.size());
+    for (std::size_t i = 0; i < chars.size(); ++i)
+        if (modifierBit[i] >= 0) modTeam[modifierBit[i]] = team[i];
+
+    for (auto &cfg : GameState::role_config) {
+        const int players = cfg.first;
+        if (players < 0 || players >= int(termsByPlayers.size())) continue;
+        auto base = [&](const char *t) {
+            auto it = cfg.second.find(t);
+            return it == cfg.second.end() ? 0 : it->second;
+        };
+        std::vector<Term> &out = termsByPlayers[players];
+
+        // Folded like SetupValidator::validate, one subset at a time
+        for (std::uint32_t subset = 0; subset < (std::uint32_t(1) << mods.size()); ++subset) {
+            int in[TeamCount] = {};
+            int minionDelta = 0;
+            bool anyOutsiders = false;
+            std::set<int> deltas = {0};
+            for (std::size_t m = 0; m < mods.size(); ++m) {
+                if (!(subset >> m & 1)) continue;
+                ++in[modTeam[m]];
+                minionDelta += mods[m].minionDelta;
+                anyOutsiders = anyOutsiders || mods[m].anyOutsiders;
+                if (mods[m].outsiderDeltas.empty()) continue;
+                std::set<int> next;
+                for (int a : deltas)
+                    for (int b : mods[m].outsiderDeltas) next.insert(a + b);
+                deltas.swap(next);
+            }
+
+            Term term;
+            term.modifiers = subset;
+            term.k[Demon] = base("demon") - in[Demon];
+            term.k[Minion] = base("minion") + minionDelta - in[Minion];
+            if (term.k[Demon] < 0 || term.k[Demon] > plain[Demon]) continue;
+            if (term.k[Minion] < 0 || term.k[Minion] > plain[Minion]) continue;
+
+            const int goodSlots = base("townsfolk") + base("outsider") - minionDelta;
+            std::set<int> outsiderCounts;
+            if (anyOutsiders) {
+                for (int o = 0; o <= goodSlots; ++o) outsiderCounts.insert(o);
+            } else {
+                for (int d : deltas) outsiderCounts.insert(base("outsider") + d);
+            }
+            for (int o : outsiderCounts) {
+                if (o < 0 || o > goodSlots) continue;
+                term.k[Outsider] = o - in[Outsider];
+                term.k[Townsfolk] = goodSlots - o - in[Townsfolk];
+                if (term.k[Outsider] < 0 || term.k[Outsider] > plain[Outsider]) continue;
+                if (term.k[Townsfolk] < 0 || term.k[Townsfolk] > plain[Townsfolk]) continue;
+                term.outsiders = o;
+                term.townsfolk = goodSlots - o;
+                out.push_back(term);
+            }
+        }
+    }
+}
+
+int SetupStats::indexOf(const QString &characterId) const {
+    for (int i = 0; i < int(chars.size()); ++i)
+        if (chars[i].id == characterId) return i;
+    return -1;
+}
+
+SetupStats::Count SetupStats::binomial(int n, int k) const {
+    if (k < 0 || n < 0 || k > n || n >= pascalSize) return 0;
+    return pascal[std::size_t(n) * pascalSize + k];
+}
+
+// ---------- Counting ----------
+SetupStats::Count SetupStats::count(int players, const std::vector<int> &required) const {
+    if (players < 0 || players >= int(termsByPlayers.size())) return 0;
+
+    // Required plain characters per team, required modifier characters as a mask
+    int need[TeamCount] = {};
+    std::uint32_t mask = 0;
+    for (int c : required) {
+        if (c < 0 || c >= int(chars.size())) return 0;
+        if (modifierBit[c] >= 0) mask |= std::uint32_t(1) << modifierBit[c];
+        else ++need[team[c]];
+    }
+
+    Count total = 0;
+    for (const Term &t : terms(players)) {
+        if ((t.modifiers & mask) != mask) continue;
+        Count product = 1;
+        for (int team = 0; team < TeamCount && product; ++team)
+            product *= binomial(plain[team] - need[team], t.k[team] - need[team]);
+        total += product;
+    }
+    return total;
+}
+
+double SetupStats::probability(int players, const std::vector<int> &required) const {
+    Count all = setups(players);
+    if (!all) return 0.0;
+    return double(static_cast<long double>(count(players, required)) / static_cast<long double>(all));
+}
+
+double SetupStats::probability(int players, const QString &a, const QString &b) const {
+    std::vector<int> required;
+    for (const QString &id : {a, b}) {
+        if (id.isEmpty()) continue;
+        int i = indexOf(id);
+        if (i < 0) return 0.0;
+        required.push_back(i);
+    }
+    return probability(players, required);
+}
+
+std::vector<double> SetupStats::marginals(int players) const {
+    std::vector<double> out(chars.size());
+    const long double all = static_cast<long double>(setups(players));
+    if (all == 0) return out;
+    for (int i = 0; i < int(chars.size()); ++i)
+        out[i] = double(static_cast<long double>(count(players, std::vector<int>{i})) / all);
+    return out;
+}
+
+std::vector<std::vector<double>> SetupStats::pairwise(int players) const {
+    const int n = int(chars.size());
+    std::vector<std::vector<double>> out(n, std::vector<double>(n));
+    const long double all = static_cast<long double>(setups(players));
+    if (all == 0) return out;
+    for (int a = 0; a < n; ++a) {
+        out[a][a] = double(static_cast<long double>(count(players, std::vector<int>{a})) / all);
+        for (int b = a + 1; b < n; ++b)
+            out[a][b] = out[b][a] = double(static_cast<long double>(count(players, std::vector<int>{a, b})) / all);
+    }
+    return out;
+}
+
+// Each term fixes how many Outsiders and Townsfolk are in play; every good
+// character on the script but not in play is a safe bluff
+std::map<int, double> SetupStats::bluffPool(int players) const {
+    std::map<int, double> out;
+    Count all = setups(players);
+    if (!all) return out;
+    for (const Term &t : terms(players)) {
+        Count product = 1;
+        for (int team = 0; team < TeamCount; ++team) product *= binomial(plain[team], t.k[team]);
+        out[onScript[Townsfolk] + onScript[Outsider] - t.townsfolk - t.outsiders] += double(static_cast<long double>(product) / static_cast<long double>(all));
+    }
+    return out;
+}
+
+std::map<int, double> SetupStats::outsiderCounts(int players) const {
+    std::map<int, double> out;
+    Count all = setups(players);
+    if (!all) return out;
+    for (const Term &t : terms(players)) {
+        Count product = 1;
+        for (int team = 0; team < TeamCount; ++team) product *= binomial(plain[team], t.k[team]);
+        out[t.outsiders] += double(static_cast<long double>(product) / static_cast<long double>(all));
+    }
+    return out;
+}
+
+QString SetupStats::toString(Count value) {
+    if (!value) return "0";
+    std::string digits;
+    while (value) {
+        digits.push_back(char('0' + int(value % 10)));
+        value /= 10;
+    }
+    std::reverse(digits.begin(), digits.end());
+    return QString::fromStdString(digits);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <QString>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "GameState.h" // for Character
+
+// ---------- Setup statistics ----------
+// Exact odds over every legal setup of a script, each counted once: "is the
+// Drunk in play", "Baron and Saint together", how many good characters are
+// left to bluff. Legal means what SetupValidator accepts, setup modifiers included.
+//
+// Nothing is enumerated setup by setup. The few characters with a setup
+// modifier are enumerated as subsets; every other character only matters
+// through its team's count, so each subset and Outsider count contributes
+// a product of per-team binomials. A query for k required characters costs
+// one pass over those terms (2^modifiers x Outsider counts). Counts are
+// 128-bit, enough for any real script.
+class SetupStats {
+public:
+    using Count = unsigned __int128;
+
+    explicit SetupStats(const std::vector<Character> &script);
+
+    // Characters that can be dealt (no Travellers or Fabled), in script order
+    const std::vector<Character> &characters() const { return chars; }
+    int indexOf(const QString &characterId) const;   // -1 if not on the script
+    QString error() const { return setupError; }
+
+    // Legal setups for a player count, and those holding every character in
+    // `required` (indices into characters())
+    Count setups(int players) const { return count(players, {}); }
+    Count count(int players, const std::vector<int> &required) const;
+
+    double probability(int players, const std::vector<int> &required) const;
+    double probability(int players, const QString &a, const QString &b = QString()) const;
+
+    // Per character, and per pair ([a][b], symmetric; [a][a] is the marginal)
+    std::vector<double> marginals(int players) const;
+    std::vector<std::vector<double>> pairwise(int players) const;
+
+    // Townsfolk and Outsiders not in play (the Demon's bluff pool) -> probability
+    std::map<int, double> bluffPool(int players) const;
+    // Outsiders in play -> probability
+    std::map<int, double> outsiderCounts(int players) const;
+
+    static QString toString(Count value);
+
+private:
+    enum Team { Townsfolk, Outsider, Minion, Demon, TeamCount };
+    static constexpr int MaxModifiers = 16;
+
+    // One subset of modifier characters with one Outsider count: the rest of
+    // the setup is k[team] plain characters from each team
+    struct Term {
+        std::uint32_t modifiers = 0;
+        int k[TeamCount] = {};
+        int outsiders = 0;        // in play, modifier characters included
+        int townsfolk = 0;
+    };
+
+    const std::vector<Term> &terms(int players) const { return termsByPlayers[players]; }
+    Count binomial(int n, int k) const;
+
+    std::vector<Character> chars;
+    std::vector<int> team;                    // per character
+    std::vector<int> modifierBit;             // per character, -1 if plain
+    int plain[TeamCount] = {};                // plain characters per team
+    int onScript[TeamCount] = {};
+    std::vector<std::vector<Term>> termsByPlayers;
+    std::vector<Count> pascal;                // (maxPool + 1)^2 binomials
+    int pascalSize = 0;
+    QString setupError;
+};
@@ -0,0 +1,201 @@
+#include "StallWatchdog.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#if defined(Q_OS_UNIX) && __has_include(<execinfo.h>)
+#define BOTC_HAVE_BACKTRACE 1
+#include <cerrno>
+#include <csignal>
+#include <execinfo.h>
+#include <pthread.h>
+
+// Filled in by the UI thread from inside the signal handler
+static pthread_t uiThread;
+static void *capturedFrames[64];
+static std::atomic<int> capturedDepth{-1};
+
+static void captureHandler(int) {
+    int savedErrno = errno;
+    capturedDepth.store(backtrace(capturedFrames, 64));
+    errno = savedErrno;
+}
+#endif
+
+std::atomic<const char *> StallWatchdog::currentAction{nullptr};
+
+static qint64 nowMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+StallWatchdog &StallWatchdog::instance() {
+    static StallWatchdog *dog = new StallWatchdog(qApp);
+    return *dog;
+}
+
+StallWatchdog::StallWatchdog(QObject *parent)
+    : QObject(parent)
+{
+    connect(&heartbeat, &QTimer::timeout, this, &StallWatchdog::beat);
+}
+
+StallWatchdog::~StallWatchdog() {
+    stop();
+}
+
+// ---------- ActionScope ----------
+StallWatchdog::ActionScope::ActionScope(const char *name)
+    : previous(currentAction.exchange(name, std::memory_order_relaxed))
+{
+}
+
+StallWatchdog::ActionScope::~ActionScope() {
+    currentAction.store(previous, std::memory_order_relaxed);
+}
+
+// ---------- start / stop ----------
+void StallWatchdog::start(int budgetMs) {
+    if (running()) return;
+
+    if (budgetMs < 0) {
+        bool ok = false;
+        int env = qEnvironmentVariableIntValue("BOTC_STALL_BUDGET_MS", &ok);
+        budgetMs = ok ? env : 50;
+    }
+    if (budgetMs <= 0) return;
+    budget = budgetMs;
+
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/logs";
+    QDir().mkpath(dir);
+    logFile = dir + "/stalls.log";
+
+#ifdef BOTC_HAVE_BACKTRACE
+    // Must be called on the UI thread
+    uiThread = pthread_self();
+    struct sigaction sa = {};
+    sa.sa_handler = captureHandler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGUSR2, &sa, nullptr);
+
+    // The first backtrace() call may load libgcc; do it outside the handler
+    void *warm[1];
+    backtrace(warm, 1);
+#endif
+
+    lastBeatMs.store(nowMs());
+    heartbeat.start(std::max(1, budget / 2));
+
+    stopping = false;
+    watcher = std::thread([this]() { watch(); });
+}
+
+void StallWatchdog::stop() {
+    if (!running()) return;
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopping = true;
+    }
+    stopCv.notify_all();
+    watcher.join();
+    heartbeat.stop();
+}
+
+StallWatchdog::Stats StallWatchdog::stats() const {
+    Stats s;
+    s.stalls = stallCount.load();
+    s.totalMs = stallTotalMs.load();
+    s.maxMs = stallMaxMs.load();
+    return s;
+}
+
+// ---------- UI thread ----------
+void StallWatchdog::beat() {
+    qint64 now = nowMs();
+    qint64 gap = now - lastBeatMs.exchange(now);
+
+    // A beat is expected every interval; anything beyond interval + budget was a stall
+    qint64 interval = heartbeat.interval();
+    qint64 stalled = gap - interval;
+    if (stalled > budget) {
+        stallCount.fetch_add(1);
+        stallTotalMs.fetch_add(stalled);
+        quint64 prevMax = stallMaxMs.load();
+        while (quint64(stalled) > prevMax && !stallMaxMs.compare_exchange_weak(prevMax, stalled)) {}
+    }
+}
+
+// ---------- Watcher thread ----------
+void StallWatchdog::watch() {
+    const qint64 interval = std::max(1, budget / 2);
+    qint64 stallBeat = -1; // heartbeat value when the current stall was reported
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stopMutex);
+            if (stopCv.wait_for(lock, std::chrono::milliseconds(interval), [this]() { return stopping; }))
+                return;
+        }
+
+        qint64 beatMs = lastBeatMs.load();
+        qint64 gap = nowMs() - beatMs;
+
+        if (gap > budget + interval) {
+            if (stallBeat != beatMs) {
+                stallBeat = beatMs;
+                report(gap - interval, currentAction.load(std::memory_order_relaxed));
+            }
+        } else if (stallBeat >= 0 && beatMs != stallBeat) {
+            stallBeat = -1;
+        }
+    }
+}
+
+void StallWatchdog::report(qint64 stalledMs, const char *action) {
+    QString entry = QString("[%1] UI thread stalled for at least %2 ms (budget %3 ms) during %4\n")
+                        .arg(QDateTime::currentDateTime().toString(Qt::ISODateWithMs))
+                        .arg(stalledMs).arg(budget)
+                        .arg(action ? action : "(untracked)");
+
+#ifdef BOTC_HAVE_BACKTRACE
+    // Ask the UI thread to record its own stack, then symbolise it here
+    capturedDepth.store(-1);
+    if (pthread_kill(uiThread, SIGUSR2) == 0) {
+        for (int i = 0; i < 50 && capturedDepth.load() < 0; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    int depth = capturedDepth.load();
+    if (depth > 0) {
+        char **symbols = backtrace_symbols(capturedFrames, depth);
+        for (int i = 0; i < depth; ++i)
+            entry += QString("    #%1 %2\n").arg(i).arg(symbols ? symbols[i] : "?");
+        free(symbols);
+    } else {
+        entry += "    (stack not captured)\n";
+    }
+#endif
+
+    rotateLog();
+    QFile f(logFile);
+    if (f.open(QIODevice::Append | QIODevice::Text))
+        f.write(entry.toUtf8());
+}
+
+void StallWatchdog::rotateLog() {
+    const qint64 maxBytes = 1024 * 1024;
+    const int keep = 3;
+
+    if (QFileInfo(logFile).size() < maxBytes) return;
+
+    QFile::remove(QString("%1.%2").arg(logFile).arg(keep));
+    for (int i = keep - 1; i >= 1; --i)
+        QFile::rename(QString("%1.%2").arg(logFile).arg(i), QString("%1.%2").arg(logFile).arg(i + 1));
+    QFile::rename(logFile, logFile + ".1");
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// ---------- Event-loop stall watchdog ----------
+// A timer on the UI thread stamps a heartbeat; a watcher thread checks it.
+// When the UI thread misses the budget, the watcher asks it (via a signal)
+// to capture its own backtrace, then writes the stack and the tracked
+// action that was running to a rotating log. Stall counters are kept for
+// frequency and duration. When nothing stalls the cost is one timer tick
+// and one atomic store per half budget.
+class StallWatchdog : public QObject {
+    Q_OBJECT
+public:
+    static StallWatchdog &instance();
+
+    // Budget from BOTC_STALL_BUDGET_MS (default 50 ms, 0 disables)
+    void start(int budgetMs = -1);
+    void stop();
+    bool running() const { return watcher.joinable(); }
+
+    struct Stats {
+        quint64 stalls = 0;
+        quint64 totalMs = 0;
+        quint64 maxMs = 0;
+    };
+    Stats stats() const;
+    QString logPath() const { return logFile; }
+
+    // Marks what the UI thread is doing, e.g. StallWatchdog::ActionScope a("loadScript");
+    class ActionScope {
+    public:
+        explicit ActionScope(const char *name);
+        ~ActionScope();
+        ActionScope(const ActionScope &) = delete;
+        ActionScope &operator=(const ActionScope &) = delete;
+    private:
+        const char *previous;
+    };
+
+private:
+    explicit StallWatchdog(QObject *parent = nullptr);
+    ~StallWatchdog() override;
+
+    void beat();
+    void watch();
+    void report(qint64 stalledMs, const char *action);
+    void rotateLog();
+
+    int budget = 50;
+    QTimer heartbeat;
+    QString logFile;
+
+    std::thread watcher;
+    std::mutex stopMutex;
+    std::condition_variable stopCv;
+    bool stopping = false;
+
+    std::atomic<qint64> lastBeatMs{0};
+    std::atomic<quint64> stallCount{0};
+    std::atomic<quint64> stallTotalMs{0};
+    std::atomic<quint64> stallMaxMs{0};
+
+    static std::atomic<const char *> currentAction;
+};
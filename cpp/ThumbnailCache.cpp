@@ -0,0 +1,179 @@
+#include "ThumbnailCache.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <QPainterPath>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+ThumbnailCache &ThumbnailCache::instance() {
+    static ThumbnailCache *cache = [] {
+        auto *c = new ThumbnailCache();
+        if (qApp)
+            QObject::connect(qApp, &QCoreApplication::aboutToQuit, [c]() { c->saveIndex(); });
+        return c;
+    }();
+    return *cache;
+}
+
+ThumbnailCache::ThumbnailCache() {
+    cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/thumbnails";
+    QDir().mkpath(cacheDir);
+    loadIndex();
+}
+
+// ---------- Index ----------
+void ThumbnailCache::loadIndex() {
+    std::ifstream f((cacheDir + "/index.json").toStdString());
+    if (!f) return;
+
+    json j;
+    try { f >> j; } catch (...) { return; } // corrupt index: everything gets rehashed
+
+    for (auto &it : j.items()) {
+        SourceInfo info;
+        info.size = it.value().value("size", qint64(0));
+        info.mtime = it.value().value("mtime", qint64(0));
+        info.hash = QString::fromStdString(it.value().value("hash", ""));
+        index[QString::fromStdString(it.key())] = info;
+    }
+}
+
+void ThumbnailCache::saveIndex() {
+    QMutexLocker lock(&mutex);
+    if (!indexDirty) return;
+
+    json j = json::object();
+    for (auto &kv : index)
+        j[kv.first.toStdString()] = {
+            {"size", kv.second.size},
+            {"mtime", kv.second.mtime},
+            {"hash", kv.second.hash.toStdString()}
+        };
+
+    QSaveFile out(cacheDir + "/index.json");
+    if (!out.open(QIODevice::WriteOnly)) return;
+    out.write(QByteArray::fromStdString(j.dump()));
+    if (out.commit()) indexDirty = false;
+}
+
+QString ThumbnailCache::sourceHash(const QString &sourcePath) {
+    QFileInfo fi(sourcePath);
+    if (!fi.exists()) return {};
+
+    QString key = fi.absoluteFilePath();
+    qint64 size = fi.size();
+    qint64 mtime = fi.lastModified().toMSecsSinceEpoch();
+
+    {
+        // Cheap validation: unchanged size and mtime means the stored hash holds
+        QMutexLocker lock(&mutex);
+        auto it = index.find(key);
+        if (it != index.end() && it->second.size == size && it->second.mtime == mtime)
+            return it->second.hash;
+    }
+
+    QFile f(sourcePath);
+    if (!f.open(QIODevice::ReadOnly)) return {};
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    h.addData(&f);
+    QString hash = QString::fromLatin1(h.result().toHex());
+
+    QMutexLocker lock(&mutex);
+    index[key] = {size, mtime, hash};
+    indexDirty = true;
+    return hash;
+}
+
+// ---------- Entries ----------
+QString ThumbnailCache::entryPath(const QString &hash, const QSize &size, qreal dpr, Shape shape) const {
+    return QString("%1/%2_%3x%4@%5%6.png")
+        .arg(cacheDir, hash)
+        .arg(size.width()).arg(size.height())
+        .arg(qRound(dpr * 100))
+        .arg(shape == Circle ? "_c" : "");
+}
+
+QImage ThumbnailCache::render(const QImage &source, const QSize &px, Shape shape) {
+    QImage scaled = source.scaled(px, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    if (shape == Square) return scaled;
+
+    QImage out(px, QImage::Format_ARGB32_Premultiplied);
+    out.fill(Qt::transparent);
+    QPainter painter(&out);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QPainterPath clip;
+    clip.addEllipse(QRectF(0, 0, px.width(), px.height()));
+    painter.setClipPath(clip);
+    painter.drawImage(0, 0, scaled);
+    painter.end();
+    return out;
+}
+
+QImage ThumbnailCache::load(const QString &sourcePath, const QSize &size, qreal dpr, Shape shape) {
+    QString hash = sourceHash(sourcePath);
+    if (hash.isEmpty()) return {};
+
+    QString path = entryPath(hash, size, dpr, shape);
+    QImage img;
+    if (img.load(path)) {
+        // Mark it used, at most once an hour, so trimming keeps it
+        QFile entry(path);
+        QDateTime now = QDateTime::currentDateTime();
+        if (QFileInfo(path).lastModified().secsTo(now) > 3600 && entry.open(QIODevice::Append))
+            entry.setFileTime(now, QFileDevice::FileModificationTime);
+    } else {
+        QImage source;
+        if (!source.load(sourcePath)) return {};
+        img = render(source, QSize(qRound(size.width() * dpr), qRound(size.height() * dpr)), shape);
+
+        // Write-then-rename so a concurrent reader never sees half a file
+        QSaveFile out(path);
+        if (out.open(QIODevice::WriteOnly) && img.save(&out, "PNG") && out.commit())
+            added(QFileInfo(path).size());
+    }
+    img.setDevicePixelRatio(dpr);
+    return img;
+}
+
+// ---------- Disk budget ----------
+qint64 ThumbnailCache::diskBytes() {
+    QMutexLocker lock(&diskMutex);
+    if (usedBytes < 0) {
+        usedBytes = 0;
+        for (const QFileInfo &fi : QDir(cacheDir).entryInfoList({"*.png"}, QDir::Files)) usedBytes += fi.size();
+    }
+    return usedBytes;
+}
+
+void ThumbnailCache::added(qint64 bytes) {
+    if (diskBytes() + bytes <= maxDiskBytes) {
+        QMutexLocker lock(&diskMutex);
+        usedBytes += bytes;
+        return;
+    }
+    trim();
+}
+
+// Rescans rather than trusting the running total, which other processes
+// sharing the directory do not see
+void ThumbnailCache::trim() {
+    QMutexLocker lock(&diskMutex);
+    QFileInfoList entries = QDir(cacheDir).entryInfoList({"*.png"}, QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 total = 0;
+    for (const QFileInfo &fi : entries) total += fi.size();
+    const qint64 target = maxDiskBytes * 3 / 4;
+    for (const QFileInfo &fi : entries) {   // oldest first
+        if (total <= target) break;
+        if (QFile::remove(fi.absoluteFilePath())) total -= fi.size();
+    }
+    usedBytes = total;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <unordered_map>
+
+// ---------- Persistent thumbnail cache ----------
+// Stores pre-scaled (and optionally pre-circled) copies of token art and
+// backgrounds under QStandardPaths::CacheLocation. Entries are keyed by the
+// SHA-1 of the source file, the target size and the device pixel ratio.
+// A small index remembers each source's size and mtime so later runs can
+// trust the stored hash after a stat() instead of rehashing the file.
+// load() is thread-safe and is called from IconCache workers.
+//
+// The directory is capped at maxDiskBytes: once a write takes it over, the
+// entries used least recently (a hit refreshes an entry's mtime) are
+// deleted until it is back under three quarters of the cap.
+class ThumbnailCache {
+public:
+    enum Shape { Square, Circle };
+
+    static ThumbnailCache &instance();
+
+    // Cached image at size * dpr pixels, rendered from sourcePath on a miss.
+    // Returns a null image if the source cannot be read.
+    QImage load(const QString &sourcePath, const QSize &size, qreal dpr, Shape shape);
+
+    void saveIndex();
+
+    void setMaxDiskBytes(qint64 bytes) { maxDiskBytes = bytes; }
+    qint64 diskBytes();
+
+private:
+    ThumbnailCache();
+
+    struct SourceInfo {
+        qint64 size = 0;
+        qint64 mtime = 0;
+        QString hash;
+    };
+
+    QString sourceHash(const QString &sourcePath);
+    QString entryPath(const QString &hash, const QSize &size, qreal dpr, Shape shape) const;
+    static QImage render(const QImage &source, const QSize &px, Shape shape);
+    void loadIndex();
+    void added(qint64 bytes);
+    void trim();
+
+    QString cacheDir;
+    QMutex mutex; // guards index and indexDirty
+    std::unordered_map<QString, SourceInfo> index;
+    bool indexDirty = false;
+
+    QMutex diskMutex; // guards usedBytes and trimming
+    qint64 usedBytes = -1;                        // entries on disk, -1 until first counted
+    std::atomic<qint64> maxDiskBytes{128ll * 1024 * 1024};
+};
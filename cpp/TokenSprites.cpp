@@ -0,0 +1,162 @@
+#include "TokenSprites.h"
+#include "IconCache.h"
+#include "ThumbnailCache.h"
+#include <QCoreApplication>
+#include <QPainter>
+#include <QPainterPath>
+#include <QStringList>
+#include <algorithm>
+
+TokenSprites &TokenSprites::instance() {
+    static TokenSprites *sprites = new TokenSprites(qApp);
+    return *sprites;
+}
+
+TokenSprites::TokenSprites(QObject *parent)
+    : QObject(parent)
+{
+    sprites.setMaxCost(16 * 1024); // 16 MB
+    // A 1536x1024 step at dpr 2 is 24 MB; room for the main window's, the
+    // grimoire's and the town square's at once
+    backgrounds.setMaxCost(96 * 1024);
+}
+
+static QString spriteKey(const char *kind, const QString &name, int w, int h, qreal dpr, int state) {
+    return QString("%1|%2|%3x%4@%5|%6").arg(kind, name).arg(w).arg(h).arg(qRound(dpr * 100)).arg(state);
+}
+
+QPixmap TokenSprites::blank(int width, int height, qreal dpr) {
+    QPixmap pm(qRound(width * dpr), qRound(height * dpr));
+    pm.setDevicePixelRatio(dpr);
+    pm.fill(Qt::transparent);
+    return pm;
+}
+
+void TokenSprites::drawRing(QPainter &painter, int size, State state) {
+    qreal width = state == Normal ? 2.0 : 3.0;
+    QColor color = state == Normal ? QColor(Qt::white) : QColor("gold");
+    painter.setPen(QPen(color, width));
+    painter.setBrush(Qt::NoBrush);
+    qreal inset = width / 2;
+    painter.drawEllipse(QRectF(inset, inset, size - width, size - width));
+}
+
+QColor TokenSprites::reminderColor(const QString &reminder) {
+    static const QMap<QString, QColor> effectColors = {
+        {"Poisoned", QColor("purple")},
+        {"Stunned", QColor("orange")},
+        {"Protected", QColor("green")},
+        {"Bluffed", QColor("yellow")},
+        {"Drunk", QColor("saddlebrown")},
+        {"Safe", QColor("green")},
+        {"Dead", QColor("red")}
+    };
+    auto it = effectColors.find(reminder);
+    if (it != effectColors.end()) return *it;
+
+    // Stable hue per reminder name instead of plain black
+    return QColor::fromHsv(int(qHash(reminder) % 360), 170, 150);
+}
+
+QPixmap TokenSprites::seat(const QString &characterName, const QString &team, int size, qreal dpr, State state) {
+    // Sprites drawn over a placeholder are not cached, so nothing needs
+    // invalidating when the real art arrives
+    bool ready = IconCache::instance().contains(characterName, size);
+    QString key = spriteKey("seat", characterName, size, size, dpr, state);
+    if (ready) {
+        if (QPixmap *pm = sprites.object(key)) return *pm;
+    }
+
+    QPixmap pm = blank(size, size, dpr);
+    QPainter painter(&pm);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    QRectF r(0, 0, size, size);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(Qt::gray);
+    painter.drawEllipse(r);
+
+    QPainterPath clip;
+    clip.addEllipse(r);
+    painter.setClipPath(clip);
+    painter.drawPixmap(r.toRect(), IconCache::instance().pixmap(characterName, team, size));
+    painter.setClipping(false);
+
+    drawRing(painter, size, state);
+    painter.end();
+
+    if (ready) sprites.insert(key, new QPixmap(pm), std::max(1, int(pm.width() * pm.height() * 4 / 1024)));
+    return pm;
+}
+
+QPixmap TokenSprites::disc(const QString &text, const QColor &color, int size, qreal dpr, State state) {
+    QString key = spriteKey("disc", text + '|' + color.name(), size, size, dpr, state);
+    if (QPixmap *pm = sprites.object(key)) return *pm;
+
+    QPixmap pm = blank(size, size, dpr);
+    QPainter painter(&pm);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(color);
+    painter.drawEllipse(QRectF(0, 0, size, size));
+    drawRing(painter, size, state);
+
+    QFont f;
+    f.setPixelSize(text.length() > 6 ? 9 : 10);
+    f.setBold(true);
+    painter.setFont(f);
+    painter.setPen(Qt::white);
+    painter.drawText(QRectF(2, 2, size - 4, size - 4), Qt::AlignCenter | Qt::TextWordWrap, text);
+    painter.end();
+
+    sprites.insert(key, new QPixmap(pm), std::max(1, int(pm.width() * pm.height() * 4 / 1024)));
+    return pm;
+}
+
+QPixmap TokenSprites::label(const QString &text, int width, int height, qreal dpr) {
+    QString key = spriteKey("label", text, width, height, dpr, 0);
+    if (QPixmap *pm = sprites.object(key)) return *pm;
+
+    QPixmap pm = blank(width, height, dpr);
+    QPainter painter(&pm);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    QFont f;
+    f.setPixelSize(14);
+    f.setBold(true);
+    painter.setFont(f);
+    painter.setPen(Qt::white);
+    painter.drawText(QRectF(0, 0, width, height), Qt::AlignCenter, text);
+    painter.end();
+
+    sprites.insert(key, new QPixmap(pm), std::max(1, int(pm.width() * pm.height() * 4 / 1024)));
+    return pm;
+}
+
+QPixmap TokenSprites::background(const QString &path, const QSize &size, qreal dpr) {
+    if (path.isEmpty() || size.isEmpty()) return QPixmap();
+
+    // Backgrounds are multi-megabyte PNGs. Only a few sizes, rounded up to
+    // BackgroundStep, are rendered from the source and kept on disk and in
+    // their own cache, apart from the token sprites; every window size in
+    // between is scaled from one of those, so dragging a window edge only
+    // reads the source on entering a new step.
+    const QSize bucket((size.width() + BackgroundStep - 1) / BackgroundStep * BackgroundStep,
+                       (size.height() + BackgroundStep - 1) / BackgroundStep * BackgroundStep);
+    QString baseKey = spriteKey("bgbase", path, bucket.width(), bucket.height(), dpr, 0);
+    QPixmap base;
+    if (QPixmap *cached = backgrounds.object(baseKey)) {
+        base = *cached;
+    } else {
+        base = QPixmap::fromImage(ThumbnailCache::instance().load(path, bucket, dpr, ThumbnailCache::Square));
+        if (base.isNull()) return base;
+        backgrounds.insert(baseKey, new QPixmap(base), std::max(1, int(base.width() * base.height() * 4 / 1024)));
+    }
+
+    QPixmap pm = base.scaled(QSize(qRound(size.width() * dpr), qRound(size.height() * dpr)),
+                             Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    pm.setDevicePixelRatio(dpr);
+    return pm;
+}
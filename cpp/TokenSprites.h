@@ -0,0 +1,39 @@
+#pragma once
+#include <QCache>
+#include <QColor>
+#include <QObject>
+#include <QPixmap>
+#include <QString>
+
+class QPainter;
+
+// ---------- Token sprite cache ----------
+// Renders grimoire tokens once per size and device pixel ratio with QPainter:
+// circular character art with a ring border (normal / hover / selected),
+// coloured reminder discs and name labels. The grimoire only blits these.
+class TokenSprites : public QObject {
+    Q_OBJECT
+public:
+    enum State { Normal, Hover, Selected };
+
+    static TokenSprites &instance();
+
+    QPixmap seat(const QString &characterName, const QString &team, int size, qreal dpr, State state);
+    QPixmap disc(const QString &label, const QColor &color, int size, qreal dpr, State state = Normal);
+    QPixmap label(const QString &text, int width, int height, qreal dpr);
+    // Not cached: a widget keeps its own copy and asks again on resize
+    QPixmap background(const QString &path, const QSize &size, qreal dpr);
+
+    static QColor reminderColor(const QString &reminder);
+
+    static constexpr int BackgroundStep = 512;   // logical px between background sizes kept on disk
+
+private:
+    explicit TokenSprites(QObject *parent = nullptr);
+
+    static QPixmap blank(int width, int height, qreal dpr);
+    static void drawRing(QPainter &painter, int size, State state);
+
+    QCache<QString, QPixmap> sprites; // cost in KB
+    QCache<QString, QPixmap> backgrounds; // per BackgroundStep size, cost in KB
+};
@@ -0,0 +1,155 @@
+#include "TownSquareWidget.h"
+#include "GrimoireWidget.h"
+#include "TokenSprites.h"
+#include <QPaintEvent>
+#include <QPainter>
+#include <cmath>
+
+static constexpr int labelHeight = 30;
+static const QColor aliveColor("#8a6d3b");
+static const QColor deadColor("#2b2b2b");
+static const QColor voteColor("#4a6fa5");
+
+TownSquareWidget::TownSquareWidget(GameState &game, QWidget *parent)
+    : QWidget(parent), game(game)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setWindowTitle("Town Square");
+    resize(900, 900);
+
+    listener = game.addChangeListener([this](const GameChange &change) { changed(change); });
+    phase = phaseText();
+    syncPlayers();
+}
+
+TownSquareWidget::~TownSquareWidget() {
+    game.removeChangeListener(listener);
+}
+
+TownSquareWidget::Seat TownSquareWidget::publicSeat(int seat) const {
+    const Player &p = game.players[seat];
+    return {p.name, !game.isAlive(seat), p.ghostVote};
+}
+
+QString TownSquareWidget::phaseText() const {
+    return game.isNight() ? QString("Night %1").arg(game.currentNight()) : QString("Day %1").arg(game.day);
+}
+
+// ---------- Changes ----------
+void TownSquareWidget::changed(const GameChange &change) {
+    switch (change.kind) {
+    case GameChange::Seat:
+        // A seat event for a circle we have not laid out yet means we missed one
+        if (seats.size() == game.players.size()) syncSeat(change.seat);
+        else syncPlayers();
+        break;
+    case GameChange::Players:
+        syncPlayers();
+        break;
+    case GameChange::Phase: {
+        QString now = phaseText();
+        if (now != phase) {
+            phase = now;
+            update(phaseRect());
+        }
+        break;
+    }
+    case GameChange::Effect:
+        break;   // reminders are the storyteller's, never shown to the town
+    }
+}
+
+void TownSquareWidget::syncSeat(int seat) {
+    if (seat < 0 || seat >= int(seats.size())) return;
+    Seat now = publicSeat(seat);
+    if (now == seats[seat]) return;   // e.g. a poisoning the players cannot see
+    seats[seat] = now;
+    update(layout[seat].area());
+}
+
+void TownSquareWidget::syncPlayers() {
+    const int n = int(game.players.size());
+    if (n != int(seats.size())) {
+        seats.resize(n);
+        for (int i = 0; i < n; ++i) seats[i] = publicSeat(i);
+        relayout();
+        update();
+        return;
+    }
+    for (int i = 0; i < n; ++i) syncSeat(i);
+}
+
+// ---------- Layout ----------
+// The grimoire's circle, with the ghost vote where the grimoire has its status disc
+void TownSquareWidget::relayout() {
+    const int n = int(seats.size());
+    layout.resize(n);
+    if (n == 0) return;
+
+    const int seatSize = GrimoireWidget::seatSize;
+    const int voteSize = GrimoireWidget::effectCircleSize;
+    const double d = 0.78 * GrimoireWidget::circleRadius(n, size());
+    for (int i = 0; i < n; ++i) {
+        Layout &l = layout[i];
+        l.token = GrimoireWidget::seatRect(i, n, size());
+        l.label = QRect(l.token.left(), l.token.bottom() + 3, seatSize, labelHeight);
+        double angle = 2 * M_PI * i / n;
+        l.vote = QRect(int(width() / 2 + d * std::cos(angle) - voteSize / 2),
+                       int(height() / 2 + d * std::sin(angle) - voteSize / 2), voteSize, voteSize);
+    }
+}
+
+QRect TownSquareWidget::phaseRect() const {
+    return QRect(width() / 2 - 100, height() / 2 - labelHeight / 2, 200, labelHeight);
+}
+
+void TownSquareWidget::setBackground(const QString &path) {
+    backgroundPath = path;
+    renderBackground();
+    update();
+}
+
+void TownSquareWidget::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    renderBackground();
+    relayout();
+}
+
+bool TownSquareWidget::event(QEvent *event) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 6, 0)
+    if (event->type() == QEvent::DevicePixelRatioChange) renderBackground();
+#endif
+    return QWidget::event(event);
+}
+
+void TownSquareWidget::renderBackground() {
+    backgroundPixmap = TokenSprites::instance().background(backgroundPath, size(), devicePixelRatioF());
+}
+
+// ---------- Painting ----------
+void TownSquareWidget::paintEvent(QPaintEvent *event) {
+    QPainter painter(this);
+    qreal dpr = devicePixelRatioF();
+    const QRect dirty = event->rect();
+    TokenSprites &sprites = TokenSprites::instance();
+
+    if (backgroundPixmap.isNull())
+        painter.fillRect(dirty, palette().window());
+    else
+        painter.drawPixmap(dirty, backgroundPixmap, QRectF(QPointF(dirty.topLeft()) * dpr, QSizeF(dirty.size()) * dpr));
+
+    if (phaseRect().intersects(dirty))
+        painter.drawPixmap(phaseRect().topLeft(), sprites.label(phase, phaseRect().width(), labelHeight, dpr));
+
+    for (int i = 0; i < int(seats.size()); ++i) {
+        const Layout &l = layout[i];
+        if (!l.area().intersects(dirty)) continue;
+        const Seat &s = seats[i];
+
+        painter.drawPixmap(l.token.topLeft(), sprites.disc(s.dead ? "Dead" : QString(), s.dead ? deadColor : aliveColor,
+                                                           GrimoireWidget::seatSize, dpr));
+        painter.drawPixmap(l.label.topLeft(), sprites.label(s.name, l.label.width(), labelHeight, dpr));
+        if (s.dead && s.ghostVote)
+            painter.drawPixmap(l.vote.topLeft(), sprites.disc("Vote", voteColor, l.vote.width(), dpr));
+    }
+}
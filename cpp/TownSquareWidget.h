@@ -0,0 +1,65 @@
+#pragma once
+#include <QPixmap>
+#include <QWidget>
+#include <vector>
+#include "GameState.h"
+
+// ---------- Town square ----------
+// The players' view of the game for a second screen: seats in the same
+// circle as the grimoire, who is dead and who still holds a ghost vote,
+// and whether it is day or night. Characters, reminders and bluffs are
+// never drawn.
+//
+// The view follows the game's change events: each event is compared with
+// the public state it last drew and repaints only the seats that differ
+// (the layout is redone only when the seats themselves change), so an
+// update costs a few cached sprite blits and lands on the next frame.
+class TownSquareWidget : public QWidget {
+    Q_OBJECT
+public:
+    // The game must outlive the view
+    explicit TownSquareWidget(GameState &game, QWidget *parent = nullptr);
+    ~TownSquareWidget() override;
+
+    // Usually the grimoire's, see GrimoireWidget::background()
+    void setBackground(const QString &path);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    bool event(QEvent *event) override;
+
+private:
+    // What the players may know about one seat
+    struct Seat {
+        QString name;
+        bool dead = false;
+        bool ghostVote = true;
+
+        bool operator==(const Seat &o) const { return name == o.name && dead == o.dead && ghostVote == o.ghostVote; }
+        bool operator!=(const Seat &o) const { return !(*this == o); }
+    };
+    struct Layout {
+        QRect token;
+        QRect label;
+        QRect vote;          // inside the circle, shown for dead players with a vote
+        QRect area() const { return token.united(label).united(vote); }
+    };
+
+    Seat publicSeat(int seat) const;
+    QString phaseText() const;
+    void changed(const GameChange &change);
+    void syncSeat(int seat);
+    void syncPlayers();
+    void relayout();
+    void renderBackground();   // on resize, dpr or path changes, never per paint
+    QRect phaseRect() const;
+
+    GameState &game;
+    int listener = -1;
+    std::vector<Seat> seats;      // as last drawn
+    std::vector<Layout> layout;
+    QString phase;
+    QString backgroundPath;
+    QPixmap backgroundPixmap;     // at size() and the widget's dpr
+};
@@ -0,0 +1,162 @@
+#include "WinTracker.h"
+#include <algorithm>
+
+WinTracker::Team WinTracker::teamIndex(const QString &team) {
+    if (team == "townsfolk") return Townsfolk;
+    if (team == "outsider") return Outsider;
+    if (team == "minion") return Minion;
+    if (team == "demon") return Demon;
+    if (team == "traveller") return Traveller;
+    return Other;
+}
+
+WinTracker::Role WinTracker::roleIndex(const QString &characterId) {
+    if (characterId == "scarletwoman") return ScarletWomanRole;
+    if (characterId == "saint") return SaintRole;
+    if (characterId == "mayor") return MayorRole;
+    return Plain;
+}
+
+void WinTracker::clear() {
+    seatState.clear();
+    alive.fill(0);
+    ableRoles.fill(0);
+    aliveTotal = 0;
+    lastDemons = 0;
+    lastNonTravellers = 0;
+    demonPassing = false;
+    executedToday = false;
+    alerts.clear();
+}
+
+void WinTracker::count(const Seat &s, int sign) {
+    if (!s.alive) return;
+    alive[s.team] += sign;
+    aliveTotal += sign;
+    if (!s.impaired) ableRoles[s.role] += sign;
+}
+
+// ---------- Changes ----------
+// Seats added during setup only set the baseline; nothing is raised for them
+void WinTracker::addSeat(const QString &characterId, const QString &team, bool isAlive, bool impaired) {
+    Seat s;
+    s.team = teamIndex(team);
+    s.role = roleIndex(characterId);
+    s.alive = isAlive;
+    s.impaired = impaired;
+    count(s, +1);
+    seatState.push_back(s);
+    lastDemons = alive[Demon];
+    lastNonTravellers = aliveNonTravellers();
+}
+
+void WinTracker::remap(const std::vector<int> &newSeat, int seats) {
+    Seat empty;
+    empty.alive = false;
+    std::vector<Seat> placed(std::size_t(std::max(seats, 0)), empty);
+    for (int seat = 0; seat < int(seatState.size()); ++seat) {
+        int to = seat < int(newSeat.size()) ? newSeat[seat] : -1;
+        if (to >= 0 && to < int(placed.size())) placed[to] = seatState[seat];
+        else count(seatState[seat], -1);
+    }
+    seatState.swap(placed);
+    for (GameAlert &a : alerts)
+        if (a.seat >= 0) a.seat = a.seat < int(newSeat.size()) ? newSeat[a.seat] : -1;
+    lastDemons = alive[Demon];
+    lastNonTravellers = aliveNonTravellers();
+}
+
+void WinTracker::placeSeat(int seat, const QString &characterId, const QString &team, bool isAlive, bool impaired) {
+    if (seat < 0 || seat >= seats()) return;
+    Seat &s = seatState[seat];
+    count(s, -1);
+    s.team = teamIndex(team);
+    s.role = roleIndex(characterId);
+    s.alive = isAlive;
+    s.impaired = impaired;
+    count(s, +1);
+    lastDemons = alive[Demon];
+    lastNonTravellers = aliveNonTravellers();
+}
+
+void WinTracker::setCharacter(int seat, const QString &characterId, const QString &team) {
+    if (seat < 0 || seat >= seats()) return;
+    Seat &s = seatState[seat];
+    count(s, -1);
+    s.team = teamIndex(team);
+    s.role = roleIndex(characterId);
+    count(s, +1);
+    checkCircle();
+}
+
+void WinTracker::setAlive(int seat, bool isAlive, bool executed) {
+    if (seat < 0 || seat >= seats()) return;
+    Seat &s = seatState[seat];
+    if (s.alive == isAlive) return;
+
+    if (isAlive) {
+        s.alive = true;
+        count(s, +1);
+        checkCircle();
+        return;
+    }
+
+    int before = aliveNonTravellers();
+    count(s, -1);
+    s.alive = false;
+    if (executed) executedToday = true;
+
+    if (s.team == Demon && alive[Demon] == 0 && before >= 5 && ableRoles[ScarletWomanRole] > 0) {
+        demonPassing = true;
+        raise(GameAlert::ScarletWoman, seat, "The Demon died with 5 or more players alive: the Scarlet Woman becomes the Demon.");
+    }
+    if (executed && s.role == SaintRole && !s.impaired)
+        raise(GameAlert::EvilWins, seat, "The Saint was executed: evil wins.");
+    checkCircle();
+}
+
+void WinTracker::setImpaired(int seat, bool impaired) {
+    if (seat < 0 || seat >= seats()) return;
+    Seat &s = seatState[seat];
+    if (s.impaired == impaired) return;
+    count(s, -1);
+    s.impaired = impaired;
+    count(s, +1);
+}
+
+void WinTracker::endDay() {
+    if (!executedToday && aliveNonTravellers() == 3 && alive[Demon] > 0 && ableRoles[MayorRole] > 0)
+        raise(GameAlert::GoodWins, -1, "Three players alive and no execution today: the Mayor wins the game for good.");
+    executedToday = false;
+}
+
+// ---------- Checks ----------
+void WinTracker::checkCircle() {
+    int demons = alive[Demon];
+    int living = aliveNonTravellers();
+
+    if (demons > 0) demonPassing = false;
+    if (demons == 0 && lastDemons > 0 && !demonPassing)
+        raise(GameAlert::GoodWins, -1, "No Demon is alive: good wins.");
+    if (demons > 0 && living <= 2 && lastNonTravellers > 2)
+        raise(GameAlert::EvilWins, -1, "Only two players are alive: evil wins.");
+    if (demons > 1 && lastDemons <= 1)
+        raise(GameAlert::Invariant, -1, QString("%1 Demons are alive.").arg(demons));
+
+    lastDemons = demons;
+    lastNonTravellers = living;
+}
+
+void WinTracker::raise(GameAlert::Kind kind, int seat, const QString &message) {
+    GameAlert a;
+    a.kind = kind;
+    a.seat = seat;
+    a.message = message;
+    alerts.push_back(a);
+}
+
+std::vector<GameAlert> WinTracker::takeAlerts() {
+    std::vector<GameAlert> out;
+    out.swap(alerts);
+    return out;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <QString>
+#include <array>
+#include <vector>
+
+// ---------- Game alerts ----------
+struct GameAlert {
+    enum Kind { GoodWins, EvilWins, ScarletWoman, Invariant };
+    Kind kind = Invariant;
+    int seat = -1;           // player it is about, -1 if none
+    QString message;
+};
+
+// ---------- Win tracker ----------
+// Counts derived from the circle (alive players per team, alive Demons,
+// alive non-Travellers, ...) kept up to date in O(1) per change: GameState
+// reports every kill, revive, execution, character change and poisoning,
+// so nothing ever rescans the players. Win conditions and rule invariants
+// are checked on each change and raised once, as they happen:
+//  - the last Demon dies (unless a Scarlet Woman takes over at 5+ alive)
+//  - only two players are left alive with a Demon among them
+//  - a sober, healthy Saint is executed
+//  - the day ends with three alive, no execution and a sober, healthy Mayor
+//  - more than one Demon is alive
+class WinTracker {
+public:
+    enum Team { Townsfolk, Outsider, Minion, Demon, Traveller, Other, TeamCount };
+
+    static Team teamIndex(const QString &team);
+
+    void clear();
+    void addSeat(const QString &characterId, const QString &team, bool alive, bool impaired);
+    // Reseating: seat i moves to newSeat[i] (-1: leaves). `seats` seats
+    // afterwards; those nobody moved to are empty until placeSeat(). Neither
+    // raises anything: nobody died.
+    void remap(const std::vector<int> &newSeat, int seats);
+    void placeSeat(int seat, const QString &characterId, const QString &team, bool alive, bool impaired);
+    void setCharacter(int seat, const QString &characterId, const QString &team);
+    void setAlive(int seat, bool alive, bool executed = false);
+    void setImpaired(int seat, bool impaired);
+    void endDay();
+
+    int seats() const { return int(seatState.size()); }
+    int aliveCount(Team team) const { return alive[team]; }
+    int aliveDemons() const { return alive[Demon]; }
+    int aliveNonTravellers() const { return aliveTotal - alive[Traveller]; }
+    int aliveGood() const { return alive[Townsfolk] + alive[Outsider]; }
+    int aliveEvil() const { return alive[Minion] + alive[Demon]; }
+
+    // Alerts raised since the last call, oldest first
+    std::vector<GameAlert> takeAlerts();
+    bool hasAlerts() const { return !alerts.empty(); }
+
+private:
+    enum Role : unsigned char { Plain, ScarletWomanRole, SaintRole, MayorRole };
+
+    struct Seat {
+        Team team = Other;
+        Role role = Plain;
+        bool alive = true;
+        bool impaired = false;
+    };
+
+    static Role roleIndex(const QString &characterId);
+    void count(const Seat &s, int sign);
+    void checkCircle();
+    void raise(GameAlert::Kind kind, int seat, const QString &message);
+
+    std::vector<Seat> seatState;
+    std::array<int, TeamCount> alive{};
+    int aliveTotal = 0;
+    std::array<int, 4> ableRoles{};      // alive, unimpaired players per Role
+
+    // Previous values, so alerts fire on transitions only
+    int lastDemons = 0;
+    int lastNonTravellers = 0;
+    bool demonPassing = false;           // the Scarlet Woman is about to take over
+    bool executedToday = false;
+
+    std::vector<GameAlert> alerts;
+};
@@ -0,0 +1,604 @@
+#include "WorldSolver.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <atomic>
+#include <set>
+
+// Leaves are counted against Options::maxWorlds in batches of this size
+static constexpr std::uint64_t kFlushEvery = 1024;
+
+// Outsider deltas are kept as a bitset with bit kDeltaZero meaning "+0"
+static constexpr int kDeltaZero = 16;
+
+static inline std::uint64_t charBit(int c) { return std::uint64_t(1) << c; }
+static inline std::uint32_t seatBit(int s) { return std::uint32_t(1) << s; }
+
+static inline int lowestBit(std::uint64_t bits) { return int(qCountTrailingZeroBits(bits)); }
+static inline int popCount(std::uint32_t bits) { return int(qPopulationCount(bits)); }
+
+static bool isGood(SetupValidator::Team team) {
+    return team == SetupValidator::Townsfolk || team == SetupValidator::Outsider;
+}
+
+// Per-task search state; each Demon seat is searched by one task
+struct WorldSolver::Search {
+    const Options *options = nullptr;
+    std::atomic<std::uint64_t> *total = nullptr;
+    std::atomic<bool> *stop = nullptr;
+
+    World w;
+    std::uint64_t used = 0;       // characters in play so far
+    std::uint64_t banned = 0;     // characters known not to be in play (the Drunk's claim)
+    std::vector<int> minionSeats;
+    std::vector<int> goodSeats;   // claimed seats first, then unclaimed ones
+    int firstOpen = 0;            // index of the first unclaimed seat in goodSeats
+
+    std::uint64_t worlds = 0;
+    std::uint64_t unflushed = 0;
+    std::vector<std::uint64_t> evilCount;
+    std::vector<std::uint64_t> demonCount;
+    std::vector<World> kept;
+};
+
+// ---------- Setup ----------
+WorldSolver::WorldSolver(const GameState &state)
+    : n(int(state.players.size())),
+      chars(state.scriptCharacters())
+{
+    claims.fill(-1);
+
+    for (auto &kv : state.characterDB())
+        teamById[kv.first] = SetupValidator::teamIndex(kv.second.team);
+
+    if (n > MaxSeats) { setupError = QString("At most %1 seats can be analysed.").arg(MaxSeats); return; }
+    if (chars.size() > 64) { setupError = "Scripts over 64 characters cannot be analysed."; return; }
+    allSeats = seatBit(n) - 1;
+
+    // ---- characters ----
+    info.resize(chars.size());
+    for (size_t i = 0; i < chars.size(); ++i) {
+        const Character &c = chars[i];
+        CharInfo &ci = info[i];
+        indexById[c.id] = int(i);
+        ci.team = SetupValidator::teamIndex(c.team);
+        ci.drunk = c.id == "drunk";
+        ci.spy = c.id == "spy";
+        ci.recluse = c.id == "recluse";
+        if ((ci.team == SetupValidator::Minion || ci.team == SetupValidator::Demon)
+            && c.ability.contains("poison", Qt::CaseInsensitive))
+            ci.poisons = 1;
+        ci.mod = parseSetupModifier(c);
+
+        if (ci.team == SetupValidator::Demon) demonChars |= charBit(int(i));
+        else if (ci.team == SetupValidator::Minion) minionChars |= charBit(int(i));
+        else if (isGood(ci.team)) goodChars |= charBit(int(i));
+        if (ci.team == SetupValidator::Outsider) outsiderChars |= charBit(int(i));
+        if (ci.drunk) drunkIndex = int(i);
+        if (ci.mod.active()) modifierChars |= charBit(int(i));
+    }
+    const std::uint64_t evilChars = demonChars | minionChars;
+
+    // ---- seats ----
+    std::unordered_map<int, std::uint32_t> claimedBy;
+    for (int s = 0; s < n; ++s) {
+        const QString &claim = state.players[s].claim;
+        if (claim.isEmpty()) {
+            candidates[s] = evilChars | goodChars;
+            continue;
+        }
+        auto team = teamById.find(claim);
+        if (team != teamById.end() && team->second == SetupValidator::Traveller) {
+            travellers |= seatBit(s);
+            continue;
+        }
+        auto idx = indexById.find(claim);
+        if (idx != indexById.end() && isGood(info[idx->second].team)) {
+            int c = idx->second;
+            claims[s] = c;
+            candidates[s] = charBit(c) | evilChars;
+            if (drunkIndex >= 0 && info[c].team == SetupValidator::Townsfolk) candidates[s] |= charBit(drunkIndex);
+            claimedBy[c] |= seatBit(s);
+        } else {
+            // Claims an evil or off-script character: only evil players do that
+            candidates[s] = evilChars;
+            mustBeEvil |= seatBit(s);
+        }
+    }
+    for (auto &kv : claimedBy)
+        if (popCount(kv.second) > 1) sharedClaims.push_back(kv.second);
+
+    // ---- distribution ----
+    int seated = n - popCount(travellers);
+    auto cfg = GameState::role_config.find(seated);
+    if (cfg == GameState::role_config.end()) {
+        setupError = QString("No role distribution for %1 players.").arg(seated);
+        return;
+    }
+    auto base = [&](const char *team) {
+        auto it = cfg->second.find(team);
+        return it == cfg->second.end() ? 0 : it->second;
+    };
+    baseMinions = base("minion");
+    baseOutsiders = base("outsider");
+    baseGood = base("townsfolk") + baseOutsiders;
+
+    std::set<int> totals = {baseMinions};
+    for (auto &ci : info) {
+        if (!ci.mod.minionDelta) continue;
+        std::set<int> next = totals;
+        for (int t : totals) next.insert(t + ci.mod.minionDelta);
+        totals.swap(next);
+    }
+    for (int t : totals)
+        if (t >= 0 && t < seated) minionCounts.push_back(t);
+
+    // ---- info ----
+    for (auto &record : state.info_log) {
+        Fact f;
+        if (toFact(record, f)) facts.push_back(f);
+    }
+}
+
+// Translates a logged record into a checkable fact; false if it says nothing
+bool WorldSolver::toFact(const InfoRecord &record, Fact &f) const {
+    if (record.seat < 0 || record.seat >= n) return false;
+    f.seat = record.seat;
+    f.night = std::clamp(record.night, 0, MaxNights - 1);
+
+    auto role = indexById.find(record.role);
+    f.role = role == indexById.end() ? -1 : role->second;
+
+    f.seats = 0;
+    for (int s : record.seats) {
+        if (s < 0 || s >= n) return false;
+        f.seats |= seatBit(s);
+    }
+
+    auto shown = indexById.find(record.character);
+    f.character = shown == indexById.end() ? -1 : shown->second;
+    auto team = teamById.find(record.character);
+    f.characterTeam = team == teamById.end() ? SetupValidator::Other : team->second;
+    f.number = record.number;
+    f.yes = record.yes;
+
+    const QString &r = record.role;
+    if (r == "washerwoman" || r == "librarian" || r == "investigator" || r == "grandmother"
+        || r == "undertaker" || r == "ravenkeeper") {
+        if (r == "librarian" && !f.seats) { f.kind = FactKind::NoOutsiders; return true; }
+        f.kind = FactKind::Ping;
+        return f.seats != 0 && !record.character.isEmpty();
+    }
+    if (r == "chef") { f.kind = FactKind::Chef; return true; }
+    if (r == "empath") { f.kind = FactKind::Empath; return true; }
+    if (r == "fortuneteller") { f.kind = FactKind::Fortune; return f.seats != 0; }
+    return false;
+}
+
+// ---------- Checks ----------
+// Whether the characters in play (`inPlay`, one bit per character, so team
+// counts are popcounts) match the distribution plus their setup modifiers,
+// given that `openSeats` good seats are still to be filled from `openChars`
+bool WorldSolver::countsFit(std::uint64_t inPlay, int openSeats, std::uint64_t openChars) const {
+    int minions = int(qPopulationCount(quint64(inPlay & minionChars)));
+    int outsiders = int(qPopulationCount(quint64(inPlay & outsiderChars)));
+    int minionDelta = 0;
+    bool anyOutsiders = false;
+    std::uint64_t deltas = charBit(kDeltaZero);
+
+    for (std::uint64_t mods = inPlay & modifierChars; mods; mods &= mods - 1) {
+        const SetupModifier &mod = info[lowestBit(mods)].mod;
+        minionDelta += mod.minionDelta;
+        anyOutsiders = anyOutsiders || mod.anyOutsiders;
+        if (mod.outsiderDeltas.empty()) continue;
+        std::uint64_t next = 0;
+        for (std::uint64_t bits = deltas; bits; bits &= bits - 1) {
+            for (int d : mod.outsiderDeltas) {
+                int v = lowestBit(bits) + d;
+                if (v >= 0 && v < 64) next |= charBit(v);
+            }
+        }
+        deltas = next;
+    }
+
+    if (minions != baseMinions + minionDelta) return false;
+    if (anyOutsiders) return true;
+    if (openSeats && (openChars & modifierChars)) return true; // an open seat may still change the numbers
+
+    for (std::uint64_t bits = deltas; bits; bits &= bits - 1) {
+        int missing = baseOutsiders + lowestBit(bits) - kDeltaZero - outsiders;
+        if (missing >= 0 && missing <= openSeats) return true;
+    }
+    return false;
+}
+
+bool WorldSolver::factHolds(const Fact &f, const World &w, std::uint32_t spies, std::uint32_t recluses) const {
+    switch (f.kind) {
+    case FactKind::Ping: {
+        bool goodShown = isGood(f.characterTeam);
+        bool evilShown = f.characterTeam == SetupValidator::Minion || f.characterTeam == SetupValidator::Demon;
+        for (std::uint64_t bits = f.seats; bits; bits &= bits - 1) {
+            int s = lowestBit(bits);
+            if (f.character >= 0 && w.chars[s] == f.character) return true;
+            if ((spies & seatBit(s)) && goodShown) return true;
+            if ((recluses & seatBit(s)) && evilShown) return true;
+        }
+        return false;
+    }
+    case FactKind::NoOutsiders:
+        for (int s = 0; s < n; ++s) {
+            int c = w.chars[s];
+            if (c != NoCharacter && info[c].team == SetupValidator::Outsider && !(recluses & seatBit(s)))
+                return false;
+        }
+        return true;
+    case FactKind::Chef:
+    case FactKind::Empath: {
+        // The Spy may register good and the Recluse evil: try every combination
+        std::uint32_t fixed = w.evil & ~spies;
+        std::uint32_t flex = spies | recluses;
+        std::uint32_t sub = flex;
+        for (;;) {
+            std::uint32_t e = fixed | sub;
+            int count;
+            if (f.kind == FactKind::Chef) {
+                std::uint32_t next = ((e >> 1) | (e << (n - 1))) & allSeats; // seat i+1 moved onto seat i
+                count = popCount(e & next);
+            } else {
+                count = popCount(e & f.seats);
+            }
+            if (count == f.number) return true;
+            if (!sub) return false;
+            sub = (sub - 1) & flex;
+        }
+    }
+    case FactKind::Fortune: {
+        std::uint32_t demon = seatBit(w.demonSeat);
+        if (f.yes) return (f.seats & (demon | recluses)) || (f.seats & ~w.evil & ~travellers);
+        return !(f.seats & demon);
+    }
+    }
+    return false;
+}
+
+bool WorldSolver::consistent(const World &w) const {
+    std::uint32_t spies = 0, recluses = 0;
+    int allowance = 0;
+    for (int s = 0; s < n; ++s) {
+        int c = w.chars[s];
+        if (c == NoCharacter) continue;
+        if (info[c].spy) spies |= seatBit(s);
+        if (info[c].recluse) recluses |= seatBit(s);
+        if (w.evil & seatBit(s)) allowance += info[c].poisons;
+    }
+
+    std::array<std::uint32_t, MaxNights> failing{};
+    std::array<const Fact *, 32> fortune{};
+    int fortunes = 0;
+
+    for (const Fact &f : facts) {
+        std::uint32_t bit = seatBit(f.seat);
+        if ((w.evil | w.drunk) & bit) continue;                  // their info says nothing
+        if (f.role >= 0 && w.chars[f.seat] != f.role) return false; // good players only hold their own info
+        if (f.kind == FactKind::Fortune) {
+            if (fortunes < int(fortune.size())) fortune[fortunes++] = &f;
+            continue;
+        }
+        if (!factHolds(f, w, spies, recluses)) {
+            failing[f.night] |= bit;
+            if (popCount(failing[f.night]) > allowance) return false;
+        }
+    }
+    if (!fortunes) return true;
+
+    // Fortune Teller: answers either hold outright, need poison, or pin down the red herring
+    std::uint32_t demon = seatBit(w.demonSeat);
+    std::uint32_t herring = allSeats & ~w.evil & ~travellers;
+    std::array<std::uint32_t, 32> constraint{};   // herring must lie in this set, ~0 = no constraint
+    std::uint32_t mustPoison = 0;
+    std::array<int, 32> open{};                   // answers that may need poison
+    int opened = 0;
+    for (int i = 0; i < fortunes; ++i) {
+        const Fact &f = *fortune[i];
+        constraint[i] = ~0u;
+        if (f.yes) {
+            if (f.seats & (demon | recluses)) continue;
+            constraint[i] = f.seats;
+        } else {
+            if (f.seats & demon) mustPoison |= seatBit(i);
+            else constraint[i] = ~f.seats;
+        }
+        open[opened++] = i;
+    }
+
+    int k = std::min(opened, 16);
+    for (std::uint32_t pick = 0; pick < (1u << k); ++pick) {
+        std::uint32_t poisoned = 0;
+        for (int j = 0; j < k; ++j)
+            if (pick & seatBit(j)) poisoned |= seatBit(open[j]);
+        if ((mustPoison & poisoned) != mustPoison) continue;
+        if (poisoned && !allowance) continue;
+
+        std::array<std::uint32_t, MaxNights> nights = failing;
+        bool fits = true;
+        std::uint32_t h = herring;
+        for (int i = 0; i < fortunes && fits; ++i) {
+            const Fact &f = *fortune[i];
+            if (poisoned & seatBit(i)) {
+                nights[f.night] |= seatBit(f.seat);
+                fits = popCount(nights[f.night]) <= allowance;
+            } else {
+                h &= constraint[i];
+            }
+        }
+        if (fits && h) return true;
+    }
+    return false;
+}
+
+bool WorldSolver::infoHolds(const World &w, const InfoRecord &record) const {
+    Fact f;
+    if (!toFact(record, f)) return true;
+    std::uint32_t spies = 0, recluses = 0;
+    for (int s = 0; s < n; ++s) {
+        int c = w.chars[s];
+        if (c == NoCharacter) continue;
+        if (info[c].spy) spies |= seatBit(s);
+        if (info[c].recluse) recluses |= seatBit(s);
+    }
+    return factHolds(f, w, spies, recluses);
+}
+
+std::vector<std::uint32_t> WorldSolver::teamsKeptAlive(const std::vector<World> &worlds,
+                                                        const std::vector<InfoRecord> &records,
+                                                        std::uint32_t *teams, int threads) const {
+    // Group the worlds by evil team so that each team counts once
+    struct Entry {
+        std::uint32_t team;
+        std::uint32_t spies;
+        std::uint32_t recluses;
+        const World *w;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(worlds.size());
+    for (const World &w : worlds) {
+        Entry e{w.evil | (std::uint32_t(w.demonSeat) << MaxSeats), 0, 0, &w};
+        for (int s = 0; s < n; ++s) {
+            int c = w.chars[s];
+            if (c == NoCharacter) continue;
+            if (info[c].spy) e.spies |= seatBit(s);
+            if (info[c].recluse) e.recluses |= seatBit(s);
+        }
+        entries.push_back(e);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.team < b.team; });
+
+    std::vector<std::size_t> groups;   // start of each team's run in entries
+    for (std::size_t i = 0; i < entries.size(); ++i)
+        if (i == 0 || entries[i].team != entries[i - 1].team) groups.push_back(i);
+    groups.push_back(entries.size());
+    std::uint32_t teamCount = std::uint32_t(groups.size() - 1);
+    if (teams) *teams = teamCount;
+
+    std::vector<std::uint32_t> kept(records.size(), teamCount);
+    if (records.empty() || !teamCount) return kept;
+
+    std::vector<Fact> compiled(records.size());
+    std::vector<char> checkable(records.size());
+    for (std::size_t r = 0; r < records.size(); ++r)
+        checkable[r] = toFact(records[r], compiled[r]);
+
+    auto score = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            if (!checkable[r]) continue;              // says nothing: every team survives
+            std::uint32_t alive = 0;
+            for (std::size_t g = 0; g + 1 < groups.size(); ++g) {
+                for (std::size_t i = groups[g]; i < groups[g + 1]; ++i) {
+                    const Entry &e = entries[i];
+                    if (factHolds(compiled[r], *e.w, e.spies, e.recluses)) { ++alive; break; }
+                }
+            }
+            kept[r] = alive;
+        }
+    };
+
+    QThreadPool pool;
+    int workers = threads > 0 ? threads : QThread::idealThreadCount();
+    pool.setMaxThreadCount(workers);
+    std::size_t chunk = std::max<std::size_t>(1, records.size() / (std::size_t(std::max(1, workers)) * 4));
+    for (std::size_t begin = 0; begin < records.size(); begin += chunk) {
+        std::size_t end = std::min(records.size(), begin + chunk);
+        pool.start([&score, begin, end]() { score(begin, end); });
+    }
+    pool.waitForDone();
+    return kept;
+}
+
+// ---------- Search ----------
+void WorldSolver::searchDemon(int d, Search &search) const {
+    for (std::uint64_t bits = candidates[d] & demonChars; bits; bits &= bits - 1) {
+        int demonChar = lowestBit(bits);
+        search.w = World{};
+        search.w.chars.fill(NoCharacter);
+        search.w.demonSeat = std::uint8_t(d);
+        search.w.chars[d] = std::uint8_t(demonChar);
+        search.w.evil = seatBit(d);
+        search.used = charBit(demonChar);
+        search.banned = 0;
+
+        for (int m : minionCounts) {
+            search.minionSeats.clear();
+            chooseMinions(search, 0, m);
+        }
+    }
+}
+
+void WorldSolver::chooseMinions(Search &search, int from, int remaining) const {
+    if (search.stop->load(std::memory_order_relaxed)) return;
+
+    if (remaining == 0) {
+        std::uint32_t evil = search.w.evil;
+        if (mustBeEvil & ~evil) return;
+        for (std::uint32_t shared : sharedClaims)
+            if (popCount(shared & ~evil) > 1) return;   // two good players cannot share a character
+        assignMinions(search, 0);
+        return;
+    }
+
+    for (int s = from; s <= n - remaining; ++s) {
+        // Every seat passed over here stays good, so it must be allowed to be
+        if (s > from && (mustBeEvil & seatBit(s - 1)) && !(search.w.evil & seatBit(s - 1))) return;
+        if (s == search.w.demonSeat || (travellers & seatBit(s)) || !(candidates[s] & minionChars)) continue;
+        search.minionSeats.push_back(s);
+        search.w.evil |= seatBit(s);
+        chooseMinions(search, s + 1, remaining - 1);
+        search.w.evil &= ~seatBit(s);
+        search.minionSeats.pop_back();
+    }
+}
+
+void WorldSolver::assignMinions(Search &search, int index) const {
+    if (index == int(search.minionSeats.size())) {
+        search.goodSeats.clear();
+        for (int pass = 0; pass < 2; ++pass) {
+            if (pass == 1) search.firstOpen = int(search.goodSeats.size());
+            for (int s = 0; s < n; ++s) {
+                if ((search.w.evil | travellers) & seatBit(s)) continue;
+                if ((claims[s] >= 0) == (pass == 0)) search.goodSeats.push_back(s);
+            }
+        }
+        assignGood(search, 0);
+        return;
+    }
+
+    int s = search.minionSeats[index];
+    for (std::uint64_t bits = candidates[s] & minionChars & ~search.used; bits; bits &= bits - 1) {
+        int c = lowestBit(bits);
+        search.w.chars[s] = std::uint8_t(c);
+        search.used |= charBit(c);
+        assignMinions(search, index + 1);
+        search.used &= ~charBit(c);
+    }
+    search.w.chars[s] = NoCharacter;
+}
+
+// Returns whether any consistent world was found below this point. Unclaimed
+// seats only need some fitting character, so the first fit is enough.
+bool WorldSolver::assignGood(Search &search, int index) const {
+    if (search.stop->load(std::memory_order_relaxed)) return false;
+    if (index == int(search.goodSeats.size()))
+        return leaf(search);
+    if (index == search.firstOpen
+        && !countsFit(search.used, int(search.goodSeats.size()) - index, goodChars & ~(search.used | search.banned)))
+        return false;
+
+    int s = search.goodSeats[index];
+    int claim = claims[s];
+    bool found = false;
+    if (claim >= 0) {
+        // Telling the truth
+        if (!((search.used | search.banned) & charBit(claim))) {
+            search.w.chars[s] = std::uint8_t(claim);
+            search.used |= charBit(claim);
+            found = assignGood(search, index + 1);
+            search.used &= ~charBit(claim);
+        }
+        // Or the Drunk, in which case the claimed Townsfolk is not in play
+        if (drunkIndex >= 0 && (candidates[s] & charBit(drunkIndex))
+            && !(search.used & (charBit(drunkIndex) | charBit(claim)))) {
+            search.w.chars[s] = std::uint8_t(drunkIndex);
+            search.used |= charBit(drunkIndex);
+            search.banned |= charBit(claim);
+            found = assignGood(search, index + 1) || found;
+            search.banned &= ~charBit(claim);
+            search.used &= ~charBit(drunkIndex);
+        }
+    } else {
+        for (std::uint64_t bits = candidates[s] & goodChars & ~(search.used | search.banned); bits; bits &= bits - 1) {
+            int c = lowestBit(bits);
+            search.w.chars[s] = std::uint8_t(c);
+            search.used |= charBit(c);
+            found = assignGood(search, index + 1);
+            search.used &= ~charBit(c);
+            if (found) break;
+        }
+    }
+    search.w.chars[s] = NoCharacter;
+    return found;
+}
+
+bool WorldSolver::leaf(Search &search) const {
+    World &w = search.w;
+    if (!countsFit(search.used, 0, 0)) return false;
+
+    w.drunk = 0;
+    if (drunkIndex >= 0)
+        for (int s = 0; s < n; ++s)
+            if (w.chars[s] == drunkIndex) w.drunk |= seatBit(s);
+    if (!consistent(w)) return false;
+
+    ++search.worlds;
+    for (std::uint32_t bits = w.evil; bits; bits &= bits - 1) ++search.evilCount[lowestBit(bits)];
+    ++search.demonCount[w.demonSeat];
+    if (search.options->keepWorlds) search.kept.push_back(w);
+
+    if (++search.unflushed == kFlushEvery) {
+        search.unflushed = 0;
+        if (search.total->fetch_add(kFlushEvery) + kFlushEvery >= search.options->maxWorlds)
+            search.stop->store(true);
+    }
+    return true;
+}
+
+WorldSolver::Result WorldSolver::solve(const Options &options) const {
+    Result r;
+    r.evil.assign(n, 0.0);
+    r.demon.assign(n, 0.0);
+    if (!setupError.isEmpty()) {
+        r.error = setupError;
+        return r;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::atomic<std::uint64_t> total{0};
+    std::atomic<bool> stop{false};
+    std::vector<Search> searches(n);
+    for (auto &search : searches) {
+        search.options = &options;
+        search.total = &total;
+        search.stop = &stop;
+        search.evilCount.assign(n, 0);
+        search.demonCount.assign(n, 0);
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(options.threads > 0 ? options.threads : QThread::idealThreadCount());
+    for (int d = 0; d < n; ++d) {
+        if (!(candidates[d] & demonChars) || (travellers & seatBit(d))) continue;
+        pool.start([this, d, &searches]() { searchDemon(d, searches[d]); });
+    }
+    pool.waitForDone();
+
+    std::vector<std::uint64_t> evil(n, 0), demon(n, 0);
+    for (auto &search : searches) {
+        r.worlds += search.worlds;
+        for (int s = 0; s < n; ++s) {
+            evil[s] += search.evilCount[s];
+            demon[s] += search.demonCount[s];
+        }
+        if (options.keepWorlds) r.kept.insert(r.kept.end(), search.kept.begin(), search.kept.end());
+    }
+    if (r.worlds) {
+        for (int s = 0; s < n; ++s) {
+            r.evil[s] = double(evil[s]) / double(r.worlds);
+            r.demon[s] = double(demon[s]) / double(r.worlds);
+        }
+    }
+    r.truncated = stop.load();
+    r.elapsedMs = timer.elapsed();
+    return r;
+}
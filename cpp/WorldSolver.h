@@ -0,0 +1,136 @@
+#pragma once
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "GameState.h"
+#include "SetupRules.h"
+
+// ---------- World solver ----------
+// Enumerates every assignment of starting characters to seats that fits the
+// script, the role distribution, the public claims and the info log, the way
+// a player would reason about the circle:
+//  - good players claim their real character, except the Drunk, who claims a
+//    Townsfolk that is not in play; evil players may claim anything
+//  - info held by an evil or drunk player says nothing
+//  - each poisoning evil character in play may make one seat per night wrong
+//  - the Spy and the Recluse may register either way to every ability
+//  - the Fortune Teller has one red herring, a good player, for the game
+// A world is one evil team plus the Drunk's seat; unclaimed good players only
+// need some character that fits, so each world is counted once, uniformly.
+// The search is split by Demon seat and runs on a thread pool.
+class WorldSolver {
+public:
+    static constexpr int MaxSeats = 20;
+    static constexpr int MaxNights = 32;
+    static constexpr std::uint8_t NoCharacter = 0xff;
+
+    // One consistent world; seat sets are bitmasks with bit i = seat i
+    struct World {
+        std::uint32_t evil = 0;
+        std::uint32_t drunk = 0;
+        std::uint8_t demonSeat = 0;
+        std::array<std::uint8_t, MaxSeats> chars{};   // index into characters(), NoCharacter for travellers
+    };
+
+    struct Options {
+        int threads = 0;                  // 0 = one per core
+        bool keepWorlds = false;          // fill Result::kept
+        std::uint64_t maxWorlds = 5000000;
+    };
+
+    struct Result {
+        std::uint64_t worlds = 0;
+        std::vector<double> evil;         // per seat: share of worlds in which the seat is evil
+        std::vector<double> demon;        // per seat: share of worlds in which it is the Demon
+        std::vector<World> kept;
+        bool truncated = false;           // stopped at Options::maxWorlds
+        qint64 elapsedMs = 0;
+        QString error;                    // the state cannot be analysed at all
+    };
+
+    explicit WorldSolver(const GameState &state);
+
+    Result solve(const Options &options) const;
+    Result solve() const { return solve(Options{}); }
+
+    // Whether `record` could have been given truthfully in `world`, ignoring
+    // who received it. Used to test candidate info against cached worlds.
+    bool infoHolds(const World &world, const InfoRecord &record) const;
+
+    // Whether a world (e.g. one cached from an earlier solve) still fits the
+    // claims and the whole info log
+    bool fitsInfo(const World &world) const { return consistent(world); }
+
+    // For each record, how many distinct evil teams (evil seats + Demon seat)
+    // among `worlds` it could be true under. Unclaimed seats are judged by the
+    // character the world holds for them. `teams` receives the number of
+    // distinct evil teams in `worlds`. Records are scored on a thread pool.
+    std::vector<std::uint32_t> teamsKeptAlive(const std::vector<World> &worlds,
+                                              const std::vector<InfoRecord> &records,
+                                              std::uint32_t *teams = nullptr, int threads = 0) const;
+
+    const std::vector<Character> &characters() const { return chars; }
+    int seatCount() const { return n; }
+    QString error() const { return setupError; }
+
+private:
+    enum class FactKind { Ping, NoOutsiders, Chef, Empath, Fortune };
+
+    struct Fact {
+        FactKind kind = FactKind::Ping;
+        int seat = 0;
+        int night = 0;
+        int role = -1;                    // character index of the ability
+        std::uint32_t seats = 0;
+        int character = -1;               // character index shown, -1 if off script
+        SetupValidator::Team characterTeam = SetupValidator::Other;
+        int number = 0;
+        bool yes = false;
+    };
+
+    struct CharInfo {
+        SetupValidator::Team team = SetupValidator::Other;
+        bool drunk = false;
+        bool spy = false;
+        bool recluse = false;
+        int poisons = 0;                  // seats it can poison per night
+        SetupModifier mod;
+    };
+
+    struct Search;
+
+    bool toFact(const InfoRecord &record, Fact &fact) const;
+    bool factHolds(const Fact &fact, const World &w, std::uint32_t spies, std::uint32_t recluses) const;
+    bool consistent(const World &w) const;
+    bool countsFit(std::uint64_t inPlay, int openSeats, std::uint64_t openChars) const;
+
+    void searchDemon(int demonSeat, Search &search) const;
+    void chooseMinions(Search &search, int from, int remaining) const;
+    void assignMinions(Search &search, int index) const;
+    bool assignGood(Search &search, int index) const;
+    bool leaf(Search &search) const;
+
+    int n = 0;
+    std::vector<Character> chars;
+    std::vector<CharInfo> info;
+    std::unordered_map<QString, int> indexById;                       // script characters
+    std::unordered_map<QString, SetupValidator::Team> teamById;      // every known character
+    std::uint64_t demonChars = 0, minionChars = 0, goodChars = 0, outsiderChars = 0;
+    std::uint64_t modifierChars = 0;                                  // change the setup, e.g. the Baron
+    int drunkIndex = -1;
+
+    std::array<std::uint64_t, MaxSeats> candidates{};  // characters each seat may really be
+    std::array<int, MaxSeats> claims{};                // good claim per seat, -1 if none
+    std::uint32_t allSeats = 0;
+    std::uint32_t travellers = 0;
+    std::uint32_t mustBeEvil = 0;
+    std::vector<std::uint32_t> sharedClaims;           // seats claiming the same good character
+
+    int baseMinions = 0, baseOutsiders = 0, baseGood = 0;
+    std::vector<int> minionCounts;                     // possible minion totals after modifiers
+
+    std::vector<Fact> facts;
+    QString setupError;
+};
@@ -0,0 +1,850 @@
+// Headless performance suite for the storyteller.
+//
+//   botc_bench [--json out.json] [--baseline base.json] [--threshold 0.15] [QtTest args]
+//
+// Runs under the offscreen QPA plugin. Results are written as JSON; with a
+// baseline the run fails if any benchmark is slower by more than threshold.
+#include "storyteller.h"
+#include "BluffSelectionDialog.h"
+#include "InfoGenerator.h"
+#include "FalseInfoRecommender.h"
+#include "BluffOptimiser.h"
+#include "WorldSolver.h"
+#include "GameArchive.h"
+#include "GameSimulator.h"
+#include "SetupStats.h"
+#include "AutomationServer.h"
+#include "GameCommands.h"
+#include "GrimoireLink.h"
+#include "PlayerServer.h"
+#include "TownSquareWidget.h"
+#include <QApplication>
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+#include <QtTest>
+#include <fstream>
+#include <random>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+static const QString repoDir = QStringLiteral(BOTC_REPO_DIR);
+
+static const QStringList scriptNames = {"Trouble Brewing", "Bad Moon Rising", "Sects and Violets"};
+
+class BotcBench : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void dbLoad();
+    void scriptLoad_data();
+    void scriptLoad();
+    void assignRandomCharacters_data();
+    void assignRandomCharacters();
+    void generateGame_data();
+    void generateGame();
+    void bluffSelection();
+    void nightOrder_data();
+    void nightOrder();
+    void grimoireRefresh_data();
+    void grimoireRefresh();
+    void townSquareUpdate();
+    void rapidResize();
+    void worldSolve();
+    void infoGeneration();
+    void falseInfoRanking();
+    void bluffRanking();
+    void newTable();
+    void winTracking();
+    void abilityResolution();
+    void phaseExpiry();
+    void abilityGraph();
+    void seatRing();
+    void automationBatch();
+    void automationSocket();
+    void playerPush_data();
+    void playerPush();
+    void grimoireSync();
+    void simulateGames_data();
+    void simulateGames();
+    void setupStats();
+    void archiveQuery_data();
+    void archiveQuery();
+    void archiveAfterReseat();
+
+private:
+    static void seatPlayers(StorytellerWindow &w, int count);
+    static void seatCounts(bool includeTwenty);
+
+    StorytellerWindow *window = nullptr;
+};
+
+void BotcBench::initTestCase() {
+    // The window resolves data as ../../<file>, i.e. relative to cpp/build
+    QString runDir = repoDir + "/cpp/build";
+    QDir().mkpath(runDir);
+    QVERIFY(QDir::setCurrent(runDir));
+
+    window = new StorytellerWindow(nullptr, false);
+    window->game.seed(20240601); // same samples every run
+    window->resize(1200, 900);
+    window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(window));
+    QVERIFY(!window->game.characterDB().empty());
+    QVERIFY(window->loadScriptFromPath(repoDir + "/scripts/Trouble Brewing.json"));
+}
+
+void BotcBench::cleanupTestCase() {
+    delete window;
+    window = nullptr;
+}
+
+void BotcBench::seatCounts(bool includeTwenty) {
+    QTest::addColumn<int>("seats");
+    for (int n : {5, 10, 15})
+        QTest::newRow(QByteArray::number(n)) << n;
+    if (includeTwenty)
+        QTest::newRow("20") << 20;
+}
+
+// Seats `count` players holding script characters (repeating past the script size)
+void BotcBench::seatPlayers(StorytellerWindow &w, int count) {
+    GameState &g = w.game;
+    g.players.clear();
+    for (int i = 0; i < count; ++i) {
+        Player p;
+        p.name = QString("Player %1").arg(i + 1);
+        p.character = g.scriptCharacters()[i % g.scriptCharacters().size()];
+        p.team = p.character.team;
+        p.effects = g.init_effects;
+        g.players.push_back(p);
+    }
+    g.rebuildTracker();
+}
+
+// ---------- Benchmarks ----------
+void BotcBench::dbLoad() {
+    QBENCHMARK {
+        window->loadCharacterDBFromPath(repoDir + "/Master_BotC.json");
+    }
+    QVERIFY(!window->game.characterDB().empty());
+}
+
+void BotcBench::scriptLoad_data() {
+    QTest::addColumn<QString>("script");
+    for (auto &name : scriptNames)
+        QTest::newRow(name.toUtf8()) << name;
+}
+
+void BotcBench::scriptLoad() {
+    QFETCH(QString, script);
+    QString path = repoDir + "/scripts/" + script + ".json";
+    QBENCHMARK {
+        window->loadScriptFromPath(path);
+    }
+    QVERIFY(!window->game.scriptCharacters().empty());
+    window->loadScriptFromPath(repoDir + "/scripts/Trouble Brewing.json");
+}
+
+void BotcBench::assignRandomCharacters_data() { seatCounts(false); }
+
+void BotcBench::assignRandomCharacters() {
+    QFETCH(int, seats);
+    seatPlayers(*window, seats);
+    QBENCHMARK {
+        window->assignRandomCharacters();
+    }
+}
+
+void BotcBench::generateGame_data() { seatCounts(false); }
+
+void BotcBench::generateGame() {
+    QFETCH(int, seats);
+    QBENCHMARK {
+        window->generateGame(seats);
+    }
+    QCOMPARE(int(window->game.players.size()), seats);
+}
+
+void BotcBench::bluffSelection() {
+    window->generateGame(10);
+    std::vector<Character> eligible = window->game.bluffCandidates();
+
+    QBENCHMARK {
+        window->chooseBluffs();
+        BluffSelectionDialog dlg(eligible, {}, window);
+    }
+}
+
+void BotcBench::nightOrder_data() { seatCounts(false); }
+
+void BotcBench::nightOrder() {
+    QFETCH(int, seats);
+    window->generateGame(seats);
+    QBENCHMARK {
+        auto order = window->game.nightOrder(true);
+        QCOMPARE(int(order.size()), seats);
+    }
+}
+
+void BotcBench::grimoireRefresh_data() { seatCounts(true); }
+
+void BotcBench::grimoireRefresh() {
+    QFETCH(int, seats);
+    seatPlayers(*window, seats);
+    QBENCHMARK {
+        window->refreshPlayersCircle();
+        window->grimoire->repaint();
+    }
+}
+
+// A death and a spent ghost vote reaching the players' screen: each repaints
+// one seat, not the circle
+void BotcBench::townSquareUpdate() {
+    seatPlayers(*window, 15);
+    GameState &g = window->game;
+    TownSquareWidget view(g);
+    view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&view));
+    int round = 0;
+    QBENCHMARK {
+        int seat = round++ % 15;
+        g.toggleEffect(seat, "Dead");
+        g.setGhostVote(seat, !g.players[seat].ghostVote);
+        QCoreApplication::processEvents();
+    }
+}
+
+void BotcBench::rapidResize() {
+    seatPlayers(*window, 15);
+    window->refreshPlayersCircle();
+    QBENCHMARK {
+        for (int i = 0; i < 20; ++i) {
+            window->resize(1000 + (i % 10) * 40, 900 + (i % 5) * 20);
+            QCoreApplication::processEvents();
+        }
+    }
+    window->resize(1200, 900);
+}
+
+// 15-player Trouble Brewing: good players claim themselves, evil and the Drunk bluff
+void BotcBench::worldSolve() {
+    window->generateGame(15);
+    GameState &g = window->game;
+    size_t bluff = 0;
+    for (auto &p : g.players) {
+        bool lies = p.character.team == "minion" || p.character.team == "demon" || p.character.id == "drunk";
+        p.claim = lies ? (bluff < g.bluffs.size() ? g.bluffs[bluff++].id : QString()) : p.character.id;
+    }
+
+    WorldSolver::Result result;
+    QBENCHMARK {
+        result = WorldSolver(g).solve();
+    }
+    QVERIFY(result.worlds > 0);
+    QVERIFY(!result.truncated);
+}
+
+// Every seat in a 15-player game holds each info character in turn
+void BotcBench::infoGeneration() {
+    window->generateGame(15);
+    GameState &g = window->game;
+    const QStringList roles = {"washerwoman", "librarian", "investigator", "chef", "empath", "fortuneteller"};
+
+    size_t outputs = 0;
+    QBENCHMARK {
+        for (auto &role : roles) {
+            Character saved = g.players[0].character;
+            g.players[0].character = g.characterDB().at(role);
+            InfoGenerator gen(g);
+            outputs += gen.trueInfo(0).size() + gen.falseInfo(0).size();
+            g.players[0].character = saved;
+        }
+    }
+    QVERIFY(outputs > 0);
+}
+
+// Poisoned Investigator in a fully claimed 15-player game; the first ranking
+// solves, later ones reuse the cached worlds
+void BotcBench::falseInfoRanking() {
+    window->generateGame(15);
+    GameState &g = window->game;
+    size_t bluff = 0;
+    for (auto &p : g.players) {
+        bool lies = p.character.team == "minion" || p.character.team == "demon" || p.character.id == "drunk";
+        p.claim = lies ? g.bluffs[bluff++ % g.bluffs.size()].id : p.character.id;
+    }
+    int seat = 0;
+    while (g.players[seat].character.team != "townsfolk") ++seat;
+    g.players[seat].character = g.characterDB().at("investigator");
+    g.players[seat].claim = "investigator";
+    g.setEffect(seat, "Poisoned", true);
+
+    std::vector<InfoRecord> lies = InfoGenerator(g).falseInfo(seat);
+    FalseInfoRecommender recommender;
+    FalseInfoRecommender::Ranking ranking;
+    QBENCHMARK {
+        ranking = recommender.rank(g, lies);
+    }
+    QVERIFY(ranking.error.isEmpty());
+    QCOMPARE(ranking.suggestions.size(), lies.size());
+}
+
+// Every Townsfolk and Outsider in the database as the script: ~100 eligible bluffs
+void BotcBench::bluffRanking() {
+    GameState &g = window->game;
+    window->generateGame(15);
+    std::shared_ptr<const Script> script = g.sharedScript();
+    auto everything = std::make_shared<Script>(*script);
+    everything->characters.clear();
+    for (auto &kv : g.characterDB()) everything->characters.push_back(kv.second);
+    g.setScript(everything);
+
+    std::vector<BluffOptimiser::Option> ranked;
+    QBENCHMARK {
+        BluffOptimiser optimiser(g);
+        ranked = optimiser.rank(10);
+    }
+    g.setScript(script);
+    QCOMPARE(int(ranked.size()), 10);
+    QVERIFY(ranked.front().score >= ranked.back().score);
+}
+
+// A new tab's game: shares the database and script, copies neither
+void BotcBench::newTable() {
+    const GameState &g = window->game;
+    QVERIFY(!g.scriptCharacters().empty());
+    QBENCHMARK {
+        GameState table;
+        table.shareData(g);
+        QVERIFY(table.sharedCharacterDB() == g.sharedCharacterDB());
+    }
+}
+
+// Kills and revives every seat in turn; the tracker must match a full rescan
+void BotcBench::winTracking() {
+    GameState &g = window->game;
+    window->generateGame(15);
+    const int n = int(g.players.size());
+
+    QBENCHMARK {
+        for (int i = 0; i < n; ++i) g.toggleEffect(i, "Dead");
+        for (int i = 0; i < n; ++i) g.toggleEffect(i, "Dead");
+        g.takeAlerts();
+    }
+
+    g.setEffect(0, "Dead", true);
+    int alive = 0, demons = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!g.isAlive(i)) continue;
+        ++alive;
+        if (g.players[i].team == "demon") ++demons;
+    }
+    QCOMPARE(g.winTracker().aliveNonTravellers(), alive);
+    QCOMPARE(g.winTracker().aliveDemons(), demons);
+    g.setEffect(0, "Dead", false);
+    g.takeAlerts();
+}
+
+// Poisoner, Monk and Imp on rotating targets, straight on the VM state
+void BotcBench::abilityResolution() {
+    GameState &g = window->game;
+    QVERIFY(g.abilityRules().abilityCount() > 0);
+    window->generateGame(15);
+    g.first_night = false;
+
+    const AbilityRules &rules = g.abilityRules();
+    const int poisoner = rules.abilityFor("poisoner", false);
+    const int monk = rules.abilityFor("monk", false);
+    const int imp = rules.abilityFor("imp", false);
+    QVERIFY(poisoner >= 0 && monk >= 0 && imp >= 0);
+
+    AbilityRules::State base = g.ruleState();
+    const int n = base.seats();
+    constexpr int Nights = 100000;
+    int resolved = 0;
+    QBENCHMARK {
+        AbilityRules::State s = base;
+        resolved = 0;
+        for (int night = 0; night < Nights; ++night) {
+            AbilityRules::dusk(s);
+            resolved += rules.run(poisoner, s, 0, night % n);
+            resolved += rules.run(monk, s, 1, (night + 3) % n);
+            resolved += rules.run(imp, s, 2, (night + 7) % n);
+            AbilityRules::dawn(s);
+            s.effects[(night + 7) % n] &= ~(std::uint64_t(1) << AbilityRules::DeadBit);
+        }
+    }
+    QVERIFY(resolved > 0);
+    g.first_night = true;
+}
+
+// Two timed reminders a night on a 15-seat circle, expired at dusk and dawn
+void BotcBench::phaseExpiry() {
+    constexpr int Nights = 100000;
+    long expired = 0;
+    QBENCHMARK {
+        PhaseScheduler scheduler;
+        std::vector<PhaseScheduler::Due> due;
+        const int poisoned = scheduler.effectId("Poisoned");
+        const int safe = scheduler.effectId("Safe");
+        expired = 0;
+        for (int night = 0; night < Nights; ++night) {
+            scheduler.schedule(night % 15, poisoned, scheduler.tickFor(PhaseScheduler::Dusk));
+            scheduler.schedule((night + 3) % 15, safe, scheduler.tickFor(PhaseScheduler::Dawn));
+            scheduler.advance(PhaseScheduler::Dawn, due);
+            expired += long(due.size());
+            scheduler.advance(PhaseScheduler::Dusk, due);
+            expired += long(due.size());
+        }
+    }
+    QCOMPARE(expired, 2L * Nights);
+}
+
+// A long 15-player game: each night the Poisoner (seat 0) poisons someone
+// new, a Sailor (seat 1) makes someone drunk, and every few nights the
+// Sailor picks the Poisoner, which lifts the poison cascade behind it
+void BotcBench::abilityGraph() {
+    constexpr int Nights = 100000;
+    long flips = 0;
+    QBENCHMARK {
+        AbilityGraph graph;
+        graph.reset(15);
+        int poisoned = -1, drunk = -1;
+        flips = 0;
+        for (int night = 0; night < Nights; ++night) {
+            if (poisoned >= 0) flips += long(graph.clearEffect(poisoned, AbilityGraph::Poisoned).size());
+            if (drunk >= 0) flips += long(graph.clearEffect(drunk, AbilityGraph::Drunk).size());
+            drunk = night % 4 == 0 ? 0 : 2 + night % 13;
+            flips += long(graph.addEdge(1, drunk, AbilityGraph::Drunk).size());
+            poisoned = 2 + (night * 7) % 13;
+            flips += long(graph.addEdge(0, poisoned, AbilityGraph::Poisoned).size());
+        }
+    }
+    QVERIFY(flips > Nights);
+}
+
+// Kills, revivals, a Traveller joining and leaving, and both neighbours of
+// every seat after each change, around a 20-seat circle
+void BotcBench::seatRing() {
+    constexpr int Rounds = 100000;
+    long sum = 0;
+    QBENCHMARK {
+        SeatRing ring(20);
+        sum = 0;
+        for (int round = 0; round < Rounds; ++round) {
+            ring.setAlive((round * 7) % 20, false);
+            ring.setAlive((round * 3) % 20, true);
+            if (round % 16 == 0) ring.insert(round % 20);
+            if (round % 16 == 8) ring.remove(round % ring.size());
+            for (int seat = 0; seat < ring.size(); ++seat)
+                sum += ring.neighbour(seat, false) + ring.neighbour(seat, true);
+        }
+    }
+    QVERIFY(sum > 0);
+}
+
+// A round's 40 players and their seating pushed as one transaction
+void BotcBench::automationBatch() {
+    json batch = json::array(), order = json::array();
+    for (int i = 0; i < 40; ++i) batch.push_back({{"cmd", "addPlayer"}, {"name", "Player " + std::to_string(i)}});
+    for (int i = 39; i >= 0; --i) order.push_back("Player " + std::to_string(i));
+    batch.push_back({{"cmd", "seat"}, {"order", order}});
+    const json message = {{"id", 1}, {"batch", batch}};
+
+    json reply;
+    QBENCHMARK {
+        GameState table;
+        table.shareData(window->game);
+        bool changed = false;
+        reply = GameCommands::run(table, message, changed);
+    }
+    QVERIFY2(reply.value("ok", false), reply.dump().c_str());
+}
+
+// Single commands over a local socket into the window; the grimoire is
+// redrawn once per burst rather than per command
+void BotcBench::automationSocket() {
+    constexpr int Messages = 5000;
+    window->generateGame(15);
+    AutomationServer server([this](const json &message) { return window->runCommands(message); });
+    QVERIFY2(server.start(QString("botc-bench-%1").arg(QCoreApplication::applicationPid())),
+             qPrintable(server.errorString()));
+
+    QLocalSocket client;
+    client.connectToServer(server.serverName());
+    QVERIFY(client.waitForConnected(1000));
+    QByteArray lines;
+    for (int i = 0; i < Messages; ++i)
+        lines += QByteArray::fromStdString(json{{"id", i}, {"cmd", "effect"}, {"player", i % 15},
+                                                {"effect", "Poisoned"}, {"on", i % 2 == 0}}.dump()) + '\n';
+
+    QBENCHMARK {
+        client.readAll();
+        client.write(lines);
+        int replies = 0;
+        QVERIFY(QTest::qWaitFor([&]() {
+            while (client.canReadLine()) {
+                client.readLine();
+                ++replies;
+            }
+            return replies == Messages;
+        }, 10000));
+    }
+}
+
+// A simulated phone: upgrades to WebSocket and counts the frames it is sent
+struct TestPhone {
+    QTcpSocket socket;
+    QByteArray buffer;
+    bool upgraded = false;
+    int frames = 0;
+
+    void read() {
+        buffer += socket.readAll();
+        if (!upgraded) {
+            qsizetype end = buffer.indexOf("\r\n\r\n");
+            if (end < 0) return;
+            upgraded = buffer.startsWith("HTTP/1.1 101");
+            buffer.remove(0, end + 4);
+        }
+        while (buffer.size() >= 2) {
+            qsizetype pos = 2, length = quint8(buffer[1]) & 0x7f;
+            if (length == 126) {
+                if (buffer.size() < 4) return;
+                length = qsizetype(quint8(buffer[2])) << 8 | quint8(buffer[3]);
+                pos = 4;
+            }
+            if (buffer.size() < pos + length) return;
+            buffer.remove(0, pos + length);
+            ++frames;
+        }
+    }
+};
+
+void BotcBench::playerPush_data() {
+    QTest::addColumn<int>("phones");
+    QTest::newRow("20") << 20;
+    QTest::newRow("60") << 60;
+}
+
+// Load test for the phone server: 20 players with one or more phones each
+// on loopback, one death per round. Each round waits until every phone of
+// that player has its update, and the slowest round must stay under 50 ms.
+void BotcBench::playerPush() {
+    QFETCH(int, phones);
+    constexpr int Players = 20;
+    seatPlayers(*window, Players);
+    GameState &g = window->game;
+    PlayerServer server(g);
+    QVERIFY2(server.start(QHostAddress::LocalHost), qPrintable(server.errorString()));
+
+    std::vector<std::unique_ptr<TestPhone>> clients;
+    for (int i = 0; i < phones; ++i) {
+        auto phone = std::make_unique<TestPhone>();
+        TestPhone *p = phone.get();
+        connect(&p->socket, &QTcpSocket::readyRead, this, [p]() { p->read(); });
+        p->socket.connectToHost(QHostAddress::LocalHost, server.port());
+        p->socket.write("GET /ws?t=" + server.tokenFor(i % Players).toLatin1() + " HTTP/1.1\r\nHost: localhost\r\n"
+                        "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n");
+        clients.push_back(std::move(phone));
+    }
+    QTRY_COMPARE(server.phoneCount(), phones);
+    QTRY_VERIFY(std::all_of(clients.begin(), clients.end(), [](const auto &c) { return c->frames == 1; }));
+
+    std::vector<int> changes(Players, 0);
+    qint64 worstNs = 0;
+    int round = 0;
+    QBENCHMARK {
+        const int seat = round++ % Players;
+        ++changes[seat];
+        QElapsedTimer timer;
+        timer.start();
+        g.toggleEffect(seat, "Dead");
+        auto delivered = [&]() {
+            for (int i = seat; i < phones; i += Players)
+                if (clients[i]->frames != 1 + changes[seat]) return false;
+            return true;
+        };
+        // Spin rather than qWaitFor(), whose sleeps would be timed too
+        while (!delivered() && timer.elapsed() < 1000)
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+        QVERIFY(delivered());
+        worstNs = std::max(worstNs, timer.nsecsElapsed());
+    }
+    // Nobody hears about anyone else
+    QCoreApplication::processEvents();
+    for (int i = 0; i < phones; ++i) QCOMPARE(clients[i]->frames, 1 + changes[i % Players]);
+    qInfo().noquote() << QString("slowest update %1 ms").arg(worstNs / 1e6, 0, 'f', 2);
+    QVERIFY(worstNs < 50 * 1000 * 1000);
+}
+
+// Three instances in a star on local sockets each make a burst of 100 kills,
+// revivals and effect changes at once; timed until all three agree
+void BotcBench::grimoireSync() {
+    constexpr int Replicas = 3, Burst = 100;
+    window->generateGame(12);
+    const QString session = QString("bench-%1").arg(QCoreApplication::applicationPid());
+    std::vector<std::unique_ptr<GameState>> games;
+    std::vector<std::unique_ptr<GrimoireSync>> syncs;
+    std::vector<std::unique_ptr<GrimoireLink>> links;
+    for (int r = 0; r < Replicas; ++r) {
+        games.push_back(std::make_unique<GameState>(window->game));
+        syncs.push_back(std::make_unique<GrimoireSync>(*games.back(), r + 1));
+        links.push_back(std::make_unique<GrimoireLink>(*syncs.back()));
+        QVERIFY2(links.back()->join(session), qPrintable(links.back()->errorString()));
+    }
+    auto converged = [&]() {
+        for (int r = 1; r < Replicas; ++r)
+            if (syncs[r]->replica().clock() != syncs[0]->replica().clock()
+                || syncs[r]->replica().digest() != syncs[0]->replica().digest()) return false;
+        return true;
+    };
+    QTRY_COMPARE(links[0]->peerCount(), Replicas - 1);
+    QTRY_VERIFY(converged());
+
+    const QString effects[] = {"Dead", "Poisoned", "Drunk"};
+    std::mt19937 rng(20240601);
+    QBENCHMARK {
+        for (auto &g : games)
+            for (int k = 0; k < Burst; ++k) g->toggleEffect(int(rng() % g->players.size()), effects[rng() % 3]);
+        QElapsedTimer timer;
+        timer.start();
+        while (!converged() && timer.elapsed() < 5000)
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+        QVERIFY(converged());
+    }
+    for (auto &s : syncs) QVERIFY(s->inStep());
+    // The grimoires themselves, not only the replicas, agree seat by seat
+    for (int r = 1; r < Replicas; ++r) {
+        QCOMPARE(games[r]->players.size(), games[0]->players.size());
+        for (int i = 0; i < int(games[0]->players.size()); ++i)
+            for (const QString &effect : effects)
+                QCOMPARE(games[r]->hasEffect(i, effect), games[0]->hasEffect(i, effect));
+    }
+}
+
+void BotcBench::simulateGames_data() {
+    QTest::addColumn<int>("threads");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("all cores") << 0;
+}
+
+// Whole Trouble Brewing games between bots; the log shows games per second
+void BotcBench::simulateGames() {
+    QFETCH(int, threads);
+    QVERIFY(window->loadScriptFromPath(repoDir + "/scripts/Trouble Brewing.json"));
+    GameSimulator simulator(window->game);
+    GameSimulator::Options options;
+    options.games = 20000;
+    options.threads = threads;
+    options.seed = 20240601;
+    GameSimulator::Report report;
+    QBENCHMARK {
+        report = simulator.run(options);
+    }
+    QVERIFY2(report.error.isEmpty(), qPrintable(report.error));
+    QCOMPARE(report.games, options.games);
+    qInfo().noquote() << QString("%1 games/s, good wins %2%")
+                             .arg(report.gamesPerSecond, 0, 'f', 0)
+                             .arg(100.0 * report.goodWins / report.games, 0, 'f', 1);
+}
+
+// Every pair of characters at 5-15 players, for each bundled script
+void BotcBench::setupStats() {
+    std::vector<std::vector<Character>> scripts;
+    for (const char *name : {"Trouble Brewing", "Bad Moon Rising", "Sects and Violets"}) {
+        QVERIFY(window->loadScriptFromPath(repoDir + "/scripts/" + name + ".json"));
+        scripts.push_back(window->game.scriptCharacters());
+    }
+    double sink = 0.0;
+    QBENCHMARK {
+        for (const std::vector<Character> &script : scripts) {
+            SetupStats stats(script);
+            for (int players = 5; players <= 15; ++players)
+                for (const std::vector<double> &row : stats.pairwise(players)) sink += row.front();
+        }
+    }
+    QVERIFY(sink > 0.0);
+
+    // Trouble Brewing at 7: 5 good in play out of 13 Townsfolk and 4 Outsiders
+    SetupStats tb(scripts.front());
+    QCOMPARE(SetupStats::toString(tb.setups(7)), QString("5577"));
+    const std::map<int, double> pool = tb.bluffPool(7);
+    QCOMPARE(int(pool.size()), 1);
+    QCOMPARE(pool.begin()->first, 12);
+    QCOMPARE(pool.begin()->second, 1.0);
+}
+
+void BotcBench::archiveQuery_data() {
+    QTest::addColumn<int>("threads");
+    QTest::newRow("1 thread") << 1;
+    QTest::newRow("all cores") << 0;
+}
+
+// Three club questions over 1.28M archived games: simulated Trouble Brewing
+// games, doubled up, and saved and loaded on the way
+void BotcBench::archiveQuery() {
+    QFETCH(int, threads);
+    static GameArchive archive;
+    if (archive.games() == 0) {
+        QVERIFY(window->loadScriptFromPath(repoDir + "/scripts/Trouble Brewing.json"));
+        GameSimulator simulator(window->game);
+        GameSimulator::Options options;
+        options.games = 20000;
+        options.seed = 20240601;
+        options.archive = &archive;
+        GameSimulator::Report report = simulator.run(options);
+        QVERIFY2(report.error.isEmpty(), qPrintable(report.error));
+        while (archive.games() < 1000000) {
+            GameArchive copy = archive;
+            archive.append(copy);
+        }
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        QVERIFY(!archive.save(dir.filePath("games.botcarc")));
+        QVERIFY(!archive.load(dir.filePath("games.botcarc")));
+    }
+
+    GameArchive::Query impAtEight;
+    impAtEight.with = {"imp"};
+    impAtEight.minPlayers = impAtEight.maxPlayers = 8;
+    GameArchive::Query drunk;
+    drunk.with = {"drunk"};
+    drunk.watch = "drunk";
+    drunk.groupBy = GameArchive::ByPlayers;
+    GameArchive::Query evilByCharacter;
+    evilByCharacter.winner = GameArchive::Evil;
+    evilByCharacter.groupBy = GameArchive::ByCharacter;
+    for (GameArchive::Query *q : {&impAtEight, &drunk, &evilByCharacter}) q->threads = threads;
+    archive.query(impAtEight);   // builds the character bitsets
+
+    qint64 slowestUs = 0;
+    GameArchive::Result results[3];
+    QBENCHMARK {
+        results[0] = archive.query(impAtEight);
+        results[1] = archive.query(drunk);
+        results[2] = archive.query(evilByCharacter);
+        for (const GameArchive::Result &r : results) slowestUs = std::max(slowestUs, r.elapsedUs);
+    }
+    QVERIFY(results[0].matched > 0);
+    QCOMPARE(results[0].rows.front().games, results[0].matched);
+    QVERIFY(results[1].matched > 0);
+    QVERIFY(!results[2].rows.empty());
+    QVERIFY2(slowestUs < 1000000, qPrintable(QString("slowest query %1 ms").arg(slowestUs / 1000.0)));
+    qInfo().noquote() << QString("%1 games, slowest query %2 ms")
+                             .arg(archive.games()).arg(slowestUs / 1000.0, 0, 'f', 2);
+}
+
+// Reseating after an execution: the archive names whoever was executed,
+// not whoever sits in that seat now
+void BotcBench::archiveAfterReseat() {
+    QVERIFY(window->loadScriptFromPath(repoDir + "/scripts/Trouble Brewing.json"));
+    GameState game(window->game);
+    QVERIFY(!game.generateGame(7));
+    QVERIFY(!game.execute(2));
+    const QString executed = game.players[2].character.id;
+    QVERIFY(!game.seatPlayers({6, 5, 4, 3, 2, 1, 0}));
+
+    GameArchive archive;
+    archive.append(GameArchive::fromState(game, GameArchive::Unfinished));
+    GameArchive::Game record = archive.game(0);
+    QCOMPARE(record.days.front().executed, 4);
+    QCOMPARE(record.seats[4].character, executed);
+    GameArchive::Query query;
+    query.executed = {executed};
+    QCOMPARE(archive.query(query).matched, 1L);
+}
+
+// ---------- Results ----------
+// Turns the QtTest XML log into {"benchmarks": {"function/tag": {...}}}
+static json xmlToJson(const QString &xmlPath) {
+    json out = {{"benchmarks", json::object()}};
+    QFile f(xmlPath);
+    if (!f.open(QIODevice::ReadOnly)) return out;
+
+    QXmlStreamReader xml(&f);
+    QString function;
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (!xml.isStartElement()) continue;
+        if (xml.name() == QLatin1String("TestFunction")) {
+            function = xml.attributes().value("name").toString();
+        } else if (xml.name() == QLatin1String("BenchmarkResult")) {
+            auto attrs = xml.attributes();
+            QString tag = attrs.value("tag").toString();
+            QString name = tag.isEmpty() ? function : function + "/" + tag;
+            out["benchmarks"][name.toStdString()] = {
+                {"metric", attrs.value("metric").toString().toStdString()},
+                {"value", attrs.value("value").toDouble()},
+                {"iterations", attrs.value("iterations").toInt()}
+            };
+        }
+    }
+    return out;
+}
+
+// Number of benchmarks slower than baseline by more than threshold
+static int compareToBaseline(const json &current, const json &baseline, double threshold) {
+    int regressions = 0;
+    for (auto &it : current["benchmarks"].items()) {
+        if (!baseline["benchmarks"].contains(it.key())) continue;
+        double now = it.value()["value"].get<double>();
+        double before = baseline["benchmarks"][it.key()]["value"].get<double>();
+        if (before <= 0) continue;
+        double change = (now - before) / before;
+        if (change > threshold) {
+            ++regressions;
+            qWarning().noquote() << QString("REGRESSION %1: %2 -> %3 (+%4%)")
+                                        .arg(QString::fromStdString(it.key()))
+                                        .arg(before).arg(now).arg(change * 100, 0, 'f', 1);
+        }
+    }
+    return regressions;
+}
+
+int main(int argc, char **argv) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QString jsonPath = "botc_bench.json";
+    QString baselinePath;
+    double threshold = 0.15;
+
+    QStringList testArgs = {app.arguments().first()};
+    QStringList args = app.arguments().mid(1);
+    for (int i = 0; i < args.size(); ++i) {
+        if (args[i] == "--json" && i + 1 < args.size()) jsonPath = args[++i];
+        else if (args[i] == "--baseline" && i + 1 < args.size()) baselinePath = args[++i];
+        else if (args[i] == "--threshold" && i + 1 < args.size()) threshold = args[++i].toDouble();
+        else testArgs << args[i];
+    }
+
+    QTemporaryDir tmp;
+    QString xmlPath = tmp.filePath("bench.xml");
+    testArgs << "-o" << "-,txt" << "-o" << xmlPath + ",xml";
+
+    BotcBench bench;
+    int failures = QTest::qExec(&bench, testArgs);
+
+    json results = xmlToJson(xmlPath);
+    std::ofstream(jsonPath.toStdString()) << results.dump(2) << "\n";
+
+    if (!baselinePath.isEmpty()) {
+        std::ifstream f(baselinePath.toStdString());
+        json baseline;
+        try { f >> baseline; }
+        catch (...) { qWarning() << "Cannot read baseline" << baselinePath; return 2; }
+        if (compareToBaseline(results, baseline, threshold) > 0) return 1;
+    }
+
+    return failures ? 1 : 0;
+}
+
+#include "botc_bench.moc"
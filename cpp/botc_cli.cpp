@@ -0,0 +1,432 @@
+// Headless tools over botc_core.
+//
+//   botc_cli simulate --script <script.json> [--db Master_BotC.json] [--games N]
+//                     [--players 5-15] [--threads N] [--seed N] [--days N]
+//                     [--setups N] [--json out.json] [--archive games.botcarc]
+//                     [--<heuristic> value]
+//
+// simulate plays whole games between bots (see GameSimulator) and prints win
+// rates by Demon, by player count and for the most played setups. Heuristic
+// knobs: --info-reliability, --info-weight, --double-claim, --evil-sway,
+// --nominate, --vote, --noise, --nominations. --archive appends the games
+// played to a game archive.
+//
+//   botc_cli stats --script <script.json> [--db Master_BotC.json]
+//                  [--players 5-15] [--pair a,b] [--json out.json]
+//
+// stats prints exact setup odds (see SetupStats): setups per player count,
+// the chance each character is in play, the bluff pool size and, with
+// --pair, the chance two characters are in play together.
+//
+//   botc_cli sync --session <name> --script <script.json> [--db Master_BotC.json]
+//                 [--players N] [--peers N] [--edits N] [--burst N] [--seed N]
+//                 [--idle ms] [--timeout ms]
+//
+// sync runs a grimoire replica in a sync session (see GrimoireLink): it
+// deals a game of --players first if asked, waits for --peers peers, makes
+// --edits random kills, revivals and effect changes in bursts of --burst
+// per 10 ms, and once nothing has arrived for --idle ms prints its digest
+// as JSON. Replicas of one session that print the same digest hold the
+// same grimoire, e.g. two processes started with different seeds.
+//
+//   botc_cli query --archive <games.botcarc> [--script name] [--players 5-15]
+//                  [--winner good|evil|unfinished] [--with a,b] [--without a,b]
+//                  [--executed a,b] [--not-executed a,b] [--watch id]
+//                  [--group-by none|script|players|winner|days|character|demon]
+//                  [--threads N] [--compact] [--json out.json]
+//
+// query filters and groups a game archive (see GameArchive): games, win
+// rates, days and deaths per group, and with --watch, how often that
+// character was executed. --compact rewrites the archive as one segment.
+// E.g. the Drunk going unexecuted: --with drunk --watch drunk.
+#include "GameArchive.h"
+#include "GameState.h"
+#include "GameSimulator.h"
+#include "GrimoireLink.h"
+#include "SetupStats.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTimer>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+static int usage() {
+    std::fprintf(stderr,
+        "usage: botc_cli simulate --script <script.json> [--db Master_BotC.json] [--games N]\n"
+        "                         [--players 5-15] [--threads N] [--seed N] [--days N]\n"
+        "                         [--setups N] [--json out.json] [--archive games.botcarc]\n"
+        "                         [--<heuristic> value]\n"
+        "       botc_cli stats --script <script.json> [--db Master_BotC.json]\n"
+        "                      [--players 5-15] [--pair a,b] [--json out.json]\n"
+        "       botc_cli sync --session <name> --script <script.json> [--db Master_BotC.json]\n"
+        "                     [--players N] [--peers N] [--edits N] [--burst N] [--seed N]\n"
+        "                     [--idle ms] [--timeout ms]\n"
+        "       botc_cli query --archive <games.botcarc> [--script name] [--players 5-15]\n"
+        "                      [--winner good|evil|unfinished] [--with a,b] [--without a,b]\n"
+        "                      [--executed a,b] [--not-executed a,b] [--watch id]\n"
+        "                      [--group-by none|script|players|winner|days|character|demon]\n"
+        "                      [--threads N] [--compact] [--json out.json]\n");
+    return 2;
+}
+
+static OpResult loadScript(GameState &state, const QString &dbPath, const QString &scriptPath) {
+    OpResult result = state.loadCharacterDB(dbPath);
+    if (!result) result = state.loadScript(scriptPath);
+    return result;
+}
+
+static void printTallies(const char *title, const std::vector<GameSimulator::Tally> &tallies) {
+    std::printf("\n%s\n", title);
+    for (const GameSimulator::Tally &t : tallies)
+        std::printf("  %-40s %8d games  good %5.1f%%  evil %5.1f%%\n", qPrintable(t.label), t.games,
+                    100.0 * t.goodRate(), t.games ? 100.0 * t.evilWins / t.games : 0.0);
+}
+
+static json talliesToJson(const std::vector<GameSimulator::Tally> &tallies) {
+    json out = json::array();
+    for (const GameSimulator::Tally &t : tallies)
+        out.push_back({{"label", t.label.toStdString()}, {"games", t.games},
+                       {"goodWins", t.goodWins}, {"evilWins", t.evilWins}});
+    return out;
+}
+
+// ---------- simulate ----------
+static int simulate(const QStringList &args) {
+    QString dbPath = "../../Master_BotC.json";
+    QString scriptPath;
+    QString jsonPath;
+    QString archivePath;
+    GameSimulator::Options options;
+    GameSimulator::Heuristics &h = options.heuristics;
+
+    for (int i = 0; i < args.size(); ++i) {
+        const QString &arg = args[i];
+        if (i + 1 >= args.size()) return usage();
+        const QString value = args[++i];
+        if (arg == "--db") dbPath = value;
+        else if (arg == "--script") scriptPath = value;
+        else if (arg == "--json") jsonPath = value;
+        else if (arg == "--archive") archivePath = value;
+        else if (arg == "--games") options.games = value.toInt();
+        else if (arg == "--threads") options.threads = value.toInt();
+        else if (arg == "--seed") options.seed = value.toUInt();
+        else if (arg == "--days") options.maxDays = value.toInt();
+        else if (arg == "--setups") options.topSetups = value.toInt();
+        else if (arg == "--players") {
+            QStringList range = value.split('-');
+            options.minPlayers = range.first().toInt();
+            options.maxPlayers = range.last().toInt();
+        }
+        else if (arg == "--info-reliability") h.infoReliability = value.toDouble();
+        else if (arg == "--info-weight") h.infoWeight = value.toDouble();
+        else if (arg == "--double-claim") h.doubleClaimWeight = value.toDouble();
+        else if (arg == "--evil-sway") h.evilSway = value.toDouble();
+        else if (arg == "--nominate") h.nominateThreshold = value.toDouble();
+        else if (arg == "--vote") h.voteThreshold = value.toDouble();
+        else if (arg == "--noise") h.noise = value.toDouble();
+        else if (arg == "--nominations") h.maxNominations = value.toInt();
+        else return usage();
+    }
+    if (scriptPath.isEmpty()) return usage();
+
+    GameState state;
+    if (OpResult result = loadScript(state, dbPath, scriptPath)) {
+        std::fprintf(stderr, "%s: %s\n", qPrintable(result->title), qPrintable(result->message));
+        return 1;
+    }
+
+    GameArchive archive;
+    if (!archivePath.isEmpty()) options.archive = &archive;
+    GameSimulator simulator(state);
+    GameSimulator::Report report = simulator.run(options);
+    if (!report.error.isEmpty()) {
+        std::fprintf(stderr, "Simulate: %s\n", qPrintable(report.error));
+        return 1;
+    }
+    if (!archivePath.isEmpty()) {
+        if (OpResult result = archive.appendToFile(archivePath)) {
+            std::fprintf(stderr, "%s: %s\n", qPrintable(result->title), qPrintable(result->message));
+            return 1;
+        }
+    }
+
+    std::printf("%d games in %lld ms (%.0f games/s), %.1f days on average\n", report.games,
+                static_cast<long long>(report.elapsedMs), report.gamesPerSecond, report.averageDays);
+    std::printf("good %.1f%%  evil %.1f%%  unfinished %d\n", 100.0 * report.goodWins / std::max(1, report.games),
+                100.0 * report.evilWins / std::max(1, report.games), report.unfinished);
+    printTallies("By Demon", report.byDemon);
+    printTallies("By player count", report.byPlayers);
+    printTallies("Most played setups", report.bySetup);
+
+    if (!jsonPath.isEmpty()) {
+        json out = {
+            {"games", report.games}, {"goodWins", report.goodWins}, {"evilWins", report.evilWins},
+            {"unfinished", report.unfinished}, {"averageDays", report.averageDays},
+            {"elapsedMs", report.elapsedMs}, {"gamesPerSecond", report.gamesPerSecond},
+            {"byDemon", talliesToJson(report.byDemon)},
+            {"byPlayers", talliesToJson(report.byPlayers)},
+            {"bySetup", talliesToJson(report.bySetup)}
+        };
+        std::ofstream(jsonPath.toStdString()) << out.dump(2) << "\n";
+    }
+    return 0;
+}
+
+// ---------- stats ----------
+static int stats(const QStringList &args) {
+    QString dbPath = "../../Master_BotC.json";
+    QString scriptPath;
+    QString jsonPath;
+    QStringList pair;
+    int minPlayers = 5, maxPlayers = 15;
+
+    for (int i = 0; i < args.size(); ++i) {
+        const QString &arg = args[i];
+        if (i + 1 >= args.size()) return usage();
+        const QString value = args[++i];
+        if (arg == "--db") dbPath = value;
+        else if (arg == "--script") scriptPath = value;
+        else if (arg == "--json") jsonPath = value;
+        else if (arg == "--pair") pair = value.split(',');
+        else if (arg == "--players") {
+            QStringList range = value.split('-');
+            minPlayers = range.first().toInt();
+            maxPlayers = range.last().toInt();
+        }
+        else return usage();
+    }
+    if (scriptPath.isEmpty() || (!pair.isEmpty() && pair.size() != 2)) return usage();
+
+    GameState state;
+    if (OpResult result = loadScript(state, dbPath, scriptPath)) {
+        std::fprintf(stderr, "%s: %s\n", qPrintable(result->title), qPrintable(result->message));
+        return 1;
+    }
+
+    SetupStats setupStats(state.scriptCharacters());
+    if (!setupStats.error().isEmpty()) {
+        std::fprintf(stderr, "Stats: %s\n", qPrintable(setupStats.error()));
+        return 1;
+    }
+    for (const QString &id : pair) {
+        if (setupStats.indexOf(id) < 0) {
+            std::fprintf(stderr, "Stats: %s is not dealt on this script\n", qPrintable(id));
+            return 1;
+        }
+    }
+
+    const std::vector<Character> &chars = setupStats.characters();
+    json out = json::object();
+    for (int players = minPlayers; players <= maxPlayers; ++players) {
+        const SetupStats::Count setups = setupStats.setups(players);
+        if (!setups) continue;
+        const std::vector<double> marginals = setupStats.marginals(players);
+
+        std::printf("\n%d players: %s setups\n", players, qPrintable(SetupStats::toString(setups)));
+        json row = {{"setups", SetupStats::toString(setups).toStdString()}};
+        json &inPlay = row["inPlay"] = json::object();
+        for (std::size_t i = 0; i < chars.size(); ++i) {
+            std::printf("  %-24s %6.2f%%\n", qPrintable(chars[i].name), 100.0 * marginals[i]);
+            inPlay[chars[i].id.toStdString()] = marginals[i];
+        }
+
+        std::printf("  bluff pool:");
+        json &pool = row["bluffPool"] = json::object();
+        for (const auto &entry : setupStats.bluffPool(players)) {
+            std::printf("  %d good %.2f%%", entry.first, 100.0 * entry.second);
+            pool[std::to_string(entry.first)] = entry.second;
+        }
+        std::printf("\n");
+
+        if (!pair.isEmpty()) {
+            const double p = setupStats.probability(players, pair[0], pair[1]);
+            std::printf("  %s and %s: %.2f%%\n", qPrintable(pair[0]), qPrintable(pair[1]), 100.0 * p);
+            row["pair"] = p;
+        }
+        out[std::to_string(players)] = row;
+    }
+
+    if (!jsonPath.isEmpty()) std::ofstream(jsonPath.toStdString()) << out.dump(2) << "\n";
+    return 0;
+}
+
+// ---------- sync ----------
+static int syncReplica(const QStringList &args) {
+    QString dbPath = "../../Master_BotC.json";
+    QString scriptPath, session;
+    int players = 0, peers = 1, edits = 200, burst = 20, idleMs = 2000, timeoutMs = 30000;
+    std::uint32_t seed = QRandomGenerator::global()->generate();
+
+    for (int i = 0; i < args.size(); ++i) {
+        const QString &arg = args[i];
+        if (i + 1 >= args.size()) return usage();
+        const QString value = args[++i];
+        if (arg == "--db") dbPath = value;
+        else if (arg == "--script") scriptPath = value;
+        else if (arg == "--session") session = value;
+        else if (arg == "--players") players = value.toInt();
+        else if (arg == "--peers") peers = value.toInt();
+        else if (arg == "--edits") edits = value.toInt();
+        else if (arg == "--burst") burst = std::max(1, value.toInt());
+        else if (arg == "--seed") seed = value.toUInt();
+        else if (arg == "--idle") idleMs = value.toInt();
+        else if (arg == "--timeout") timeoutMs = value.toInt();
+        else return usage();
+    }
+    if (scriptPath.isEmpty() || session.isEmpty()) return usage();
+
+    GameState state;
+    OpResult result = loadScript(state, dbPath, scriptPath);
+    state.seed(seed);
+    if (!result && players > 0) result = state.generateGame(players);
+    if (result) {
+        std::fprintf(stderr, "%s: %s\n", qPrintable(result->title), qPrintable(result->message));
+        return 1;
+    }
+
+    GrimoireSync replica(state, QRandomGenerator::global()->generate64());
+    GrimoireLink link(replica);
+    if (!link.join(session)) {
+        std::fprintf(stderr, "Sync: %s\n", qPrintable(link.errorString()));
+        return 1;
+    }
+
+    std::mt19937 rng(seed);
+    const QString effects[] = {"Dead", "Poisoned", "Drunk"};
+    int made = 0;
+    bool timedOut = false;
+    QElapsedTimer idle, total;
+    idle.start();
+    total.start();
+    QObject::connect(&link, &GrimoireLink::received, [&idle](int) { idle.restart(); });
+
+    QTimer tick;
+    QObject::connect(&tick, &QTimer::timeout, [&]() {
+        if (total.elapsed() > timeoutMs) {
+            timedOut = true;
+            QCoreApplication::quit();
+        } else if (link.peerCount() < peers && made == 0) {
+            idle.restart();
+        } else if (made < edits) {
+            for (int k = 0; k < burst && made < edits && !state.players.empty(); ++k, ++made) {
+                int seat = int(rng() % state.players.size());
+                if (rng() % 50 == 0) state.advanceDay();
+                else state.toggleEffect(seat, effects[rng() % 3]);
+            }
+            idle.restart();
+        } else if (idle.elapsed() >= idleMs) {
+            QCoreApplication::quit();
+        }
+    });
+    tick.start(10);
+    QCoreApplication::exec();
+
+    json out = {
+        {"replica", replica.replica().id()}, {"digest", QString::number(replica.replica().digest(), 16).toStdString()},
+        {"inStep", replica.inStep()}, {"ops", replica.replica().log().size()}, {"edits", made},
+        {"players", state.players.size()}, {"day", state.day}, {"timedOut", timedOut}
+    };
+    std::printf("%s\n", out.dump().c_str());
+    return timedOut ? 1 : 0;
+}
+
+// ---------- query ----------
+static int query(const QStringList &args) {
+    QString archivePath, jsonPath;
+    bool compact = false;
+    GameArchive::Query q;
+    auto list = [](const QString &value) {
+        std::vector<QString> ids;
+        for (const QString &id : value.split(',')) if (!id.trimmed().isEmpty()) ids.push_back(id.trimmed());
+        return ids;
+    };
+
+    for (int i = 0; i < args.size(); ++i) {
+        const QString &arg = args[i];
+        if (arg == "--compact") { compact = true; continue; }
+        if (i + 1 >= args.size()) return usage();
+        const QString value = args[++i];
+        if (arg == "--archive") archivePath = value;
+        else if (arg == "--json") jsonPath = value;
+        else if (arg == "--script") q.script = value;
+        else if (arg == "--with") q.with = list(value);
+        else if (arg == "--without") q.without = list(value);
+        else if (arg == "--executed") q.executed = list(value);
+        else if (arg == "--not-executed") q.notExecuted = list(value);
+        else if (arg == "--watch") q.watch = value;
+        else if (arg == "--threads") q.threads = value.toInt();
+        else if (arg == "--players") {
+            QStringList range = value.split('-');
+            q.minPlayers = range.first().toInt();
+            q.maxPlayers = range.last().toInt();
+        }
+        else if (arg == "--winner") {
+            if (value == "good") q.winner = GameArchive::Good;
+            else if (value == "evil") q.winner = GameArchive::Evil;
+            else if (value == "unfinished") q.winner = GameArchive::Unfinished;
+            else return usage();
+        }
+        else if (arg == "--group-by") {
+            bool ok = false;
+            q.groupBy = GameArchive::groupByFromString(value, &ok);
+            if (!ok) return usage();
+        }
+        else return usage();
+    }
+    if (archivePath.isEmpty()) return usage();
+
+    QElapsedTimer loading;
+    loading.start();
+    GameArchive archive;
+    OpResult result = archive.load(archivePath);
+    if (!result && compact) result = archive.save(archivePath);
+    if (result) {
+        std::fprintf(stderr, "%s: %s\n", qPrintable(result->title), qPrintable(result->message));
+        return 1;
+    }
+    const qint64 loadMs = loading.elapsed();
+
+    const GameArchive::Result r = archive.query(q);
+    std::printf("%ld of %ld games matched in %.2f ms (loaded in %lld ms)\n", r.matched, r.scanned,
+                r.elapsedUs / 1000.0, static_cast<long long>(loadMs));
+    json rows = json::array();
+    for (const GameArchive::Row &row : r.rows) {
+        std::printf("  %-24s %9ld games  good %5.1f%%  evil %5.1f%%  %4.1f days  %4.1f deaths", qPrintable(row.label),
+                    row.games, 100.0 * row.goodRate(), row.games ? 100.0 * row.evilWins / row.games : 0.0,
+                    row.averageDays, row.averageDeaths);
+        if (!q.watch.isEmpty())
+            std::printf("  %s executed %5.1f%%", qPrintable(q.watch),
+                        row.games ? 100.0 * row.watchExecuted / row.games : 0.0);
+        std::printf("\n");
+        rows.push_back({{"label", row.label.toStdString()}, {"games", row.games}, {"goodWins", row.goodWins},
+                        {"evilWins", row.evilWins}, {"unfinished", row.unfinished},
+                        {"watchExecuted", row.watchExecuted}, {"averageDays", row.averageDays},
+                        {"averageDeaths", row.averageDeaths}});
+    }
+
+    if (!jsonPath.isEmpty()) {
+        json out = {{"matched", r.matched}, {"scanned", r.scanned}, {"elapsedUs", r.elapsedUs}, {"rows", rows}};
+        std::ofstream(jsonPath.toStdString()) << out.dump(2) << "\n";
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments().mid(1);
+    if (args.isEmpty()) return usage();
+
+    const QString command = args.takeFirst();
+    if (command == "simulate") return simulate(args);
+    if (command == "stats") return stats(args);
+    if (command == "sync") return syncReplica(args);
+    if (command == "query") return query(args);
+    return usage();
+}
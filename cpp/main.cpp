@@ -1,11 +1,13 @@
-#include "storyteller.h"
+#include "GameTabs.h"
 #include "CharacterSelectionDialog.h"
+#include "StallWatchdog.h"
 #include <QApplication>
 
 int main(int argc, char **argv) {
     QApplication app(argc, argv);
+    StallWatchdog::instance().start();
 
-    StorytellerWindow w;
+    GameTabs w;
     w.show();
 
     return app.exec();
@@ -1,31 +1,25 @@
 #include "storyteller.h"
 #include "CharacterSelectionDialog.h"
 #include "BluffSelectionDialog.h"
-#include <fstream>
+#include "BluffOptimiser.h"
+#include "GameCommands.h"
+#include "GrimoireLink.h"
+#include "GrimoireWidget.h"
+#include "IconCache.h"
+#include "PlayerServer.h"
+#include "InfoGenerator.h"
+#include "StallWatchdog.h"
+#include "TokenSprites.h"
+#include "TownSquareWidget.h"
+#include "WorldSolver.h"
 #include <algorithm>
-#include <random>
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QInputDialog>
+#include <QStandardPaths>
 #include <QDialogButtonBox>
 
-using json = nlohmann::json;
-
 // ---------- Static config ----------
-const std::unordered_map<int, std::unordered_map<QString,int>> StorytellerWindow::role_config = {
-    {5,  {{"townsfolk",3},{"outsider",0},{"minion",1},{"demon",1}}},
-    {6,  {{"townsfolk",3},{"outsider",1},{"minion",1},{"demon",1}}},
-    {7,  {{"townsfolk",5},{"outsider",0},{"minion",1},{"demon",1}}},
-    {8,  {{"townsfolk",5},{"outsider",1},{"minion",1},{"demon",1}}},
-    {9,  {{"townsfolk",5},{"outsider",2},{"minion",1},{"demon",1}}},
-    {10, {{"townsfolk",7},{"outsider",0},{"minion",2},{"demon",1}}},
-    {11, {{"townsfolk",7},{"outsider",1},{"minion",2},{"demon",1}}},
-    {12, {{"townsfolk",7},{"outsider",2},{"minion",2},{"demon",1}}},
-    {13, {{"townsfolk",9},{"outsider",0},{"minion",3},{"demon",1}}},
-    {14, {{"townsfolk",9},{"outsider",1},{"minion",3},{"demon",1}}},
-    {15, {{"townsfolk",9},{"outsider",2},{"minion",3},{"demon",1}}}
-};
-
 const QMap<QString, QString> StorytellerWindow::colors = {
     {"townsfolk","blue"},
     {"demon","orange"},
@@ -34,26 +28,8 @@ const QMap<QString, QString> StorytellerWindow::colors = {
     {"evil townsfolk","red"}
 };
 
-const std::vector<QString> StorytellerWindow::all_teams = {"townsfolk","demon","minion","outsider","evil townsfolk"};
-
-// ---------- Random helpers ----------
-static std::mt19937& rng() {
-    static std::random_device rd;
-    static std::mt19937 mt(rd());
-    return mt;
-}
-
-template<typename T>
-static std::vector<T> sample(const std::vector<T>& data, size_t k) {
-    std::vector<T> pool = data;
-    if (k >= pool.size()) return pool;
-    std::shuffle(pool.begin(), pool.end(), rng());
-    pool.resize(k);
-    return pool;
-}
-
 // ---------- Constructor ----------
-StorytellerWindow::StorytellerWindow(QWidget *parent)
+StorytellerWindow::StorytellerWindow(QWidget *parent, bool promptForScript, const GameState *shareFrom)
     : QMainWindow(parent)
 {
     setWindowTitle("Blood on the Clocktower - Qt");
@@ -69,7 +45,7 @@ StorytellerWindow::StorytellerWindow(QWidget *parent)
     setCentralWidget(central);
 
     // Header label
-    headerLabel = new QLabel(QString("Day %1").arg(day), this);
+    headerLabel = new QLabel(QString("Day %1").arg(game.day), this);
     headerLabel->setAlignment(Qt::AlignCenter);
     headerLabel->setStyleSheet("font-weight:bold; font-size:18px; color:white; background: black;");
     headerLabel->setFixedHeight(40);
@@ -82,8 +58,7 @@ StorytellerWindow::StorytellerWindow(QWidget *parent)
     layout->addWidget(scrollArea, 1);
 
     // Background
-    QPixmap bg("../../images/bkg.png");
-    bg = bg.scaled(scrollArea->size(), Qt::IgnoreAspectRatio);
+    QPixmap bg = TokenSprites::instance().background("../../images/bkg.png", scrollArea->size(), devicePixelRatioF());
 
     QPalette p = scrollArea->palette();
     p.setBrush(QPalette::Window, bg);
@@ -94,158 +69,99 @@ StorytellerWindow::StorytellerWindow(QWidget *parent)
     showAllCheckbox->setChecked(true);
     layout->addWidget(showAllCheckbox);
 
-    // Initialize data
-    day = 1;
-    first_night = true;
-    init_effects.clear();
+    // Grimoire: painted from cached sprites, kept for the lifetime of the window
+    grimoire = new GrimoireWidget();
+    grimoire->setBackground("../../images/bkg1.png");
+    scrollArea->setWidget(grimoire);
+    connect(grimoire, &GrimoireWidget::seatClicked, this, &StorytellerWindow::showSeatMenu);
+    connect(grimoire, &GrimoireWidget::statusClicked, this, [this](int i) {
+        game.toggleEffect(i, "Dead");
+        refreshPlayersCircle();
+    });
+    connect(grimoire, &GrimoireWidget::effectClicked, this, [this](int i, const QString &effect) {
+        game.setEffect(i, effect, false);
+        refreshPlayersCircle();
+    });
 
-    loadCharacterDBFromPath("../../Master_BotC.json");
-    loadScript();             // loads script_characters
+    if (shareFrom) game.shareData(*shareFrom);
+    else loadCharacterDBFromPath("../../Master_BotC.json");
+    if (promptForScript)
+        loadScript();         // loads the script snapshot
     refreshPlayersCircle();   // draw players
 }
 
+StorytellerWindow::~StorytellerWindow() {
+    // Children would only be deleted after `game`, which they listen to
+    delete townSquare;
+    delete playerServer;
+    delete grimoireLink;
+    grimoireSync.reset();
+}
 
-// ---------- Slots implementation ----------
 
-void StorytellerWindow::loadCharacterDBFromPath(const QString &path) {
-    std::ifstream f(path.toStdString());
-    if (!f) {
-        QMessageBox::warning(this, "Error", "Cannot open Master_BotC.json at startup.");
-        return;
-    }
+// ---------- Slots implementation ----------
 
-    json j;
-    try { f >> j; } 
-    catch(...) { 
-        QMessageBox::warning(this, "Error", "Invalid JSON in Master_BotC.json."); 
-        return; 
-    }
-
-    character_db.clear();
-    for (auto &it : j) {
-        Character c;
-        c.id = QString::fromStdString(it.value("id",""));
-        c.name = QString::fromStdString(it.value("name",""));
-        c.team = QString::fromStdString(it.value("team",""));
-        c.ability = QString::fromStdString(it.value("ability",""));
-        
-        // Allow night orders to be null
-        if (it.contains("first_night_order") && !it["first_night_order"].is_null())
-            c.first_night_order = it["first_night_order"];
-        else
-            c.first_night_order = -1; // -1 means no night action
-
-        if (it.contains("other_night_order") && !it["other_night_order"].is_null())
-            c.other_night_order = it["other_night_order"];
-        else
-            c.other_night_order = -1;
-
-        c.firstNightReminder = QString::fromStdString(it.value("firstNightReminder",""));
-        c.otherNightReminder = QString::fromStdString(it.value("otherNightReminder",""));
-        if (it.contains("reminders")) {
-            for (auto &r : it["reminders"])
-                c.reminders.push_back(QString::fromStdString(r));
-        }
+// Shows a core error, if any; returns true when there was one
+bool StorytellerWindow::showError(const OpResult &result) {
+    if (!result) return false;
+    QMessageBox::warning(this, result->title, result->message);
+    return true;
+}
 
-        character_db[c.id] = c;
-    }
+void StorytellerWindow::loadCharacterDBFromPath(const QString &path) {
+    StallWatchdog::ActionScope action("loadCharacterDBFromPath");
+    if (showError(game.loadCharacterDB(path))) return;
 
-    qDebug() << "Loaded" << character_db.size() << "characters at startup.";
+    qDebug() << "Loaded" << game.characterDB().size() << "characters at startup.";
 }
 
 
 void StorytellerWindow::loadCharacterDB() {
     QString path = QFileDialog::getOpenFileName(this, "Open Master_BotC.json", QDir::currentPath(), "JSON Files (*.json)");
     if (path.isEmpty()) return;
-    std::ifstream f(path.toStdString());
-    if (!f) { QMessageBox::warning(this,"Error","Cannot open file."); return; }
-
-    json j;
-    try { f >> j; } catch(...) { QMessageBox::warning(this,"Error","Invalid JSON."); return; }
-
-    character_db.clear();
-    for (auto &it : j) {
-        Character c;
-        c.id = QString::fromStdString(it.value("id",""));
-        c.name = QString::fromStdString(it.value("name",""));
-        c.team = QString::fromStdString(it.value("team",""));
-        c.ability = QString::fromStdString(it.value("ability",""));
-        // Handle optional night orders
-        if (it.contains("first_night_order") && !it["first_night_order"].is_null())
-            c.first_night_order = it["first_night_order"].get<int>();
-        else
-            c.first_night_order = std::nullopt;
-
-        if (it.contains("other_night_order") && !it["other_night_order"].is_null())
-            c.other_night_order = it["other_night_order"].get<int>();
-        else
-            c.other_night_order = std::nullopt;
-        c.firstNightReminder = QString::fromStdString(it.value("firstNightReminder",""));
-        c.otherNightReminder = QString::fromStdString(it.value("otherNightReminder",""));
-        if (it.contains("reminders")) {
-            for (auto &r : it["reminders"]) c.reminders.push_back(QString::fromStdString(r));
-        }
-        character_db[c.id] = c;
-    }
+    if (showError(game.loadCharacterDB(path))) return;
 
-    QMessageBox::information(this,"Loaded", QString("Loaded %1 characters").arg(character_db.size()));
+    QMessageBox::information(this,"Loaded", QString("Loaded %1 characters").arg(game.characterDB().size()));
 }
 
 void StorytellerWindow::loadScript() {
     QString path = QFileDialog::getOpenFileName(this, "Open script.json", "../../scripts", "JSON Files (*.json)");
     if (path.isEmpty()) return;
 
-    std::ifstream f(path.toStdString());
-    if (!f) { QMessageBox::warning(this,"Error","Cannot open script file."); return; }
+    if (!loadScriptFromPath(path)) return;
+    QMessageBox::information(this,"Script Loaded", QString("Loaded %1 script characters and %2 reminders").arg(game.scriptCharacters().size()).arg(game.scriptReminders().size()));
+}
 
-    json j;
-    try { f >> j; } catch(...) { QMessageBox::warning(this,"Error","Invalid script JSON."); return; }
+bool StorytellerWindow::loadScriptFromPath(const QString &path) {
+    StallWatchdog::ActionScope action("loadScript");
+    if (showError(game.loadScript(path))) return false;
 
-    script_characters.clear();
-    reminders.clear();
-    init_effects.clear();
-
-    for (auto &entry : j) {
-        QString id = QString::fromStdString(entry.value("id",""));
-        if (character_db.count(id)) {
-            Character c = character_db.at(id);
-            script_characters.push_back(c);
-            for (auto &r : c.reminders) if (std::find(reminders.begin(), reminders.end(), r) == reminders.end()) reminders.push_back(r);
-        }
-    }
-
-    std::sort(reminders.begin(), reminders.end());
-    for (auto &r : reminders) init_effects[r] = false;
-    QMessageBox::information(this,"Script Loaded", QString("Loaded %1 script characters and %2 reminders").arg(script_characters.size()).arg(reminders.size()));
+    // Decode the new script's art in the background (cancels the previous script's)
+    IconCache::instance().prefetch(game.scriptCharacters(), {GrimoireWidget::seatSize, CharacterListModel::iconSize});
 
     refreshPlayersCircle();
     //refreshPlayersTable();
+    return true;
 }
 
 // ---------- openAddPlayerDialog ----------
-void StorytellerWindow::openAddPlayerDialog(Player* editPlayer) {
+void StorytellerWindow::openAddPlayerDialog(int editSeat) {
+    bool editing = editSeat >= 0 && editSeat < int(game.players.size());
     QDialog dlg(this);
-    dlg.setWindowTitle(editPlayer ? "Edit Player" : "Add Player");
+    dlg.setWindowTitle(editing ? "Edit Player" : "Add Player");
     QFormLayout form(&dlg);
 
     QLineEdit *nameEdit = new QLineEdit(&dlg);
-    if (editPlayer) nameEdit->setText(editPlayer->name);
+    if (editing) nameEdit->setText(game.players[editSeat].name);
     form.addRow("Player name:", nameEdit);
 
     // available characters
-    std::vector<Character> available;
-    if (editPlayer) {
-        available = script_characters;
-    } else {
-        std::unordered_set<QString> assigned;
-        for (auto &p : players) assigned.insert(p.character.id);
-        for (auto &c : script_characters) if (!assigned.count(c.id)) available.push_back(c);
-    }
+    std::vector<Character> available = game.availableCharacters(editing);
 
     QComboBox *charBox = new QComboBox(&dlg);
     for (auto &c : available) charBox->addItem(c.name);
-    if (editPlayer) {
-        int idx = charBox->findText(editPlayer->character.name);
+    if (editing) {
+        int idx = charBox->findText(game.players[editSeat].character.name);
         if (idx>=0) charBox->setCurrentIndex(idx);
     }
     form.addRow("Character:", charBox);
@@ -259,22 +175,9 @@ void StorytellerWindow::openAddPlayerDialog(Player* editPlayer) {
         QString name = nameEdit->text().trimmed();
         if (name.isEmpty()) return;
 
-        QString selectedName = charBox->currentText();
-        auto it = std::find_if(script_characters.begin(), script_characters.end(), [&](const Character &c){ return c.name == selectedName; });
-        if (it == script_characters.end()) return;
-
-        if (editPlayer) {
-            editPlayer->name = name;
-            editPlayer->character = *it;
-            editPlayer->team = it->team;
-        } else {
-            Player p;
-            p.name = name;
-            p.character = *it;
-            p.team = it->team;
-            p.effects = init_effects;
-            players.push_back(p);
-        }
+        OpResult result = editing ? game.editPlayer(editSeat, name, charBox->currentText())
+                                  : game.addPlayer(name, charBox->currentText());
+        if (showError(result)) return;
 
         //refreshPlayersTable();
         refreshPlayersCircle();
@@ -283,223 +186,166 @@ void StorytellerWindow::openAddPlayerDialog(Player* editPlayer) {
 
 // ---------- refreshPlayersTable ----------
 void StorytellerWindow::refreshPlayersCircle() {
-    if (!scrollArea) return;
+    StallWatchdog::ActionScope action("refreshPlayersCircle");
+    if (!grimoire) return;
+
+    // Only the seat descriptions are rebuilt; the grimoire blits cached sprites
+    std::vector<SeatView> seats;
+    seats.reserve(game.players.size());
+    for (int i = 0; i < int(game.players.size()); ++i) {
+        const Player &p = game.players[i];
+        SeatView s;
+        s.playerName = p.name;
+        s.characterName = p.character.name;
+        s.team = p.character.team;
+        s.tooltip = QString("First Night: %1\nOther Night: %2")
+            .arg(p.character.firstNightReminder.isEmpty() ? "(none)" : p.character.firstNightReminder)
+            .arg(p.character.otherNightReminder.isEmpty() ? "(none)" : p.character.otherNightReminder);
+        s.status = p.status() + "\n" + abilityStatus(i);
+        if (!game.isAlive(i)) s.status += p.ghostVote ? "\nGhost vote unused" : "\nGhost vote spent";
+        s.abilityActive = game.abilityActive(i);
+        s.leftNeighbour = game.aliveNeighbour(i, false);
+        s.rightNeighbour = game.aliveNeighbour(i, true);
+        if (s.leftNeighbour == s.rightNeighbour && s.leftNeighbour >= 0)
+            s.tooltip += QString("\nAlive neighbour: %1").arg(game.players[s.leftNeighbour].name);
+        else if (s.leftNeighbour >= 0)
+            s.tooltip += QString("\nAlive neighbours: %1 and %2")
+                .arg(game.players[s.leftNeighbour].name, game.players[s.rightNeighbour].name);
+        for (auto &kv : p.effects) {
+            if (!kv.second) continue;
+            if (kv.first == "Dead") s.dead = true;
+            else s.effects.push_back(kv.first);
+        }
+        seats.push_back(std::move(s));
+    }
+    grimoire->setSeats(std::move(seats));
 
-    int n = players.size();
-    if (n == 0) return;
+    headerLabel->setText(QString("Day %1").arg(game.day));
+    emit gameTitleChanged(gameTitle());
 
-    // --- Recreate the circle widget safely ---
-    if (circleWidget) {
-        scrollArea->takeWidget();
-        delete circleWidget;
-        circleWidget = nullptr;
+    // Win conditions are shown once the current action has finished
+    if (game.hasAlerts())
+        QTimer::singleShot(0, this, &StorytellerWindow::showAlerts);
+}
+
+// "Ability active", or why not, naming who impairs the player
+QString StorytellerWindow::abilityStatus(int seat) const {
+    if (game.abilityActive(seat)) return "Ability active";
+    QStringList sources;
+    for (int s : game.impairedBy(seat)) sources << game.players[s].name;
+    if (sources.isEmpty()) return "Ability inactive (drunk or poisoned)";
+    return "Ability inactive (impaired by " + sources.join(", ") + ")";
+}
+
+void StorytellerWindow::showAlerts() {
+    for (auto &alert : game.takeAlerts()) {
+        if ((alert.kind == GameAlert::GoodWins || alert.kind == GameAlert::EvilWins) && !game.archived)
+            archiveGame(alert.kind == GameAlert::GoodWins ? GameArchive::Good : GameArchive::Evil);
+        QString title = alert.kind == GameAlert::GoodWins ? "Good Wins"
+                      : alert.kind == GameAlert::EvilWins ? "Evil Wins"
+                      : alert.kind == GameAlert::ScarletWoman ? "Scarlet Woman"
+                      : "Rules Check";
+        QMessageBox::information(this, title, alert.message);
     }
+}
 
-    circleWidget = new QWidget();
-    //circleWidget->setStyleSheet("background:#222;");
-    scrollArea->setWidget(circleWidget);
-    scrollArea->setWidgetResizable(true);
-    
-
-    // --- Compute center and radius dynamically ---
-    QSize areaSize = scrollArea->viewport()->size();
-    int width = areaSize.width();
-    int height = areaSize.height();
-    QPoint center(width / 2, height / 2);
-
-    // Radius based on number of players and window size
-    int maxRadius = std::min(width, height) / 2 - 80;
-    int radius = std::clamp(150 + (n - 1) * 20, 150, maxRadius);
-
-    // --- Color map for effects ---
-    QMap<QString, QString> effectColors = {
-        {"Poisoned", "purple"},
-        {"Stunned", "orange"},
-        {"Protected", "green"},
-        {"Bluffed", "yellow"}
-    };
-
-    // --- Draw players around circle ---
-    for (int i = 0; i < n; ++i) {
-        Player* p = &players[i];
-
-        int buttonSize = 90; // both width and height the same
-        double angle = 2 * M_PI * i / n;
-        int x = center.x() + radius * std::cos(angle) - buttonSize / 2;
-        int y = center.y() + radius * std::sin(angle) - buttonSize / 2;
-
-        // Player button
-        // btn->setStyleSheet(QString("background:%1; color:white; font-weight:bold;").arg(bg));
-        
-        QPushButton *btn = new QPushButton("", circleWidget);
-        btn->setGeometry(x, y, buttonSize, buttonSize);
-
-        // Load image
-        QString imgPath = QString("../../Resources/botc_icons/%1.png")
-                            .arg(p->character.name);
-
-        btn->setIcon(QIcon(imgPath));
-        btn->setIconSize(QSize(buttonSize, buttonSize));   // fills entire circle
-
-        // Circular button styling
-        btn->setStyleSheet(QString(
-            "QPushButton {"
-            "    border-radius:%1px;"
-            "    border:2px solid white;"
-            "    color: white;"
-            "    background-color:gray;" 
-            "    padding:0px;"            // must be 0 so the image fits perfectly
-            "}"
-            "QPushButton:hover {"
-            "    border:3px solid gold;"
-            "}"
-        ).arg(buttonSize / 2));
-
-        btn->show();
-
-        QLabel* nameLbl = new QLabel(p->name + "\n" + p->character.name, circleWidget);
-        nameLbl->setAlignment(Qt::AlignCenter);
-        nameLbl->setGeometry(x, y + buttonSize + 2, buttonSize, 30);
-        nameLbl->setStyleSheet(
-            "color:white;"
-            "font-weight:bold;"
-            "font-size:14px;"
-        );
-        nameLbl->show();
-
-
-
-        // Tooltip
-        btn->setToolTip(QString("First Night: %1\nOther Night: %2")
-            .arg(p->character.firstNightReminder.isEmpty() ? "(none)" : p->character.firstNightReminder)
-            .arg(p->character.otherNightReminder.isEmpty() ? "(none)" : p->character.otherNightReminder));
-
-        // Popup menu
-        int idx = i;
-        connect(btn, &QPushButton::clicked, [this, idx, btn, effectColors]() {
-            QMenu menu;
-
-            QAction *editAction = menu.addAction("Edit Player");
-            connect(editAction, &QAction::triggered, [this, idx]() { openAddPlayerDialog(&players[idx]); });
-
-            QAction *killAction = menu.addAction(players[idx].effects["Dead"] ? "Revive" : "Kill");
-            connect(killAction, &QAction::triggered, [this, idx]() {
-                players[idx].effects["Dead"] = !players[idx].effects["Dead"];
-                refreshPlayersCircle();
-            });
-
-            QAction *poisonAction = menu.addAction(players[idx].effects["Poisoned"] ? "Remove Poison" : "Poison");
-            connect(poisonAction, &QAction::triggered, [this, idx]() {
-                players[idx].effects["Poisoned"] = !players[idx].effects["Poisoned"];
-                refreshPlayersCircle();
-            });
-
-            
-
-            QAction *effectAction = menu.addAction("Apply Effect");
-            connect(effectAction, &QAction::triggered, [this, idx]() { applyEffect(&players[idx]); });
-
-            menu.exec(btn->mapToGlobal(QPoint(0, btn->height())));
-        });
+// Each game goes to the club's archive once, when first won, for
+// botc_cli query; BOTC_ARCHIVE names another file
+void StorytellerWindow::archiveGame(GameArchive::Winner winner) {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(dir);
+    GameArchive archive;
+    archive.append(GameArchive::fromState(game, winner));
+    if (showError(archive.appendToFile(qEnvironmentVariable("BOTC_ARCHIVE", dir + "/games.botcarc")))) return;
+    game.archived = true;
+}
 
-        // Status label
-        // QLabel *statusLbl = new QLabel(players[i].status(), circleWidget);
-        // statusLbl->setGeometry(x, y + 60, 80, 20);
-        // statusLbl->setAlignment(Qt::AlignCenter);
-        // statusLbl->setStyleSheet("color:white; font-size:12px;");
-        // statusLbl->show();
-        // Effect/status circles (closer to center)
-        // === Effects and statuses (draw line inward) ===
-        // === Effects and statuses (aligned correctly toward center) ===
-        int effectCircleSize = 45; // diameter of inner effect circles
-        int effectSpacing = 45;    // distance between each effect circle toward center
-        
-
-        // Player center point (not top-left)
-        int px = center.x() + radius * std::cos(angle);
-        int py = center.y() + radius * std::sin(angle);
-
-        int numEffects = 0;
-        for (auto &kv : players[i].effects)
-            if (kv.second) numEffects++;
-
-        // === Status circle (just inside last effect circle) ===
-        QString statusColor = players[i].effects["Dead"] ? "red" : "limegreen";
-        int sx = center.x() + (0.78*radius - (1) * effectSpacing) * std::cos(angle) - effectCircleSize / 2;
-        int sy = center.y() + (0.78*radius - (1) * effectSpacing) * std::sin(angle) - effectCircleSize / 2;
-
-        QPushButton *statusCircle = new QPushButton(players[i].effects["Dead"] ? "Dead" : "Alive", circleWidget);
-        statusCircle->setGeometry(sx, sy, effectCircleSize, effectCircleSize);
-        
-        statusCircle->setStyleSheet(QString(
-                    "background:%1; border-radius:%2px; border:2px solid white; "
-                    "color:white; font-size:10px; font-weight:bold; padding:2px;"
-                ).arg(statusColor).arg(effectCircleSize / 2));
-        statusCircle->setToolTip(players[i].status());
-        connect(statusCircle, &QPushButton::clicked, [this, i]() mutable {
-                    players[i].effects["Dead"] = !players[i].effects["Dead"];
-                    refreshPlayersCircle();
-                });
-        statusCircle->show();
-        
-        // For each active effect, draw button circles going inward
-        int effectIndex = 0;
-        for (auto &kv : players[i].effects) {
-            
-            if (!kv.second) continue;
-            if (kv.first != "Dead") {
-                int ex = center.x() + (0.78*radius - (effectIndex + 2) * effectSpacing) * std::cos(angle) - effectCircleSize / 2;
-                int ey = center.y() + (0.78*radius - (effectIndex + 2) * effectSpacing) * std::sin(angle) - effectCircleSize / 2;
+// ---------- showSeatMenu ----------
+void StorytellerWindow::showSeatMenu(int idx, const QPoint &globalPos) {
+    QMenu menu;
 
+    QAction *editAction = menu.addAction("Edit Player");
+    connect(editAction, &QAction::triggered, [this, idx]() { openAddPlayerDialog(idx); });
 
-                QString color = effectColors.contains(kv.first) ? effectColors[kv.first] : "black";
+    QAction *killAction = menu.addAction(game.hasEffect(idx, "Dead") ? "Revive" : "Kill");
+    connect(killAction, &QAction::triggered, [this, idx]() {
+        game.toggleEffect(idx, "Dead");
+        refreshPlayersCircle();
+    });
 
-                QPushButton *effectBtn = new QPushButton(kv.first, circleWidget);
-                effectBtn->setGeometry(ex, ey, effectCircleSize, effectCircleSize);
-                effectBtn->setToolTip(QString("Click to remove '%1'").arg(kv.first));
-                effectBtn->setStyleSheet(QString(
-                    "background:%1; border-radius:%2px; border:2px solid white; "
-                    "color:white; font-size:9px; font-weight:bold; padding:2px;"
-                ).arg(color).arg(effectCircleSize / 2));
+    if (game.isAlive(idx)) {
+        QAction *executeAction = menu.addAction("Execute");
+        connect(executeAction, &QAction::triggered, [this, idx]() {
+            if (showError(game.execute(idx))) return;
+            refreshPlayersCircle();
+        });
+    }
 
-                connect(effectBtn, &QPushButton::clicked, [this, i, kv]() mutable {
-                    players[i].effects[kv.first] = false;
-                    refreshPlayersCircle();
-                });
+    QAction *poisonAction = menu.addAction(game.hasEffect(idx, "Poisoned") ? "Remove Poison" : "Poison");
+    connect(poisonAction, &QAction::triggered, [this, idx]() {
+        if (game.hasEffect(idx, "Poisoned")) game.setEffect(idx, "Poisoned", false);
+        else game.applyEffect(idx, "Poisoned");
+        refreshPlayersCircle();
+    });
 
-                effectBtn->show();
-                effectIndex++;
-            }
-        }
+    QAction *effectAction = menu.addAction("Apply Effect");
+    connect(effectAction, &QAction::triggered, [this, idx]() { applyEffect(idx); });
 
-        
+    QAction *claimAction = menu.addAction("Set Claim");
+    connect(claimAction, &QAction::triggered, [this, idx]() { setClaimDialog(idx); });
 
+    QAction *messageAction = menu.addAction("Send Message");
+    connect(messageAction, &QAction::triggered, [this, idx]() { sendMessageDialog(idx); });
 
+    if (!game.isAlive(idx)) {
+        bool available = game.players[idx].ghostVote;
+        QAction *voteAction = menu.addAction(available ? "Use Ghost Vote" : "Restore Ghost Vote");
+        connect(voteAction, &QAction::triggered, [this, idx, available]() {
+            if (showError(game.setGhostVote(idx, !available))) return;
+            refreshPlayersCircle();
+        });
     }
 
-    headerLabel->setText(QString("Day %1").arg(day));
-    // Background
-    QPixmap bg("../../images/bkg1.png");
-    bg = bg.scaled(circleWidget->size(), Qt::IgnoreAspectRatio);
-
-    QPalette p = circleWidget->palette();
-    p.setBrush(QPalette::Window, bg);
-    circleWidget->setPalette(p);
-    circleWidget->setAutoFillBackground(true);
+    grimoire->setSelectedSeat(idx);
+    menu.exec(globalPos);
+    grimoire->setSelectedSeat(-1);
 }
 
 
 void StorytellerWindow::resizeEvent(QResizeEvent *event) {
     QMainWindow::resizeEvent(event);
-    QPixmap bg("../../images/bkg.png");
-    bg = bg.scaled(scrollArea->size(), Qt::IgnoreAspectRatio);
+    QPixmap bg = TokenSprites::instance().background("../../images/bkg.png", scrollArea->size(), devicePixelRatioF());
 
     QPalette p = scrollArea->palette();
     p.setBrush(QPalette::Window, bg);
     scrollArea->setPalette(p);
-    if (isVisible() && scrollArea) {
-        QTimer::singleShot(10, this, [this]() { refreshPlayersCircle(); });
-    }
+    // The grimoire lays its seats out again in its own resizeEvent
+}
+
+json StorytellerWindow::runCommands(const json &message) {
+    StallWatchdog::ActionScope action("runCommands");
+    std::shared_ptr<const Script> script = game.sharedScript();
+    bool changed = false;
+    json reply = GameCommands::run(game, message, changed);
+    if (!changed) return reply;
+
+    if (game.sharedScript() != script)
+        IconCache::instance().prefetch(game.scriptCharacters(), {GrimoireWidget::seatSize, CharacterListModel::iconSize});
+    queueRefresh();
+    return reply;
+}
+
+void StorytellerWindow::queueRefresh() {
+    if (refreshQueued) return;
+    refreshQueued = true;
+    QTimer::singleShot(0, this, [this]() {
+        refreshQueued = false;
+        refreshPlayersCircle();
+    });
+}
+
+QString StorytellerWindow::gameTitle() const {
+    return QString("%1 - Day %2").arg(game.scriptName().isEmpty() ? QString("No script") : game.scriptName()).arg(game.day);
 }
 
 // ---------- setup menu ----------
@@ -546,7 +392,7 @@ void StorytellerWindow::setupMenu() {
     connect(generateGame, &QAction::triggered, this, &StorytellerWindow::generateGameDialog);
 
     QAction *addPlayer = new QAction("Add Player", this);
-    connect(addPlayer, &QAction::triggered, this, [this]() { openAddPlayerDialog(nullptr); });
+    connect(addPlayer, &QAction::triggered, this, [this]() { openAddPlayerDialog(); });
 
     QAction *loadScript = new QAction("Load Script", this);
     connect(loadScript, &QAction::triggered, this, &StorytellerWindow::loadScript);
@@ -554,6 +400,28 @@ void StorytellerWindow::setupMenu() {
     QAction *selectBluffs = new QAction("Select Bluffs", this);
     connect(selectBluffs, &QAction::triggered, this, &StorytellerWindow::selectBluffsManually);
 
+    QAction *analyse = new QAction("Analyse Worlds", this);
+    analyse->setShortcut(QKeySequence("Ctrl+W"));
+    connect(analyse, &QAction::triggered, this, &StorytellerWindow::analyseWorlds);
+
+    QAction *stallStats = new QAction("Stall Statistics", this);
+    connect(stallStats, &QAction::triggered, this, &StorytellerWindow::showStallStats);
+
+    QAction *townSquare = new QAction("Town Square", this);
+    townSquare->setShortcut(QKeySequence("Ctrl+P"));
+    connect(townSquare, &QAction::triggered, this, &StorytellerWindow::showTownSquare);
+
+    QAction *playerLinks = new QAction("Player Phones", this);
+    playerLinks->setShortcut(QKeySequence("Ctrl+L"));
+    connect(playerLinks, &QAction::triggered, this, &StorytellerWindow::showPlayerLinks);
+
+    QAction *syncGrimoire = new QAction("Sync Grimoire", this);
+    connect(syncGrimoire, &QAction::triggered, this, &StorytellerWindow::syncGrimoire);
+
+    QAction *newGame = new QAction("New Table", this);
+    newGame->setShortcut(QKeySequence("Ctrl+T"));
+    connect(newGame, &QAction::triggered, this, &StorytellerWindow::newGameRequested);
+
 
     // Add them to the popup menu
     gameMenu->addAction(advanceDay);
@@ -565,6 +433,13 @@ void StorytellerWindow::setupMenu() {
     gameMenu->addAction(addPlayer);
     gameMenu->addAction(loadScript);
     gameMenu->addAction(selectBluffs);
+    gameMenu->addAction(analyse);
+    gameMenu->addSeparator();
+    gameMenu->addAction(townSquare);
+    gameMenu->addAction(playerLinks);
+    gameMenu->addAction(syncGrimoire);
+    gameMenu->addAction(newGame);
+    gameMenu->addAction(stallStats);
 
     // 🔑 Add global shortcut support
     addAction(advanceDay);
@@ -576,21 +451,176 @@ void StorytellerWindow::setupMenu() {
     addAction(addPlayer);
     addAction(loadScript);
     addAction(selectBluffs);
+    addAction(analyse);
+    addAction(townSquare);
+    addAction(playerLinks);
+    addAction(stallStats);
+    addAction(newGame);
 
 }
 
 
-// ---------- chooseBluffs ----------
-void StorytellerWindow::chooseBluffs() {
-    std::unordered_set<QString> assigned;
-    for (auto &p : players) assigned.insert(p.character.id);
+// ---------- showStallStats ----------
+void StorytellerWindow::showStallStats() {
+    StallWatchdog &dog = StallWatchdog::instance();
+    if (!dog.running()) {
+        QMessageBox::information(this, "Stall Statistics", "The stall watchdog is disabled (BOTC_STALL_BUDGET_MS=0).");
+        return;
+    }
+    StallWatchdog::Stats st = dog.stats();
+    QMessageBox::information(this, "Stall Statistics",
+        QString("Stalls: %1\nTotal stalled: %2 ms\nLongest stall: %3 ms\nAverage stall: %4 ms\n\nLog: %5")
+            .arg(st.stalls).arg(st.totalMs).arg(st.maxMs)
+            .arg(st.stalls ? st.totalMs / st.stalls : 0)
+            .arg(dog.logPath()));
+}
+
+// ---------- showPlayerLinks ----------
+// Starts the phone server on first use and lists each player's link
+void StorytellerWindow::showPlayerLinks() {
+    if (game.players.empty()) {
+        QMessageBox::information(this, "Player Phones", "Add players first.");
+        return;
+    }
+    if (!playerServer) {
+        playerServer = new PlayerServer(game, this);
+        if (!playerServer->start()) {
+            QMessageBox::warning(this, "Player Phones", QString("Cannot start the player server: %1").arg(playerServer->errorString()));
+            delete playerServer;
+            return;
+        }
+    }
+
+    QString host = PlayerServer::lanAddress();
+    QStringList links;
+    for (int i = 0; i < int(game.players.size()); ++i)
+        links << QString("%1: %2").arg(game.players[i].name, playerServer->playerUrl(i, host));
+    QMessageBox box(this);
+    box.setWindowTitle("Player Phones");
+    box.setText(QString("Give each player their own link (%1 connected):\n\n%2")
+                    .arg(playerServer->phoneCount()).arg(links.join("\n")));
+    box.setTextInteractionFlags(Qt::TextSelectableByMouse);
+    box.exec();
+}
+
+// ---------- syncGrimoire ----------
+// Shares this grimoire with a co-storyteller's instance: every instance
+// that joins the same session name converges on the same grimoire
+void StorytellerWindow::syncGrimoire() {
+    if (grimoireLink) {
+        QMessageBox::information(this, "Sync Grimoire",
+            QString("Syncing with %1 other instance(s).").arg(grimoireLink->peerCount()));
+        return;
+    }
+    bool ok = false;
+    QString session = QInputDialog::getText(this, "Sync Grimoire", "Session name (the same on every instance):",
+                                            QLineEdit::Normal, "table", &ok);
+    if (!ok || session.isEmpty()) return;
+
+    grimoireSync = std::make_unique<GrimoireSync>(game, QRandomGenerator::global()->generate64());
+    grimoireLink = new GrimoireLink(*grimoireSync, this);
+    if (!grimoireLink->join(session)) {
+        QMessageBox::warning(this, "Sync Grimoire", QString("Cannot join %1: %2").arg(session, grimoireLink->errorString()));
+        delete grimoireLink;
+        grimoireSync.reset();
+        return;
+    }
+    connect(grimoireLink, &GrimoireLink::received, this, [this]() { queueRefresh(); });
+}
+
+// ---------- showTownSquare ----------
+// Opens the players' view, full screen on a second screen when there is one
+void StorytellerWindow::showTownSquare() {
+    if (!townSquare) {
+        townSquare = new TownSquareWidget(game, this);
+        townSquare->setWindowFlag(Qt::Window);
+        townSquare->setWindowTitle(QString("Town Square - %1").arg(gameTitle()));
+        townSquare->setBackground(grimoire->background());
+    }
+    if (!townSquare->isVisible()) {
+        QList<QScreen *> screens = QGuiApplication::screens();
+        QScreen *own = screen();
+        auto other = std::find_if(screens.begin(), screens.end(), [own](QScreen *s) { return s != own; });
+        if (other != screens.end()) {
+            townSquare->setGeometry((*other)->availableGeometry());
+            townSquare->showFullScreen();
+        } else {
+            townSquare->show();
+        }
+    }
+    townSquare->raise();
+    townSquare->activateWindow();
+}
+
+// ---------- setClaimDialog ----------
+void StorytellerWindow::setClaimDialog(int seat) {
+    if (seat < 0 || seat >= int(game.players.size())) return;
+
+    QStringList names = {"(no claim)"};
+    QStringList ids = {QString()};
+    for (auto &c : game.scriptCharacters()) { names << c.name; ids << c.id; }
+
+    int current = std::max(0, int(ids.indexOf(game.players[seat].claim)));
+    bool ok = false;
+    QString chosen = QInputDialog::getItem(this, "Set Claim",
+                                           QString("%1 claims to be:").arg(game.players[seat].name),
+                                           names, current, false, &ok);
+    if (!ok) return;
+    showError(game.setClaim(seat, ids[names.indexOf(chosen)]));
+}
 
-    std::vector<Character> available;
-    for (auto &c : script_characters) {
-        if (!assigned.count(c.id) && (c.team == "townsfolk" || c.team == "outsider")) available.push_back(c);
+// ---------- analyseWorlds ----------
+void StorytellerWindow::analyseWorlds() {
+    if (game.players.empty()) { QMessageBox::warning(this, "No Players", "Add players first."); return; }
+
+    WorldSolver::Result result;
+    {
+        StallWatchdog::ActionScope action("analyseWorlds");
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        result = WorldSolver(game).solve();
+        QApplication::restoreOverrideCursor();
     }
+    if (!result.error.isEmpty()) { QMessageBox::warning(this, "Analyse Worlds", result.error); return; }
+
+    QDialog dlg(this);
+    dlg.setWindowTitle("Analyse Worlds");
+    dlg.resize(600, 600);
+    QVBoxLayout *v = new QVBoxLayout(&dlg);
+
+    QString summary = QString("%1 consistent world(s) from %2 claim(s) and %3 piece(s) of info, in %4 ms.")
+                          .arg(result.worlds)
+                          .arg(std::count_if(game.players.begin(), game.players.end(), [](const Player &p){ return !p.claim.isEmpty(); }))
+                          .arg(game.info_log.size())
+                          .arg(result.elapsedMs);
+    if (result.truncated) summary += " Stopped early: add claims to narrow the search.";
+    if (!result.worlds) summary += " The claims and info contradict each other.";
+    QLabel *header = new QLabel(summary, &dlg);
+    header->setWordWrap(true);
+    v->addWidget(header);
+
+    QTableWidget *table = new QTableWidget(int(game.players.size()), 4, &dlg);
+    table->setHorizontalHeaderLabels({"Player", "Claim", "Evil", "Demon"});
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    for (int i = 0; i < int(game.players.size()); ++i) {
+        const Player &p = game.players[i];
+        QString claim = p.claim.isEmpty() ? "(none)" : game.characterDB().count(p.claim) ? game.characterDB().at(p.claim).name : p.claim;
+        table->setItem(i, 0, new QTableWidgetItem(p.name));
+        table->setItem(i, 1, new QTableWidgetItem(claim));
+        table->setItem(i, 2, new QTableWidgetItem(QString("%1%").arg(result.evil[i] * 100, 0, 'f', 1)));
+        table->setItem(i, 3, new QTableWidgetItem(QString("%1%").arg(result.demon[i] * 100, 0, 'f', 1)));
+    }
+    v->addWidget(table);
 
-    bluffs = sample(available, std::min<size_t>(3, available.size()));
+    QPushButton *close = new QPushButton("Close", &dlg);
+    v->addWidget(close);
+    connect(close, &QPushButton::clicked, &dlg, &QDialog::accept);
+    dlg.exec();
+}
+
+// ---------- chooseBluffs ----------
+void StorytellerWindow::chooseBluffs() {
+    game.chooseBluffs();
 }
 
 void StorytellerWindow::showBluffs() {
@@ -604,7 +634,7 @@ void StorytellerWindow::showBluffs() {
     title->setStyleSheet("font-size:48px; font-weight:bold;");
     v->addWidget(title);
 
-    for (auto &c : bluffs) {
+    for (auto &c : game.bluffs) {
         QLabel *n = new QLabel(QString("%1 (%2)").arg(c.name, c.team), &dlg);
         n->setStyleSheet(QString("font-size:38px; color:%1;").arg(colors.value(c.team, "white")));
         QLabel *a = new QLabel(c.ability, &dlg);
@@ -613,6 +643,29 @@ void StorytellerWindow::showBluffs() {
         v->addWidget(a);
     }
 
+    // Ranked alternatives; the Storyteller can swap the current three for one of them
+    BluffOptimiser optimiser(game);
+    std::vector<BluffOptimiser::Option> ranked;
+    {
+        StallWatchdog::ActionScope action("rankBluffs");
+        ranked = optimiser.rank(10);
+    }
+    QListWidget *alternatives = new QListWidget(&dlg);
+    for (auto &o : ranked) alternatives->addItem(optimiser.describe(o));
+    v->addWidget(new QLabel("Ranked alternatives:", &dlg));
+    v->addWidget(alternatives);
+
+    QPushButton *use = new QPushButton("Use Selected", &dlg);
+    use->setEnabled(false);
+    v->addWidget(use);
+    connect(alternatives, &QListWidget::currentRowChanged, use, [use](int row) { use->setEnabled(row >= 0); });
+    connect(use, &QPushButton::clicked, &dlg, [&]() {
+        int row = alternatives->currentRow();
+        if (row < 0 || row >= int(ranked.size())) return;
+        game.bluffs = optimiser.charactersOf(ranked[row]);
+        dlg.accept();
+    });
+
     QPushButton *close = new QPushButton("Close", &dlg);
     v->addWidget(close);
     connect(close, &QPushButton::clicked, &dlg, &QDialog::accept);
@@ -624,48 +677,34 @@ void StorytellerWindow::showBluffs() {
 
 // ---------- startNight ----------
 void StorytellerWindow::startNight() {
-    std::vector<Player*> night_players;
-
-    // Choose players based on first/other night reminders
-    for (auto &p : players) {
-        if (showAllCheckbox && showAllCheckbox->isChecked()) {
-            night_players.push_back(&p);
-        } else {
-            if (first_night && !p.character.firstNightReminder.isEmpty()) night_players.push_back(&p);
-            else if (!first_night && !p.character.otherNightReminder.isEmpty()) night_players.push_back(&p);
-        }
+    game.startNight(); // dusk: "until dusk" effects end
+    std::vector<int> night_seats;
+    {
+        StallWatchdog::ActionScope action("nightOrder");
+        night_seats = game.nightOrder(showAllCheckbox && showAllCheckbox->isChecked());
     }
 
-    if (night_players.empty()) {
+    if (night_seats.empty()) {
         QMessageBox::information(this, "Night Phase", "No players with night actions.");
         return;
     }
 
-    // Sort by night order safely using optional values
-    std::sort(night_players.begin(), night_players.end(),
-              [this](Player* a, Player* b) {
-        int orderA = first_night ? (a->character.first_night_order.value_or(1000))
-                                 : (a->character.other_night_order.value_or(1000));
-        int orderB = first_night ? (b->character.first_night_order.value_or(1000))
-                                 : (b->character.other_night_order.value_or(1000));
-        return orderA < orderB;
-    });
-
-    runNightDialog(night_players, 0);
+    runNightDialog(night_seats, 0);
 }
 
 // ---------- runNightDialog ----------
-void StorytellerWindow::runNightDialog(const std::vector<Player*> &ordered, int index) {
+void StorytellerWindow::runNightDialog(const std::vector<int> &ordered, int index) {
     if (index >= static_cast<int>(ordered.size())) {
         endNight();
         return;
     }
 
-    Player* p = ordered[index];
-    if (!p) {
+    int seat = ordered[index];
+    if (seat < 0 || seat >= int(game.players.size())) {
         runNightDialog(ordered, index + 1);
         return;
     }
+    const Player *p = &game.players[seat];
 
     QDialog dlg(this);
     dlg.setWindowTitle("Night Action: " + p->name);
@@ -674,6 +713,9 @@ void StorytellerWindow::runNightDialog(const std::vector<Player*> &ordered, int
 
     QLabel *info = new QLabel(QString("Player: %1 (%2)").arg(p->name, p->character.name) + " ; " + p->status());
     v->addWidget(info);
+    QLabel *ability = new QLabel(abilityStatus(seat));
+    ability->setStyleSheet(game.abilityActive(seat) ? "color:green;" : "color:red;");
+    v->addWidget(ability);
 
     if (!p->character.firstNightReminder.isEmpty()) {
         QLabel *firstRem = new QLabel("First night reminder: " + p->character.firstNightReminder);
@@ -689,20 +731,88 @@ void StorytellerWindow::runNightDialog(const std::vector<Player*> &ordered, int
         v->addWidget(otherRem);
     }
 
+    // Info for information characters; drunk or poisoned players see false info first
+    InfoGenerator infoGen(game);
+    QComboBox *infoBox = nullptr;
+    QCheckBox *recordInfo = nullptr;
+    std::vector<InfoRecord> infoOptions;
+    if (InfoGenerator::supports(infoGen.roleFor(seat))) {
+        bool impaired = infoGen.impaired(seat);
+        std::vector<InfoRecord> truths, lies;
+        {
+            StallWatchdog::ActionScope action("infoGeneration");
+            truths = infoGen.trueInfo(seat);
+            lies = infoGen.falseInfo(seat);
+        }
+
+        // Rank the false info by how many evil teams it leaves the town to consider
+        std::vector<std::uint32_t> liesKeep;
+        std::uint32_t teams = 0;
+        bool partial = false;
+        if (impaired && !lies.empty()) {
+            StallWatchdog::ActionScope action("falseInfoRanking");
+            FalseInfoRecommender::Ranking ranking = recommender.rank(game, lies);
+            if (ranking.error.isEmpty()) {
+                teams = ranking.teams;
+                partial = ranking.truncated;
+                lies.clear();
+                for (auto &suggestion : ranking.suggestions) {
+                    lies.push_back(suggestion.record);
+                    liesKeep.push_back(suggestion.teams);
+                }
+            }
+        }
+
+        infoBox = new QComboBox(&dlg);
+        infoBox->addItem("Choose info...");
+        for (bool truthful : {!impaired, impaired}) {
+            auto &options = truthful ? truths : lies;
+            for (size_t i = 0; i < options.size(); ++i) {
+                QString text = QString(truthful ? "True: %1" : "False: %1").arg(infoGen.describe(options[i]));
+                if (!truthful && i < liesKeep.size() && teams)
+                    text += QString("  (keeps %1 of %2 evil teams)").arg(liesKeep[i]).arg(teams);
+                infoBox->addItem(text);
+                infoOptions.push_back(options[i]);
+            }
+        }
+        if (!liesKeep.empty()) infoBox->setCurrentIndex(1); // best suggestion
+        v->addWidget(new QLabel(impaired ? "Info to give (drunk or poisoned, best false info first):" : "Info to give:"));
+        v->addWidget(infoBox);
+        if (partial) {
+            QLabel *note = new QLabel("Ranked from a partial set of worlds: add claims to narrow the search.", &dlg);
+            note->setWordWrap(true);
+            v->addWidget(note);
+        }
+
+        recordInfo = new QCheckBox("Record in the info log", &dlg);
+        recordInfo->setChecked(true);
+        v->addWidget(recordInfo);
+    }
+
     // Dropdown for effects
     QComboBox *reminderBox = new QComboBox(&dlg);
     reminderBox->addItem("Choose effect...");
-    for (auto &r : reminders) reminderBox->addItem(r);
+    for (auto &r : game.scriptReminders()) reminderBox->addItem(r);
     v->addWidget(new QLabel("Select effect to apply:"));
     v->addWidget(reminderBox);
 
+    // Abilities the rules cover resolve from the targets ticked below
+    QCheckBox *autoResolve = nullptr;
+    int ability = game.abilityRules().abilityFor(p->character.id, game.first_night);
+    if (ability >= 0) {
+        autoResolve = new QCheckBox("Resolve automatically: " + game.abilityRules().ability(ability).source, &dlg);
+        autoResolve->setChecked(true);
+        v->addWidget(autoResolve);
+    }
+
     // Target checkboxes
-    std::vector<QCheckBox*> targetChecks;
-    for (auto &other : players) {
+    std::vector<std::pair<int, QCheckBox*>> targetChecks;
+    for (int i = 0; i < int(game.players.size()); ++i) {
+        const Player &other = game.players[i];
         if (other.name == p->name) continue;  // skip self
         QCheckBox *cb = new QCheckBox(other.name + " (" + other.character.name + ")", &dlg);
         v->addWidget(cb);
-        targetChecks.push_back(cb);
+        targetChecks.emplace_back(i, cb);
     }
 
     QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dlg);
@@ -711,16 +821,20 @@ void StorytellerWindow::runNightDialog(const std::vector<Player*> &ordered, int
     connect(buttons, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
 
     if (dlg.exec() == QDialog::Accepted) {
+        if (infoBox && infoBox->currentIndex() > 0 && recordInfo->isChecked())
+            showError(game.recordInfo(infoOptions[infoBox->currentIndex() - 1]));
+
+        if (autoResolve && autoResolve->isChecked()) {
+            std::vector<int> targets;
+            for (auto &target : targetChecks)
+                if (target.second->isChecked()) targets.push_back(target.first);
+            showError(game.resolveAbility(seat, targets));
+        }
+
         QString chosenEffect = reminderBox->currentText();
         if (chosenEffect != "Choose effect...") {
-            int targetIndex = 0;
-            for (auto &other : players) {
-                if (other.name == p->name) continue;
-                if (targetChecks[targetIndex]->isChecked()) {
-                    other.effects[chosenEffect] = true;
-                }
-                ++targetIndex;
-            }
+            for (auto &target : targetChecks)
+                if (target.second->isChecked()) game.applyEffect(target.first, chosenEffect, seat);
         }
 
         refreshPlayersCircle();
@@ -733,48 +847,16 @@ void StorytellerWindow::runNightDialog(const std::vector<Player*> &ordered, int
 
 // ---------- endNight ----------
 void StorytellerWindow::endNight() {
-    first_night = false;
+    game.endNight();
     refreshPlayersCircle();
 }
 
 // ---------- assignRandomCharacters ----------
 void StorytellerWindow::assignRandomCharacters() {
-    int num_players = players.size();
-    if (num_players == 0) { QMessageBox::warning(this,"No Players","Add players first."); return; }
-    if (!role_config.count(num_players)) { QMessageBox::warning(this,"Unsupported","Only 5–15 players supported."); return; }
-
-    auto config = role_config.at(num_players);
-    std::unordered_map<QString,std::vector<Character>> team_pools;
-    for (auto &c : script_characters) team_pools[c.team].push_back(c);
-
-    std::vector<Character> selected_characters;
-    try {
-        for (auto &kv : config) {
-            QString team = kv.first;
-            int count = kv.second;
-            if (team_pools[team].size() < (size_t)count) throw std::runtime_error("Not enough characters in script for team: " + team.toStdString());
-            auto samp = sample(team_pools[team], count);
-            selected_characters.insert(selected_characters.end(), samp.begin(), samp.end());
-        }
-    } catch (std::exception &e) {
-        QMessageBox::critical(this,"Character Assignment Error", e.what());
-        return;
-    }
+    StallWatchdog::ActionScope action("assignRandomCharacters");
+    if (showError(game.assignRandomCharacters())) return;
 
-    std::shuffle(selected_characters.begin(), selected_characters.end(), rng());
-    for (int i=0;i<num_players;i++) {
-        players[i].character = selected_characters[i];
-        players[i].team = selected_characters[i].team;
-        players[i].alive = true;
-        players[i].poisoned = false;
-        players[i].drunk = false;
-        players[i].effects = init_effects;
-    }
-
-    chooseBluffs();
-    first_night = true;
-    day = 1;
-    headerLabel->setText(QString("Day %1").arg(day));
+    headerLabel->setText(QString("Day %1").arg(game.day));
     refreshPlayersCircle();
     //refreshPlayersTable();
 }
@@ -786,73 +868,33 @@ void StorytellerWindow::generateGameDialog() {
                                    "Enter number of players (5–15):", 7, 5, 15, 1, &ok);
     if (!ok) return;
 
-    if (!role_config.count(num)) {
-        QMessageBox::warning(this, "Invalid", "Unsupported number of players");
-        return;
-    }
-
-    players.clear();
-
-    auto cfg = role_config.at(num);
-    std::unordered_map<QString, std::vector<Character>> team_pool;
-    for (auto &c : script_characters) team_pool[c.team].push_back(c);
-
-    // Check for enough characters
-    for (auto &kv : cfg) {
-        QString team = kv.first;
-        int needed = kv.second;
-        if (team_pool[team].size() < (size_t)needed) {
-            QMessageBox::critical(this, "Not enough characters",
-                                  QString("Script does not have enough unique %1 characters").arg(team));
-            return;
-        }
-    }
-
-    // Select characters
-    std::vector<Character> selected;
-    for (auto &kv : cfg) {
-        QString team = kv.first;
-        int count = kv.second;
-        auto s = sample(team_pool[team], count);
-        selected.insert(selected.end(), s.begin(), s.end());
-    }
+    generateGame(num);
+}
 
-    std::shuffle(selected.begin(), selected.end(), rng());
+void StorytellerWindow::generateGame(int num) {
+    StallWatchdog::ActionScope action("generateGame");
+    if (showError(game.generateGame(num))) return;
 
-    // Create players with initialized fields
-    for (int i = 0; i < num; i++) {
-        Player p;
-        p.name = QString("Player %1").arg(i + 1);
-        p.character = selected[i];
-        p.team = selected[i].team;
-        p.alive = true;
-        p.poisoned = false;
-        p.drunk = false;
-        p.effects = init_effects;   // copy of initial effects map
-        players.push_back(p);
-    }
-
-    chooseBluffs();
-    first_night = true;
-    day = 1;
-    headerLabel->setText(QString("Day %1").arg(day));
+    headerLabel->setText(QString("Day %1").arg(game.day));
     refreshPlayersCircle();
 }
 
 
 // ---------- advanceDay ----------
 void StorytellerWindow::advanceDay() {
-    day++;
-    first_night = false;
-    headerLabel->setText(QString("Day %1").arg(day));
+    StallWatchdog::ActionScope action("advanceDay");
+    game.advanceDay();
+    headerLabel->setText(QString("Day %1").arg(game.day));
     refreshPlayersCircle();
     //refreshPlayersTable();
 }
 
 // ---------- sendMessageDialog ----------
-void StorytellerWindow::sendMessageDialog() {
+// Shown on this screen, and on the player's phone when they have one connected
+void StorytellerWindow::sendMessageDialog(int seat) {
+    if (seat < 0 || seat >= int(game.players.size())) return;
     QDialog dlg(this);
-    dlg.setWindowTitle("Send Message");
+    dlg.setWindowTitle(QString("Send Message to %1").arg(game.players[seat].name));
     QVBoxLayout *v = new QVBoxLayout(&dlg);
 
     QComboBox *msgType = new QComboBox(&dlg);
@@ -861,7 +903,7 @@ void StorytellerWindow::sendMessageDialog() {
     v->addWidget(msgType);
 
     QComboBox *charBox = new QComboBox(&dlg);
-    for (auto &c : script_characters) charBox->addItem(c.name);
+    for (auto &c : game.scriptCharacters()) charBox->addItem(c.name);
     v->addWidget(new QLabel("Character:"));
     v->addWidget(charBox);
 
@@ -872,6 +914,7 @@ void StorytellerWindow::sendMessageDialog() {
 
     if (dlg.exec() == QDialog::Accepted) {
         QString msg = msgType->currentText() + " " + charBox->currentText();
+        if (playerServer) playerServer->sendMessage(seat, msg);
 
         QDialog msgdlg(this);
         msgdlg.setWindowTitle("Message");
@@ -887,9 +930,9 @@ void StorytellerWindow::sendMessageDialog() {
 }
 
 // ---------- applyEffect ----------
-void StorytellerWindow::applyEffect(Player* player) {
+void StorytellerWindow::applyEffect(int seat) {
 
-    if (!player) return;
+    if (seat < 0 || seat >= int(game.players.size())) return;
 
     // Create the dialog
     QDialog dlg(this);
@@ -899,7 +942,7 @@ void StorytellerWindow::applyEffect(Player* player) {
     // Dropdown to choose an effect from the global list of reminders
     QComboBox *reminderBox = new QComboBox();
     reminderBox->addItem("Choose effect...");
-    for (auto &r : reminders) reminderBox->addItem(r);
+    for (auto &r : game.scriptReminders()) reminderBox->addItem(r);
 
     v->addWidget(new QLabel("Select effect to apply:"));
     v->addWidget(reminderBox);
@@ -914,8 +957,9 @@ void StorytellerWindow::applyEffect(Player* player) {
     if (dlg.exec() == QDialog::Accepted) {
         QString chosenEffect = reminderBox->currentText();
         if (chosenEffect != "Choose effect...") {
-            // Toggle the effect
-            player->effects[chosenEffect] = !player->effects[chosenEffect];
+            // Toggle the effect; turning it on schedules its end, if it has one
+            if (game.hasEffect(seat, chosenEffect)) game.setEffect(seat, chosenEffect, false);
+            else game.applyEffect(seat, chosenEffect);
         }
         refreshPlayersCircle();
         //refreshPlayersTable();
@@ -923,36 +967,25 @@ void StorytellerWindow::applyEffect(Player* player) {
 }
 
 void StorytellerWindow::selectCharactersForRandomAssignment() {
-    CharacterSelectionDialog dlg(script_characters, players.size(), this);
+    CharacterSelectionDialog dlg(game.scriptCharacters(), game.players.size(), this);
     if (dlg.exec() == QDialog::Accepted) {
-        auto selected = dlg.selectedCharacters();
-        if (selected.size() < players.size()) {
-            QMessageBox::warning(this, "Not enough characters", 
-                                 "Select at least as many characters as players.");
-            return;
-        }
-        std::shuffle(selected.begin(), selected.end(), rng());
-        for (int i = 0; i < players.size(); ++i) {
-            players[i].character = selected[i];
-            players[i].team = selected[i].team;
-            players[i].alive = true;
-            players[i].effects = init_effects;
-        }
+        if (showError(game.assignCharacters(dlg.selectedCharacters()))) return;
         refreshPlayersCircle();
     }
 }
 
 void StorytellerWindow::selectBluffsManually() {
-    // Filter only Townsfolk + Outsiders
-    std::vector<Character> eligible;
-    for (auto &c : script_characters) {
-        if (c.team == "townsfolk" || c.team == "outsider")
-            eligible.push_back(c);
-    }
-
-    BluffSelectionDialog dialog(eligible, this);
+    // Only Townsfolk + Outsiders, with the best ranked combinations one click away
+    BluffOptimiser optimiser(game);
+    std::vector<BluffSuggestion> suggestions;
+    for (auto &o : optimiser.rank(10)) {
+        BluffSuggestion s{optimiser.describe(o), {}};
+        for (auto &c : optimiser.charactersOf(o)) s.ids.push_back(c.id);
+        suggestions.push_back(s);
+    }
+    BluffSelectionDialog dialog(game.bluffCandidates(), suggestions, this);
     if (dialog.exec() == QDialog::Accepted) {
-        bluffs = dialog.selectedCharacters(); // store them in your class
+        game.bluffs = dialog.selectedCharacters();
         // QMessageBox::information(this, "Bluffs Selected",
         //                          QString("Selected bluffs:\n%1, %2, %3")
         //                          .arg(selectedBluffs[0].name)
@@ -960,4 +993,3 @@ void StorytellerWindow::selectBluffsManually() {
         //                          .arg(selectedBluffs[2].name));
     }
 }
-
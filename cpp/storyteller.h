@@ -5,99 +5,99 @@
 #include <vector>
 #include <nlohmann/json.hpp>
 #include <optional>
+#include "GameState.h"
+#include "FalseInfoRecommender.h"
+#include "GameArchive.h"
+#include "GrimoireSync.h"
 
 using json = nlohmann::json;
 
-// ---------- Data models ----------
-struct Character {
-    QString id;
-    QString name;
-    QString team;
-    QString ability;
-    std::optional<int> first_night_order = 999;
-    std::optional<int> other_night_order = 999;
-    QString firstNightReminder;
-    QString otherNightReminder;
-    std::vector<QString> reminders;
-};
-
-struct Player {
-    QString name;
-    QString team;
-    Character character;
-    bool alive = true;
-    bool poisoned = false;
-    bool drunk = false;
-    std::unordered_map<QString,bool> effects;
-
-    QString status() const {
-        QStringList flags;
-        if (!alive) flags << "Dead";
-        if (poisoned) flags << "Poisoned";
-        if (drunk) flags << "Drunk";
-        for (auto &kv : effects) if (kv.second) flags << kv.first;
-        return flags.empty() ? "Healthy" : flags.join(" / ");
-    }
-};
-
-
+class GrimoireLink;
+class GrimoireWidget;
+class PlayerServer;
+class TownSquareWidget;
 
 // ---------- Main Window ----------
 class StorytellerWindow : public QMainWindow {
     Q_OBJECT
 public:
-    explicit StorytellerWindow(QWidget *parent = nullptr);
-    
+    // With shareFrom, the game starts on that game's character database and
+    // script snapshots instead of loading its own
+    explicit StorytellerWindow(QWidget *parent = nullptr, bool promptForScript = true,
+                               const GameState *shareFrom = nullptr);
+    ~StorytellerWindow() override;
+
+    const GameState &gameState() const { return game; }
+    QString gameTitle() const;   // script and day, e.g. for a tab
+
+    // Runs a GameCommands message against this game; however many messages
+    // change it, the grimoire is redrawn once when the event loop is next idle
+    json runCommands(const json &message);
+
         // Static configs
-    static const std::unordered_map<int, std::unordered_map<QString,int>> role_config;
     static const QMap<QString, QString> colors;
-    static const std::vector<QString> all_teams;
+
+signals:
+    void gameTitleChanged(const QString &title);
+    void newGameRequested();
 
 private slots:
     void loadCharacterDBFromPath(const QString &path);
     void loadCharacterDB();
     void loadScript();
-    void openAddPlayerDialog(Player* editPlayer = nullptr);
+    bool loadScriptFromPath(const QString &path);
+    void openAddPlayerDialog(int editSeat = -1);
 
     
     
     void refreshPlayersCircle();
+    void showSeatMenu(int idx, const QPoint &globalPos);
     void chooseBluffs();
     void showBluffs();
     void startNight();
-    void runNightDialog(const std::vector<Player*>& ordered, int index);
+    void runNightDialog(const std::vector<int>& ordered, int index);
     void endNight();
     void assignRandomCharacters();
     void generateGameDialog();
+    void generateGame(int num);
     void advanceDay();
-    void sendMessageDialog();
-    void applyEffect(Player* player);
+    void sendMessageDialog(int seat);
+    void applyEffect(int seat);
     void setupMenu();
     void selectCharactersForRandomAssignment();
     void selectBluffsManually();
+    void showStallStats();
+    void setClaimDialog(int seat);
+    void analyseWorlds();
+    void showAlerts();
+    void showTownSquare();
+    void showPlayerLinks();
+    void syncGrimoire();
 
 private:
+    friend class BotcBench; // headless benchmarks drive the slots directly
+
+    bool showError(const OpResult &result);
+    void queueRefresh();   // once, when the event loop is next idle
+    QString abilityStatus(int seat) const;
+    void archiveGame(GameArchive::Winner winner);
+
     // UI members
     QTableWidget *playersTable;
     QLabel *headerLabel;
     QCheckBox *showAllCheckbox;
-    QWidget *circleWidget = nullptr;
+    GrimoireWidget *grimoire = nullptr;
+    QPointer<TownSquareWidget> townSquare;   // listens to `game`, so goes first
+    QPointer<PlayerServer> playerServer;     // likewise; started on first use
+    QPointer<GrimoireLink> grimoireLink;     // carries grimoireSync's operations
+    bool refreshQueued = false;
     QScrollArea* scrollArea = nullptr;
     QToolButton* menuButton;
 
-    int day = 1;
-    bool first_night = true;
-
-    std::unordered_map<QString, Character> character_db;
-    std::vector<Character> script_characters;
-    std::vector<Player> players;
-    std::vector<Character> bluffs;
-    std::vector<QString> reminders;
-    std::unordered_map<QString,bool> init_effects;
-    std::vector<Character> selectedBluffs;
-
-
-    
+    // Game logic and data live in the headless core; the window is a view over it
+    GameState game;
+    FalseInfoRecommender recommender;   // keeps consistent worlds between night steps
+    std::unique_ptr<GrimoireSync> grimoireSync;   // with a co-storyteller, once joined
 
 protected:
     void resizeEvent(QResizeEvent *event) override;